@@ -5,6 +5,8 @@ Map::Map()
 {
     frameNum = 0;       // default set to 0 until updated
     valid = false;      // default set to false until updated
+    referenced = false;
+    dirty = false;
 }
 
 /**
@@ -24,6 +26,17 @@ void Map::setValid()
     this->valid = true;
 }
 
+/**
+ * @brief - sets valid to false. Used by TranslationBackend::invalidate(). The access bits are
+ * cleared too so the next page mapped here starts clean
+ */
+void Map::setInvalid()
+{
+    this->valid = false;
+    this->referenced = false;
+    this->dirty = false;
+}
+
 /**
  * @brief - returns private variable this->valid
  */
@@ -38,4 +51,44 @@ bool Map::isValid()
 unsigned int Map::getFrameNum()
 {
     return frameNum;
-}
\ No newline at end of file
+}
+
+/**
+ * @brief - sets referenced to true. Done on every access to the page
+ */
+void Map::setReferenced()
+{
+    this->referenced = true;
+}
+
+/**
+ * @brief - sets referenced to false. Used by the second chance sweep in FrameTable::victim()
+ */
+void Map::clearReferenced()
+{
+    this->referenced = false;
+}
+
+/**
+ * @brief - returns private variable referenced
+ */
+bool Map::isReferenced()
+{
+    return this->referenced;
+}
+
+/**
+ * @brief - sets dirty to true. Done on MEMWRITE and IOWRITE accesses
+ */
+void Map::setDirty()
+{
+    this->dirty = true;
+}
+
+/**
+ * @brief - returns private variable dirty
+ */
+bool Map::isDirty()
+{
+    return this->dirty;
+}
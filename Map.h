@@ -7,11 +7,21 @@ public:
     Map();  // default constructor
     void setFrameNum(int frameNumber);  // sets frameNum of Map
     void setValid();    // sets valid = true
+    void setInvalid();  // sets valid = false when the page is unmapped
     bool isValid();     // returns valid used in PageTable::paegLookup()
     unsigned int getFrameNum();       // returns frameNum
+
+    // access bits, kept up to date in --frames mode
+    void setReferenced();
+    void clearReferenced();
+    bool isReferenced();
+    void setDirty();
+    bool isDirty();
 private:
     unsigned int frameNum;      // physical frameNum mapped to vpn
     bool valid;     // true if Map has been initialized and given a frameNum
+    bool referenced;    // page accessed since the bit was last cleared
+    bool dirty;         // page written since it was mapped
 
 
 };
@@ -0,0 +1,171 @@
+#include <iostream>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+#include "checkpoint.h"
+
+
+/**
+ * @brief - helpers for reading/writing one native 32 or 64 bit value
+ */
+static void writeU32(FILE* out, uint32_t value)
+{
+    fwrite(&value, sizeof(value), 1, out);
+}
+
+static void writeU64(FILE* out, uint64_t value)
+{
+    fwrite(&value, sizeof(value), 1, out);
+}
+
+static bool readU32(FILE* in, uint32_t* value)
+{
+    return fread(value, sizeof(*value), 1, in) == 1;
+}
+
+static bool readU64(FILE* in, uint64_t* value)
+{
+    return fread(value, sizeof(*value), 1, in) == 1;
+}
+
+
+/**
+ * @brief - writes a snapshot of the pageTable, its backend and the tlb to fname.
+ * @param fname - path of the checkpoint file to create
+ * @param pTable - pageTable whose counters and mappings are saved
+ * @param cache - tlb whose mappings and recent page queue are saved
+ * @param pageTableType - -p value of this run, checked on resume
+ * @param recordPos - number of trace records consumed so far
+ */
+bool saveCheckpoint(const char* fname, PageTable* pTable, tlb* cache, const char* pageTableType,
+    unsigned long long recordPos)
+{
+    FILE* out = fopen(fname, "wb");
+    if (out == NULL) {
+        std::cerr << "Unable to write checkpoint <<" << fname << ">>" << std::endl;
+        return false;
+    }
+
+    // header and configuration
+    char type[CHECKPOINT_TYPE_LEN];
+    memset(type, 0, sizeof(type));
+    strncpy(type, pageTableType, CHECKPOINT_TYPE_LEN - 1);
+    fwrite(CHECKPOINT_MAGIC, 1, CHECKPOINT_MAGIC_LEN, out);
+    writeU32(out, CHECKPOINT_VERSION);
+    fwrite(type, 1, sizeof(type), out);
+    writeU32(out, pTable->levelCount);
+    for (unsigned int i = 0; i < pTable->levelCount; i++) {
+        writeU32(out, pTable->bitsInLevel[i]);
+    }
+    writeU32(out, cache->capacity);
+    writeU64(out, recordPos);
+
+    // pageTable counters
+    writeU32(out, pTable->addressCount);
+    writeU32(out, pTable->frameCount);
+    writeU32(out, pTable->countPageTableHits);
+    writeU32(out, pTable->countTlbHits);
+    writeU32(out, pTable->currFrameNum);
+
+    // pageTable mappings, gathered first so the count can lead
+    std::vector<uint32_t> mappings;
+    pTable->backend->forEach([&mappings](unsigned int vpn, Map* frame) {
+        mappings.push_back(vpn);
+        mappings.push_back(frame->getFrameNum());
+    });
+    writeU32(out, mappings.size() / 2);
+    fwrite(mappings.data(), sizeof(uint32_t), mappings.size(), out);
+
+    // tlb mappings and recent page queue, oldest first. Keys fit in 32 bits since checkpoints
+    // are never combined with --asid
+    writeU32(out, cache->vpn2pfn.size());
+    for (std::map<unsigned long long, unsigned int>::iterator it = cache->vpn2pfn.begin(); it != cache->vpn2pfn.end(); it++) {
+        writeU32(out, it->first);
+        writeU32(out, it->second);
+    }
+    writeU32(out, cache->recentPagesQueue.size());
+    for (unsigned int i = 0; i < cache->recentPagesQueue.size(); i++) {
+        writeU32(out, cache->recentPagesQueue[i]);
+    }
+
+    bool ok = !ferror(out);
+    fclose(out);
+    return ok;
+}
+
+
+/**
+ * @brief - restores a snapshot written by saveCheckpoint. Mappings are reinserted through the
+ * backend so any levels they need are rebuilt and numBytesSize matches the saved run.
+ * @param fname - path of the checkpoint file
+ * @param pTable - freshly constructed pageTable with the same levels as the saved run
+ * @param cache - freshly constructed tlb with the same capacity as the saved run
+ * @param pageTableType - -p value of this run, must match the saved one
+ * @param recordPos - set to the number of trace records the saved run had consumed
+ */
+bool loadCheckpoint(const char* fname, PageTable* pTable, tlb* cache, const char* pageTableType,
+    unsigned long long* recordPos)
+{
+    FILE* in = fopen(fname, "rb");
+    if (in == NULL) {
+        std::cerr << "Unable to open checkpoint <<" << fname << ">>" << std::endl;
+        return false;
+    }
+
+    char magic[CHECKPOINT_MAGIC_LEN];
+    char type[CHECKPOINT_TYPE_LEN];
+    uint32_t version, levelCount, bits, capacity, count, vpn, frameNum;
+    uint64_t pos;
+    bool ok = fread(magic, 1, sizeof(magic), in) == sizeof(magic)
+        && memcmp(magic, CHECKPOINT_MAGIC, CHECKPOINT_MAGIC_LEN) == 0
+        && readU32(in, &version) && version == CHECKPOINT_VERSION
+        && fread(type, 1, sizeof(type), in) == sizeof(type);
+    if (!ok) {
+        std::cerr << "<<" << fname << ">> is not a checkpoint file" << std::endl;
+        fclose(in);
+        return false;
+    }
+
+    // configuration must match this run
+    type[CHECKPOINT_TYPE_LEN - 1] = '\0';
+    ok = strcmp(type, pageTableType) == 0 && readU32(in, &levelCount) && levelCount == pTable->levelCount;
+    for (unsigned int i = 0; ok && i < levelCount; i++) {
+        ok = readU32(in, &bits) && bits == pTable->bitsInLevel[i];
+    }
+    ok = ok && readU32(in, &capacity) && (int)capacity == cache->capacity && readU64(in, &pos);
+    if (!ok) {
+        std::cerr << "Checkpoint <<" << fname << ">> was saved with different levels, -c or -p" << std::endl;
+        fclose(in);
+        return false;
+    }
+    *recordPos = pos;
+
+    ok = readU32(in, &pTable->addressCount) && readU32(in, &pTable->frameCount)
+        && readU32(in, &pTable->countPageTableHits) && readU32(in, &pTable->countTlbHits)
+        && readU32(in, &pTable->currFrameNum);
+
+    // pageTable mappings
+    ok = ok && readU32(in, &count);
+    for (uint32_t i = 0; ok && i < count; i++) {
+        ok = readU32(in, &vpn) && readU32(in, &frameNum);
+        if (ok) pTable->backend->insert(vpn, frameNum);
+    }
+
+    // tlb mappings and recent page queue
+    ok = ok && readU32(in, &count);
+    for (uint32_t i = 0; ok && i < count; i++) {
+        ok = readU32(in, &vpn) && readU32(in, &frameNum);
+        if (ok) cache->vpn2pfn[vpn] = frameNum;
+    }
+    ok = ok && readU32(in, &count);
+    for (uint32_t i = 0; ok && i < count; i++) {
+        ok = readU32(in, &vpn);
+        if (ok) cache->recentPagesQueue.push_back(vpn);
+    }
+
+    if (!ok) {
+        std::cerr << "Checkpoint <<" << fname << ">> is truncated" << std::endl;
+    }
+    fclose(in);
+    return ok;
+}
@@ -0,0 +1,30 @@
+#ifndef CHECKPOINT
+#define CHECKPOINT
+
+#include "pageTable.h"
+#include "tlb.h"
+
+#define CHECKPOINT_MAGIC "PTCK"
+#define CHECKPOINT_MAGIC_LEN 4
+#define CHECKPOINT_VERSION 1
+#define CHECKPOINT_TYPE_LEN 16      // bytes reserved for the page table type name
+
+
+/*
+ * Checkpoints are a snapshot of the simulation after recordPos trace records:
+ *   "PTCK" | version | page table type | level count | bits per level | tlb capacity | recordPos
+ *   PageTable counters | (vpn, frame) of every valid mapping | tlb mappings | tlb recent queue
+ * Integers are written in native byte order, so a checkpoint is meant to be resumed on the
+ * machine that wrote it. Resuming requires the same levels, -c and -p as the run that saved it.
+ */
+
+// writes a snapshot of pTable and cache. Returns false if fname can't be written
+bool saveCheckpoint(const char* fname, PageTable* pTable, tlb* cache, const char* pageTableType,
+    unsigned long long recordPos);
+
+// restores pTable and cache from fname. Both must be freshly constructed with the saved geometry.
+// Sets *recordPos to the trace record to continue from. Prints the reason and returns false on mismatch
+bool loadCheckpoint(const char* fname, PageTable* pTable, tlb* cache, const char* pageTableType,
+    unsigned long long* recordPos);
+
+#endif
@@ -0,0 +1,407 @@
+#include <stdio.h>
+#include <string.h>
+#include "ctrace.h"
+
+
+/**
+ * @brief - little-endian helpers for the fixed width header fields
+ */
+static void putLE(unsigned char* dest, uint64_t value, int numBytes)
+{
+    for (int i = 0; i < numBytes; i++) {
+        dest[i] = (unsigned char)(value >> (8 * i));
+    }
+}
+
+static uint64_t getLE(const unsigned char* src, int numBytes)
+{
+    uint64_t value = 0;
+    for (int i = 0; i < numBytes; i++) {
+        value |= (uint64_t)src[i] << (8 * i);
+    }
+    return value;
+}
+
+
+/**
+ * @brief - zigzag maps signed deltas to unsigned so small negative deltas stay small
+ */
+static uint32_t zigzagEncode(uint32_t delta)
+{
+    return (delta << 1) ^ (uint32_t)((int32_t)delta >> 31);
+}
+
+static uint32_t zigzagDecode(uint32_t value)
+{
+    return (value >> 1) ^ (0 - (value & 1));
+}
+
+
+/**
+ * @brief - appends value as a LEB128 varint, 7 bits per byte with the high bit as continuation
+ */
+static void putVarint(std::vector<unsigned char>& bytes, uint32_t value)
+{
+    while (value >= 0x80) {
+        bytes.push_back((unsigned char)(value | 0x80));
+        value >>= 7;
+    }
+    bytes.push_back((unsigned char)value);
+}
+
+
+/**
+ * @brief - decodes a varint starting at bytes[*pos]. Advances *pos past it
+ * @param size - bytes in the buffer
+ * @param value - set to the decoded value
+ * @return false if the varint runs past size
+ */
+static bool getVarint(const unsigned char* bytes, size_t size, size_t* pos, uint32_t* value)
+{
+    *value = 0;
+    int shift = 0;
+    unsigned char byte;
+    do {
+        if (*pos >= size) {
+            return false;
+        }
+        byte = bytes[(*pos)++];
+        *value |= (uint32_t)(byte & 0x7F) << shift;
+        shift += 7;
+    } while ((byte & 0x80) && shift < 35);
+    return true;
+}
+
+
+/**
+ * @brief - constructor writes the file header
+ * @param out - FILE* opened with fopen in "wb" mode
+ * @param fields - CTRACE_FIELD_* bits of optional fields to keep
+ * @param blockRecords - records per block
+ */
+CTraceWriter::CTraceWriter(FILE* out, unsigned int fields, unsigned int blockRecords)
+{
+    this->out = out;
+    this->fields = fields & CTRACE_FIELD_ALL;
+    this->blockRecords = blockRecords;
+    this->recordsWritten = 0;
+    this->bytesWritten = 0;
+    this->recordsInBlock = 0;
+    this->prevAddr = 0;
+    this->prevTime = 0;
+
+    unsigned char header[CTRACE_HEADER_BYTES];
+    memset(header, 0, sizeof(header));
+    memcpy(header, CTRACE_MAGIC, CTRACE_MAGIC_LEN);
+    header[4] = CTRACE_VERSION;
+    header[5] = (unsigned char)this->fields;
+    putLE(header + 8, blockRecords, 4);
+    writeBytes(header, sizeof(header));
+}
+
+
+void CTraceWriter::writeBytes(const unsigned char* bytes, size_t len)
+{
+    fwrite(bytes, 1, len, out);
+    bytesWritten += len;
+}
+
+
+/**
+ * @brief - encodes record into the current block, flushing the block once it is full
+ * @param record - record to append
+ */
+void CTraceWriter::append(const p2AddrTr* record)
+{
+    putVarint(payload, zigzagEncode(record->addr - prevAddr));
+    prevAddr = record->addr;
+
+    if (fields & CTRACE_FIELD_REQTYPE) payload.push_back(record->reqtype);
+    if (fields & CTRACE_FIELD_SIZE) payload.push_back(record->size);
+    if (fields & CTRACE_FIELD_ATTR) payload.push_back(record->attr);
+    if (fields & CTRACE_FIELD_PROC) payload.push_back(record->proc);
+    if (fields & CTRACE_FIELD_TIME) {
+        putVarint(payload, zigzagEncode(record->time - prevTime));
+        prevTime = record->time;
+    }
+
+    recordsInBlock++;
+    recordsWritten++;
+    if (recordsInBlock == blockRecords) {
+        flushBlock();
+    }
+}
+
+
+/**
+ * @brief - writes the current block and records it in the index. Resets the delta state
+ */
+void CTraceWriter::flushBlock()
+{
+    if (recordsInBlock == 0) {
+        return;
+    }
+
+    CTraceBlockIndex entry;
+    entry.fileOffset = bytesWritten;
+    entry.firstRecord = recordsWritten - recordsInBlock;
+    entry.numRecords = recordsInBlock;
+    index.push_back(entry);
+
+    unsigned char blockHeader[CTRACE_BLOCK_HEADER_BYTES];
+    putLE(blockHeader, recordsInBlock, 4);
+    putLE(blockHeader + 4, payload.size(), 4);
+    writeBytes(blockHeader, sizeof(blockHeader));
+    writeBytes(payload.data(), payload.size());
+
+    payload.clear();
+    recordsInBlock = 0;
+    prevAddr = 0;
+    prevTime = 0;
+}
+
+
+/**
+ * @brief - flushes the last block then writes the block index and footer
+ */
+void CTraceWriter::close()
+{
+    flushBlock();
+
+    uint64_t indexOffset = bytesWritten;
+    unsigned char entry[CTRACE_INDEX_ENTRY_BYTES];
+    for (size_t i = 0; i < index.size(); i++) {
+        putLE(entry, index[i].fileOffset, 8);
+        putLE(entry + 8, index[i].firstRecord, 8);
+        putLE(entry + 16, index[i].numRecords, 4);
+        writeBytes(entry, sizeof(entry));
+    }
+
+    unsigned char footer[CTRACE_FOOTER_BYTES];
+    putLE(footer, indexOffset, 8);
+    putLE(footer + 8, index.size(), 4);
+    memcpy(footer + 12, CTRACE_INDEX_MAGIC, CTRACE_MAGIC_LEN);
+    writeBytes(footer, sizeof(footer));
+    fflush(out);
+}
+
+
+/**
+ * @brief - constructor checks the header, loads the block index from the footer and positions
+ * the reader at the first block
+ * @param in - FILE* opened with fopen in "rb" mode. Closed by the destructor
+ */
+CTraceReader::CTraceReader(FILE* in)
+{
+    this->in = in;
+    this->valid = false;
+    this->fields = 0;
+    this->pos = 0;
+    this->nextBlock = 0;
+    this->remainingInBlock = 0;
+    this->prevAddr = 0;
+    this->prevTime = 0;
+    this->indexOffset = 0;
+
+    unsigned char header[CTRACE_HEADER_BYTES];
+    if (fread(header, 1, sizeof(header), in) != sizeof(header)) return;
+    if (memcmp(header, CTRACE_MAGIC, CTRACE_MAGIC_LEN) != 0 || header[4] != CTRACE_VERSION) return;
+    this->fields = header[5];
+
+    // footer points at the block index
+    unsigned char footer[CTRACE_FOOTER_BYTES];
+    if (fseek(in, -CTRACE_FOOTER_BYTES, SEEK_END) != 0) return;
+    if (fread(footer, 1, sizeof(footer), in) != sizeof(footer)) return;
+    if (memcmp(footer + 12, CTRACE_INDEX_MAGIC, CTRACE_MAGIC_LEN) != 0) return;
+
+    indexOffset = getLE(footer, 8);
+    uint32_t numBlocks = getLE(footer + 8, 4);
+    if (fseek(in, indexOffset, SEEK_SET) != 0) return;
+
+    // blocks must follow each other between the header and the index, with their records in order,
+    // so loadBlock can bound every payload by the next block and seekRecord can search the index
+    unsigned char entry[CTRACE_INDEX_ENTRY_BYTES];
+    uint64_t blockEnd = CTRACE_HEADER_BYTES;
+    uint64_t records = 0;
+    for (uint32_t i = 0; i < numBlocks; i++) {
+        if (fread(entry, 1, sizeof(entry), in) != sizeof(entry)) return;
+        CTraceBlockIndex blockIndex;
+        blockIndex.fileOffset = getLE(entry, 8);
+        blockIndex.firstRecord = getLE(entry + 8, 8);
+        blockIndex.numRecords = getLE(entry + 16, 4);
+        if (blockIndex.fileOffset < blockEnd || blockIndex.fileOffset > indexOffset
+            || indexOffset - blockIndex.fileOffset < CTRACE_BLOCK_HEADER_BYTES || blockIndex.firstRecord != records) return;
+        blockEnd = blockIndex.fileOffset + CTRACE_BLOCK_HEADER_BYTES;
+        records += blockIndex.numRecords;
+        index.push_back(blockIndex);
+    }
+
+    this->valid = true;
+}
+
+
+CTraceReader::~CTraceReader()
+{
+    fclose(in);
+}
+
+
+bool CTraceReader::isValid()
+{
+    return valid;
+}
+
+
+/**
+ * @brief - total records in the trace according to the block index
+ */
+unsigned long long CTraceReader::totalRecords()
+{
+    if (index.empty()) {
+        return 0;
+    }
+    return index.back().firstRecord + index.back().numRecords;
+}
+
+
+/**
+ * @brief - reads block nextBlock into memory and resets the delta state
+ */
+bool CTraceReader::loadBlock()
+{
+    if (nextBlock >= index.size()) {
+        return false;
+    }
+    if (fseek(in, index[nextBlock].fileOffset, SEEK_SET) != 0) {
+        return false;
+    }
+
+    unsigned char blockHeader[CTRACE_BLOCK_HEADER_BYTES];
+    if (fread(blockHeader, 1, sizeof(blockHeader), in) != sizeof(blockHeader)) {
+        return corrupt(nextBlock);
+    }
+    remainingInBlock = getLE(blockHeader, 4);
+    uint32_t payloadBytes = getLE(blockHeader + 4, 4);
+
+    // the payload has to fit before the next block, or the index after the last one
+    uint64_t end = nextBlock + 1 < index.size() ? index[nextBlock + 1].fileOffset : indexOffset;
+    if (payloadBytes > end - index[nextBlock].fileOffset - CTRACE_BLOCK_HEADER_BYTES) {
+        return corrupt(nextBlock);
+    }
+    payload.resize(payloadBytes);
+    if (fread(payload.data(), 1, payloadBytes, in) != payloadBytes) {
+        return corrupt(nextBlock);
+    }
+
+    pos = 0;
+    prevAddr = 0;
+    prevTime = 0;
+    nextBlock++;
+    return true;
+}
+
+
+/**
+ * @brief - a block is truncated or runs out of payload before its records do. Reports it and ends
+ * the trace there, so no read goes past the block
+ * @param block - index of the block
+ * @return false
+ */
+bool CTraceReader::corrupt(size_t block)
+{
+    fprintf(stderr, "Corrupt ctrace block %zu, ending the trace there\n", block);
+    valid = false;
+    remainingInBlock = 0;
+    nextBlock = index.size();
+    return false;
+}
+
+
+/**
+ * @brief - decodes the next record. Fields not stored in the file are set to 0. Every read is
+ * checked against the end of the block
+ * @param record - filled with the next record
+ * @return false at the end of the trace or on a corrupt block
+ */
+bool CTraceReader::next(p2AddrTr* record)
+{
+    while (remainingInBlock == 0) {
+        if (!loadBlock()) {
+            return false;
+        }
+    }
+
+    const unsigned char* bytes = payload.data();
+    size_t size = payload.size();
+    memset(record, 0, sizeof(p2AddrTr));
+
+    uint32_t delta;
+    if (!getVarint(bytes, size, &pos, &delta)) {
+        return corrupt(nextBlock - 1);
+    }
+    prevAddr += zigzagDecode(delta);
+    record->addr = prevAddr;
+    size_t byteFields = ((fields & CTRACE_FIELD_REQTYPE) != 0) + ((fields & CTRACE_FIELD_SIZE) != 0)
+        + ((fields & CTRACE_FIELD_ATTR) != 0) + ((fields & CTRACE_FIELD_PROC) != 0);
+    if (size - pos < byteFields) {
+        return corrupt(nextBlock - 1);
+    }
+    if (fields & CTRACE_FIELD_REQTYPE) record->reqtype = bytes[pos++];
+    if (fields & CTRACE_FIELD_SIZE) record->size = bytes[pos++];
+    if (fields & CTRACE_FIELD_ATTR) record->attr = bytes[pos++];
+    if (fields & CTRACE_FIELD_PROC) record->proc = bytes[pos++];
+    if (fields & CTRACE_FIELD_TIME) {
+        if (!getVarint(bytes, size, &pos, &delta)) {
+            return corrupt(nextBlock - 1);
+        }
+        prevTime += zigzagDecode(delta);
+        record->time = prevTime;
+    }
+
+    remainingInBlock--;
+    return true;
+}
+
+
+/**
+ * @brief - positions the reader at the start of block
+ * @param block - index of the block to read next
+ */
+bool CTraceReader::seekBlock(size_t block)
+{
+    if (block >= index.size()) {
+        return false;
+    }
+    nextBlock = block;
+    remainingInBlock = 0;
+    return loadBlock();
+}
+
+
+/**
+ * @brief - positions the reader so the next call to next returns record recordNum. Only the
+ * block holding the record is decoded.
+ * @param recordNum - zero based record number
+ */
+bool CTraceReader::seekRecord(unsigned long long recordNum)
+{
+    // binary search for the last block starting at or before recordNum
+    size_t low = 0;
+    size_t high = index.size();
+    while (high - low > 1) {
+        size_t mid = (low + high) / 2;
+        if (index[mid].firstRecord <= recordNum) low = mid;
+        else high = mid;
+    }
+    if (recordNum >= totalRecords() || !seekBlock(low)) {
+        return false;
+    }
+
+    p2AddrTr skipped;
+    for (unsigned long long i = index[low].firstRecord; i < recordNum; i++) {
+        if (!next(&skipped)) {
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,125 @@
+#ifndef CTRACE
+#define CTRACE
+
+#include <stdio.h>
+#include <vector>
+#include "traceSource.h"
+
+/*
+ * ctrace - compressed trace container
+ *
+ *   header  : "CTRC" | version u8 | fields u8 | reserved u16 | blockRecords u32 | reserved u32
+ *   blocks  : numRecords u32 | payloadBytes u32 | payload
+ *   index   : one entry per block: fileOffset u64 | firstRecord u64 | numRecords u32
+ *   footer  : indexOffset u64 | numBlocks u32 | "CTIX"
+ *
+ * Every record in a payload is varint(zigzag(addr - previous addr)) followed by whichever optional
+ * fields the header asks for (reqtype, size, attr, proc as single bytes, time as a zigzag varint
+ * delta). The previous addr and time reset to 0 at the start of every block, so each block can be
+ * decoded on its own. All fixed width integers are little-endian.
+ */
+#define CTRACE_MAGIC "CTRC"
+#define CTRACE_INDEX_MAGIC "CTIX"
+#define CTRACE_MAGIC_LEN 4
+#define CTRACE_VERSION 1
+#define CTRACE_HEADER_BYTES 16
+#define CTRACE_BLOCK_HEADER_BYTES 8
+#define CTRACE_INDEX_ENTRY_BYTES 20
+#define CTRACE_FOOTER_BYTES 16
+#define CTRACE_DEFAULT_BLOCK_RECORDS 65536
+
+/* optional per record fields */
+#define CTRACE_FIELD_REQTYPE 0x01
+#define CTRACE_FIELD_SIZE 0x02
+#define CTRACE_FIELD_ATTR 0x04
+#define CTRACE_FIELD_PROC 0x08
+#define CTRACE_FIELD_TIME 0x10
+#define CTRACE_FIELD_ALL 0x1F
+#define CTRACE_DEFAULT_FIELDS (CTRACE_FIELD_REQTYPE | CTRACE_FIELD_PROC)   // what the simulator can use
+
+
+/*
+ * block index entry, one per block
+ */
+typedef struct
+{
+    uint64_t fileOffset;    // offset of the block header
+    uint64_t firstRecord;   // record number of the first record in the block
+    uint32_t numRecords;
+} CTraceBlockIndex;
+
+
+/**
+ * @brief - streaming ctrace encoder. Records are appended one at a time and written out a block
+ * at a time. close() must be called to write the block index.
+ */
+class CTraceWriter
+{
+public:
+    // constructor writes the file header
+    CTraceWriter(FILE* out, unsigned int fields, unsigned int blockRecords);
+
+    void append(const p2AddrTr* record);
+    void close();   // flushes the last block and writes the index and footer
+
+    unsigned long long recordsWritten;
+    unsigned long long bytesWritten;
+
+private:
+    FILE* out;
+    unsigned int fields;
+    unsigned int blockRecords;
+
+    // block being built
+    std::vector<unsigned char> payload;
+    uint32_t recordsInBlock;
+    uint32_t prevAddr;
+    uint32_t prevTime;
+
+    std::vector<CTraceBlockIndex> index;
+
+    void flushBlock();
+    void writeBytes(const unsigned char* bytes, size_t len);
+};
+
+
+/**
+ * @brief - streaming ctrace decoder. Decodes one block at a time into memory and hands out
+ * records from it. The block index lets callers jump to any block without decoding the ones before.
+ */
+class CTraceReader : public TraceSource
+{
+public:
+    // constructor reads the header and block index, and checks the blocks are in order before the index
+    CTraceReader(FILE* in);
+    ~CTraceReader();
+
+    bool isValid();     // false if the header or footer is malformed, or a block was found corrupt
+    bool next(p2AddrTr* record);
+
+    // random access
+    bool seekBlock(size_t block);
+    bool seekRecord(unsigned long long recordNum);
+    unsigned long long totalRecords();
+
+    unsigned int fields;
+    std::vector<CTraceBlockIndex> index;
+
+private:
+    FILE* in;
+    bool valid;
+    uint64_t indexOffset;       // file offset of the block index, where the last block must end
+
+    // decode state of the current block
+    std::vector<unsigned char> payload;
+    size_t pos;
+    size_t nextBlock;           // block to load once this one runs out
+    uint32_t remainingInBlock;
+    uint32_t prevAddr;
+    uint32_t prevTime;
+
+    bool loadBlock();
+    bool corrupt(size_t block);     // reports block and ends the trace
+};
+
+#endif
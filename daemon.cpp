@@ -0,0 +1,355 @@
+#include "daemon.h"
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#include <stdio.h>
+#include <algorithm>
+
+static volatile sig_atomic_t statsSignalled = 0;
+static volatile sig_atomic_t stopSignalled = 0;
+
+static void onStatsSignal(int)
+{
+    statsSignalled = 1;
+}
+
+static void onStopSignal(int)
+{
+    stopSignalled = 1;
+}
+
+
+/**
+ * @brief - creates a non-blocking UNIX stream socket listening on path. A stale socket file left
+ * by an earlier run is replaced
+ * @param path - socket path
+ * @return listening fd, or -1 after printing why
+ */
+static int listenUnix(const char* path)
+{
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(addr.sun_path)) {
+        fprintf(stderr, "Socket path %s is too long\n", path);
+        return -1;
+    }
+    strcpy(addr.sun_path, path);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        perror("socket");
+        return -1;
+    }
+    unlink(path);
+    if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0 || listen(fd, 8) < 0) {
+        fprintf(stderr, "Unable to listen on %s: %s\n", path, strerror(errno));
+        close(fd);
+        return -1;
+    }
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    return fd;
+}
+
+
+/**
+ * @brief - sets up the trace input, the control socket and the signal handlers
+ * @param input - "-" for stdin or "unix:PATH"
+ * @param controlPath - path of the --control socket, NULL for none
+ * @param format - STREAM_BYU or STREAM_ADDR32
+ * @return the daemon, or NULL if an endpoint couldn't be opened
+ */
+Daemon* startDaemon(const char* input, const char* controlPath, int format)
+{
+    Daemon* daemon = new Daemon();
+    daemon->format = format;
+
+    if (strcmp(input, "-") == 0) {
+        daemon->source = new StreamSource(STDIN_FILENO, format);
+        daemon->producers = 1;
+    }
+    else if (strncmp(input, "unix:", 5) == 0 && input[5] != '\0') {
+        daemon->listenerPath = input + 5;
+        if ((daemon->listener = listenUnix(input + 5)) < 0) {
+            daemon->listenerPath.clear();
+            delete daemon;
+            return NULL;
+        }
+    }
+    else {
+        fprintf(stderr, "Daemon input must be - for stdin or unix:PATH\n");
+        delete daemon;
+        return NULL;
+    }
+
+    if (controlPath != NULL) {
+        daemon->controlPath = controlPath;
+        if ((daemon->control = listenUnix(controlPath)) < 0) {
+            daemon->controlPath.clear();
+            delete daemon;
+            return NULL;
+        }
+    }
+
+    // no SA_RESTART, so a signal wakes wait up out of poll
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    sigemptyset(&action.sa_mask);
+    action.sa_handler = onStatsSignal;
+    sigaction(SIGUSR1, &action, NULL);
+    action.sa_handler = onStopSignal;
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+    signal(SIGPIPE, SIG_IGN);      // a control client that hangs up early shouldn't kill the run
+    return daemon;
+}
+
+
+/**
+ * @brief - constructor, startDaemon fills in the endpoints
+ */
+Daemon::Daemon()
+{
+    this->source = NULL;
+    this->producers = 0;
+    this->format = STREAM_BYU;
+    this->listener = -1;
+    this->control = -1;
+    this->stopping = false;
+}
+
+
+Daemon::~Daemon()
+{
+    delete source;
+    for (unsigned int i = 0; i < clients.size(); i++) {
+        close(clients[i].fd);
+    }
+    if (listener >= 0) {
+        close(listener);
+        unlink(listenerPath.c_str());
+    }
+    if (control >= 0) {
+        close(control);
+        unlink(controlPath.c_str());
+    }
+}
+
+
+/**
+ * @brief - takes the next producer connection, if one is waiting
+ */
+void Daemon::acceptProducer()
+{
+    int fd = accept(listener, NULL, NULL);
+    if (fd >= 0) {
+        source = new StreamSource(fd, format);
+        producers++;
+    }
+}
+
+
+/**
+ * @brief - takes a new control connection, if one is waiting
+ */
+void Daemon::acceptControl()
+{
+    int fd = accept(control, NULL, NULL);
+    if (fd >= 0) {
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+        ControlClient client;
+        client.fd = fd;
+        clients.push_back(client);
+    }
+}
+
+
+/**
+ * @brief - runs one control command
+ * @param client - connection the command came from
+ * @param line - command without its newline
+ */
+void Daemon::command(ControlClient* client, const std::string& line)
+{
+    const char* reply = NULL;
+    if (line == "stats") {
+        statsRequests.push_back(client->fd);
+    }
+    else if (line == "quit") {
+        stopping = true;
+        reply = "bye\n";
+    }
+    else if (!line.empty()) {
+        reply = "unknown command, use stats or quit\n";
+    }
+    if (reply != NULL && write(client->fd, reply, strlen(reply)) < 0) {
+        // the client is gone, readControl notices
+    }
+}
+
+
+/**
+ * @brief - reads what a control client sent and runs every complete line
+ * @param client - readable connection
+ * @return false if the client closed the connection
+ */
+bool Daemon::readControl(ControlClient* client)
+{
+    char data[DAEMON_COMMAND_LEN];
+    ssize_t n;
+    while ((n = read(client->fd, data, sizeof(data))) > 0) {
+        for (ssize_t i = 0; i < n; i++) {
+            if (data[i] == '\n') {
+                std::string line = client->pending;
+                if (!line.empty() && line[line.size() - 1] == '\r') {
+                    line.erase(line.size() - 1);
+                }
+                client->pending.clear();
+                command(client, line);
+            }
+            else if (client->pending.size() < DAEMON_COMMAND_LEN) {
+                client->pending += data[i];
+            }
+        }
+    }
+    return !(n == 0 || (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR));
+}
+
+
+/**
+ * @brief - polls the producer, the sockets and the control clients until there is something for
+ * the simulation to do. Stats requests are returned first so they're answered between batches,
+ * and buffered records are still handed out after a stop was asked for
+ * @return DAEMON_RECORDS, DAEMON_STATS or DAEMON_STOP
+ */
+int Daemon::wait()
+{
+    for (;;) {
+        if (statsSignalled) {
+            statsSignalled = 0;
+            statsRequests.push_back(-1);
+        }
+        if (stopSignalled) {
+            stopping = true;
+        }
+        if (!statsRequests.empty()) {
+            return DAEMON_STATS;
+        }
+        if (source != NULL && source->buffered() > 0 && stopping) {
+            return DAEMON_RECORDS;
+        }
+        if (stopping) {
+            return DAEMON_STOP;
+        }
+
+        // the producer is done. stdin ends the run, a socket waits for the next producer
+        if (source != NULL && source->ended && source->buffered() == 0) {
+            if (listener < 0) {
+                return DAEMON_STOP;
+            }
+            delete source;
+            source = NULL;
+        }
+
+        std::vector<struct pollfd> fds;
+        struct pollfd pfd;
+        pfd.events = POLLIN;
+        pfd.revents = 0;
+        int sourceIndex = -1, listenerIndex = -1, controlIndex = -1;
+        if (source != NULL && !source->ended) {
+            sourceIndex = fds.size();
+            pfd.fd = source->fd;
+            fds.push_back(pfd);
+        }
+        if (source == NULL) {
+            listenerIndex = fds.size();
+            pfd.fd = listener;
+            fds.push_back(pfd);
+        }
+        if (control >= 0) {
+            controlIndex = fds.size();
+            pfd.fd = control;
+            fds.push_back(pfd);
+        }
+        size_t firstClient = fds.size();
+        for (unsigned int i = 0; i < clients.size(); i++) {
+            pfd.fd = clients[i].fd;
+            fds.push_back(pfd);
+        }
+
+        // don't sleep while records are waiting to be simulated
+        bool haveRecords = source != NULL && source->buffered() > 0;
+        if (poll(&fds[0], fds.size(), haveRecords ? 0 : -1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            perror("poll");
+            return DAEMON_STOP;
+        }
+
+        if (sourceIndex >= 0 && fds[sourceIndex].revents != 0) {
+            source->fill();
+        }
+        if (listenerIndex >= 0 && fds[listenerIndex].revents != 0) {
+            acceptProducer();
+        }
+        if (controlIndex >= 0 && fds[controlIndex].revents != 0) {
+            acceptControl();
+        }
+        for (size_t i = clients.size(); i > 0; i--) {
+            ControlClient* client = &clients[i - 1];
+            if (fds[firstClient + i - 1].revents != 0 && !readControl(client)) {
+                statsRequests.erase(std::remove(statsRequests.begin(), statsRequests.end(), client->fd), statsRequests.end());
+                close(client->fd);
+                clients.erase(clients.begin() + (i - 1));
+            }
+        }
+
+        if (statsRequests.empty() && !stopping && source != NULL && source->buffered() > 0) {
+            return DAEMON_RECORDS;
+        }
+    }
+}
+
+
+/**
+ * @brief - sends line to everyone waiting for stats, SIGUSR1 requests on stderr
+ * @param line - snapshot from formatStats, without a newline
+ */
+void Daemon::answerStats(const char* line)
+{
+    for (unsigned int i = 0; i < statsRequests.size(); i++) {
+        if (statsRequests[i] < 0) {
+            fprintf(stderr, "%s\n", line);
+        }
+        else {
+            std::string reply = std::string(line) + "\n";
+            if (write(statsRequests[i], reply.c_str(), reply.size()) < 0) {
+                // the client is gone, wait notices when it reads the connection
+            }
+        }
+    }
+    statsRequests.clear();
+}
+
+
+/**
+ * @brief - one line version of report_summary for stats snapshots
+ * @param line - filled with the snapshot
+ * @param size - size of line, DAEMON_STATS_LEN is enough
+ * @param pTable - pageTable holding the counters
+ */
+void formatStats(char* line, size_t size, PageTable* pTable)
+{
+    unsigned int totalHits = pTable->countTlbHits + pTable->countPageTableHits;
+    double hitPercent = pTable->addressCount ? (double)totalHits / pTable->addressCount * 100.0 : 0.0;
+    snprintf(line, size, "Addresses processed: %u, Cache hits: %u, Page hits: %u, Misses: %u, "
+        "Total hit percentage: %.2f%%, Frames allocated: %u",
+        pTable->addressCount, pTable->countTlbHits, pTable->countPageTableHits,
+        pTable->addressCount - totalHits, hitPercent, pTable->frameCount);
+}
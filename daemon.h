@@ -0,0 +1,71 @@
+#ifndef DAEMON
+#define DAEMON
+
+#include <vector>
+#include <string>
+#include "streamSource.h"
+#include "pageTable.h"
+
+// what Daemon::wait returns
+#define DAEMON_RECORDS 0    // source has records buffered
+#define DAEMON_STATS 1      // stats were asked for, answer with answerStats
+#define DAEMON_STOP 2       // stdin ended, a quit command, SIGINT or SIGTERM
+
+#define DAEMON_STATS_LEN 256
+#define DAEMON_COMMAND_LEN 64
+
+
+/**
+ * @brief - --daemon input and control. The trace comes from stdin, or from producers connecting one
+ * after another to a UNIX socket, so the simulation state lives across every connection. A poll
+ * loop reads whatever the producer has written without blocking it and, in between, serves
+ * stats requests: SIGUSR1, or a "stats" line on the --control socket (answered on the same
+ * connection). "quit" on the control socket, SIGINT and SIGTERM end the run.
+ */
+class Daemon
+{
+public:
+    ~Daemon();      // closes the sockets and removes their paths
+
+    // waits for the next thing the simulation has to do, DAEMON_RECORDS, DAEMON_STATS or DAEMON_STOP
+    int wait();
+    void answerStats(const char* line);     // replies to every pending stats request
+
+    StreamSource* source;       // current producer, NULL while waiting for one to connect
+    unsigned int producers;     // producers connected so far
+
+    friend Daemon* startDaemon(const char* input, const char* controlPath, int format);
+
+private:
+    Daemon();
+
+    int format;
+    int listener;                   // producer socket, -1 when reading stdin
+    int control;                    // --control socket, -1 without one
+    std::string listenerPath;
+    std::string controlPath;
+    bool stopping;
+
+    struct ControlClient
+    {
+        int fd;
+        std::string pending;        // command line read so far
+    };
+    std::vector<ControlClient> clients;
+    std::vector<int> statsRequests;     // client fds to answer, -1 for SIGUSR1 (answered on stderr)
+
+    void acceptProducer();
+    void acceptControl();
+    bool readControl(ControlClient* client);    // false once the client hung up
+    void command(ControlClient* client, const std::string& line);
+};
+
+
+// input is "-" for stdin or "unix:PATH" to listen for producers on PATH. controlPath may be NULL.
+// Returns NULL after printing the reason if an endpoint can't be set up
+Daemon* startDaemon(const char* input, const char* controlPath, int format);
+
+// one line snapshot of the counters report_summary prints
+void formatStats(char* line, size_t size, PageTable* pTable);
+
+#endif
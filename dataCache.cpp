@@ -0,0 +1,279 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include "dataCache.h"
+
+
+/**
+ * @brief - constructor allocates sizeBytes / lineBytes invalid lines split into sets of ways
+ * @param name - label used by report
+ * @param sizeBytes - capacity of the level
+ * @param ways - associativity
+ * @param lineBytes - line size, a power of two
+ * @param policy - replacement policy name, see createReplacementPolicy
+ * @param seed - rng seed for the random and brrip policies
+ */
+CacheLevel::CacheLevel(const char* name, unsigned int sizeBytes, unsigned int ways, unsigned int lineBytes,
+    const char* policy, unsigned int seed)
+{
+    this->name = name;
+    this->sizeBytes = sizeBytes;
+    this->ways = ways;
+    this->lineBytes = lineBytes;
+    this->numSets = sizeBytes / lineBytes / ways;
+    strncpy(this->policy, policy, CACHE_POLICY_NAME_LEN - 1);
+    this->policy[CACHE_POLICY_NAME_LEN - 1] = '\0';
+    this->hits = 0;
+    this->misses = 0;
+    this->writebacks = 0;
+
+    Line empty;
+    empty.line = 0;
+    empty.valid = false;
+    empty.dirty = false;
+    lines.assign(numSets * ways, empty);
+    for (unsigned int set = 0; set < numSets; set++) {
+        policies.push_back(createReplacementPolicy(policy, ways, seed + set));
+    }
+}
+
+
+/**
+ * @brief - returns the way of line's set holding line, or -1
+ */
+int CacheLevel::find(unsigned int line)
+{
+    Line* set = &lines[(line % numSets) * ways];
+    for (unsigned int i = 0; i < ways; i++) {
+        if (set[i].valid && set[i].line == line) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+
+/**
+ * @brief - looks line up and counts the hit or miss
+ * @param line - physical address / lineBytes
+ * @param write - true for a store, dirties the line on a hit
+ */
+bool CacheLevel::access(unsigned int line, bool write)
+{
+    int way = find(line);
+    if (way < 0) {
+        misses++;
+        return false;
+    }
+    hits++;
+    unsigned int set = line % numSets;
+    lines[set * ways + way].dirty |= write;
+    policies[set]->onHit(way);
+    return true;
+}
+
+
+/**
+ * @brief - inserts line into its set, using an invalid way if there is one, otherwise the way the
+ * set's replacement policy picks
+ * @param line - physical line number to insert
+ * @param dirty - true if the line is written as it is filled
+ * @param victim - set to the replaced line if a valid line was replaced
+ * @param victimDirty - set to whether the replaced line has to be written back
+ */
+bool CacheLevel::fill(unsigned int line, bool dirty, unsigned int* victim, bool* victimDirty)
+{
+    unsigned int set = line % numSets;
+    Line* setLines = &lines[set * ways];
+    int way = -1;
+    bool evicted = false;
+
+    for (unsigned int i = 0; i < ways && way < 0; i++) {
+        if (!setLines[i].valid) {
+            way = i;
+        }
+    }
+    if (way < 0) {
+        way = policies[set]->victim();
+        policies[set]->onRemove(way);
+        evicted = true;
+        *victim = setLines[way].line;
+        *victimDirty = setLines[way].dirty;
+        if (setLines[way].dirty) {
+            writebacks++;
+        }
+    }
+
+    setLines[way].line = line;
+    setLines[way].valid = true;
+    setLines[way].dirty = dirty;
+    policies[set]->onInsert(way);
+    return evicted;
+}
+
+
+/**
+ * @brief - marks line dirty without touching the replacement state, for write backs from above
+ * @param line - physical line number
+ */
+bool CacheLevel::markDirty(unsigned int line)
+{
+    int way = find(line);
+    if (way < 0) {
+        return false;
+    }
+    lines[(line % numSets) * ways + way].dirty = true;
+    return true;
+}
+
+
+/**
+ * @brief - constructor. Levels that are not simulated are passed as NULL
+ * @param lineBytes - line size shared by every level, a power of two
+ */
+DataCaches::DataCaches(CacheLevel* l1, CacheLevel* l2, CacheLevel* llc, unsigned int lineBytes)
+{
+    this->levels[0] = l1;
+    this->levels[1] = l2;
+    this->levels[2] = llc;
+    this->lineBytes = lineBytes;
+    this->lineShift = 0;
+    while ((1u << lineShift) < lineBytes) lineShift++;
+    this->memoryReads = 0;
+    this->memoryWrites = 0;
+}
+
+
+/**
+ * @brief - puts a dirty line evicted from the level above into level, or into memory below the
+ * last level. A victim displaced on the way is written back further down
+ * @param level - index of the level receiving the line
+ * @param line - physical line number
+ */
+void DataCaches::writeBack(int level, unsigned int line)
+{
+    while (level < CACHE_LEVELS && levels[level] == NULL) {
+        level++;
+    }
+    if (level == CACHE_LEVELS) {
+        memoryWrites++;
+        return;
+    }
+    unsigned int victim;
+    bool victimDirty;
+    if (!levels[level]->markDirty(line) && levels[level]->fill(line, true, &victim, &victimDirty) && victimDirty) {
+        writeBack(level + 1, victim);
+    }
+}
+
+
+/**
+ * @brief - looks the line of physAddr up level by level and fills it into every level that missed
+ * @param physAddr - translated address of the access
+ * @param reqtype - trace record reqtype, MEMWRITE and IOWRITE are writes
+ */
+void DataCaches::access(uint32_t physAddr, unsigned char reqtype)
+{
+    unsigned int line = physAddr >> lineShift;
+    bool write = (reqtype == MEMWRITE || reqtype == IOWRITE);
+    int hitLevel = 0;
+
+    while (hitLevel < CACHE_LEVELS && (levels[hitLevel] == NULL || !levels[hitLevel]->access(line, write))) {
+        hitLevel++;
+    }
+    if (hitLevel == CACHE_LEVELS) {
+        memoryReads++;
+    }
+
+    // fill from the bottom up so a level's victim can be written back into the level below
+    for (int level = hitLevel - 1; level >= 0; level--) {
+        unsigned int victim;
+        bool victimDirty;
+        if (levels[level] != NULL && levels[level]->fill(line, write && level == 0, &victim, &victimDirty) && victimDirty) {
+            writeBack(level + 1, victim);
+        }
+    }
+}
+
+
+/**
+ * @brief - accesses a block of translated addresses in trace order
+ * @param physAddrs - physical address of each record
+ * @param records - the records, for their reqtype
+ * @param count - number of records
+ */
+void DataCaches::accessBatch(const uint32_t* physAddrs, const p2AddrTr* records, size_t count)
+{
+    for (size_t i = 0; i < count; i++) {
+        access(physAddrs[i], records[i].reqtype);
+    }
+}
+
+
+/**
+ * @brief - number of page colors of the largest level: frames whose number is equal modulo the
+ * color count map to the same sets
+ * @param pageSizeBytes - page size
+ */
+unsigned int DataCaches::colors(unsigned int pageSizeBytes)
+{
+    unsigned int colors = 1;
+    for (int i = 0; i < CACHE_LEVELS; i++) {
+        if (levels[i] != NULL) {
+            colors = std::max(colors, levels[i]->numSets * lineBytes / pageSizeBytes);
+        }
+    }
+    return colors;
+}
+
+
+/**
+ * @brief - prints hits, misses and write backs of each level and the traffic to memory
+ */
+void DataCaches::report()
+{
+    printf("Data caches (%u byte lines)\n", lineBytes);
+    for (int i = 0; i < CACHE_LEVELS; i++) {
+        CacheLevel* level = levels[i];
+        if (level == NULL) continue;
+        unsigned long long accesses = level->hits + level->misses;
+        printf("  %s: %u bytes, %u ways, %s, hits: %llu, misses: %llu, hit percentage: %.2f%%, write backs: %llu\n",
+            level->name, level->sizeBytes, level->ways, level->policy, level->hits, level->misses,
+            accesses ? (double)level->hits / accesses * 100.0 : 0.0, level->writebacks);
+    }
+    printf("  Memory reads: %llu, memory writes: %llu\n", memoryReads, memoryWrites);
+    fflush(stdout);
+}
+
+
+/**
+ * @brief - parses a level spec of the form size:ways[:policy]
+ * @param name - label of the level
+ * @param spec - e.g. "32K:8" or "8M:16:srrip"
+ * @param lineBytes - line size
+ * @param seed - rng seed for the random and brrip policies
+ */
+CacheLevel* parseCacheLevel(const char* name, const char* spec, unsigned int lineBytes, unsigned int seed)
+{
+    char* end;
+    unsigned long size = strtoul(spec, &end, 10);
+    if (*end == 'K' || *end == 'k') {
+        size <<= 10;
+        end++;
+    }
+    else if (*end == 'M' || *end == 'm') {
+        size <<= 20;
+        end++;
+    }
+    unsigned int ways;
+    char policy[CACHE_POLICY_NAME_LEN] = "lru";
+    int fields = sscanf(end, ":%u:%15s", &ways, policy);
+    if (fields < 1 || size == 0 || size > 0xFFFFFFFFUL || ways == 0 || size % ((unsigned long)ways * lineBytes) != 0) {
+        return NULL;
+    }
+    if (!isReplacementPolicy(policy)) {
+        return NULL;
+    }
+    return new CacheLevel(name, (unsigned int)size, ways, lineBytes, policy, seed);
+}
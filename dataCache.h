@@ -0,0 +1,96 @@
+#ifndef DATACACHE
+#define DATACACHE
+
+#include <vector>
+#include <stddef.h>
+#include "tracereader.h"
+#include "replacementPolicy.h"
+
+#define CACHE_POLICY_NAME_LEN 16
+#define DEFAULT_LINE_SIZE 64
+#define CACHE_LEVELS 3          // L1, L2 and LLC
+
+
+/**
+ * @brief - one set-associative, write-back, write-allocate cache level indexed by physical line
+ * number. Lines map to set (line % numSets) and any of its ways, and each set has its own
+ * ReplacementPolicy over its ways.
+ */
+class CacheLevel
+{
+public:
+    // constructor. sizeBytes must be a multiple of ways * lineBytes
+    CacheLevel(const char* name, unsigned int sizeBytes, unsigned int ways, unsigned int lineBytes,
+        const char* policy, unsigned int seed);
+
+    // looks line up, counting the hit or miss. A hit updates the replacement state and a write
+    // hit dirties the line
+    bool access(unsigned int line, bool write);
+    // installs line. Returns true and sets victim and victimDirty if a valid line was replaced
+    bool fill(unsigned int line, bool dirty, unsigned int* victim, bool* victimDirty);
+    // a dirty line written back from the level above. Returns false if the line isn't here
+    bool markDirty(unsigned int line);
+
+    const char* name;
+    unsigned int sizeBytes;
+    unsigned int ways;
+    unsigned int lineBytes;
+    unsigned int numSets;
+    char policy[CACHE_POLICY_NAME_LEN];
+
+    // statistics
+    unsigned long long hits;
+    unsigned long long misses;
+    unsigned long long writebacks;      // dirty lines evicted to the level below
+
+private:
+    struct Line
+    {
+        unsigned int line;
+        bool valid;
+        bool dirty;
+    };
+
+    std::vector<Line> lines;                    // numSets * ways, set major
+    std::vector<ReplacementPolicy*> policies;   // one per set
+
+    int find(unsigned int line);    // way holding line in its set, or -1
+};
+
+
+/**
+ * @brief - physically addressed L1 / L2 / LLC data caches fed with the translated address of every
+ * access. Non-inclusive: a miss fills every level it missed in, and a dirty victim is written back
+ * into the level below (allocating it there if it isn't present) or to memory from the last level.
+ * MEMWRITE and IOWRITE accesses are writes. Any level may be absent.
+ */
+class DataCaches
+{
+public:
+    DataCaches(CacheLevel* l1, CacheLevel* l2, CacheLevel* llc, unsigned int lineBytes);
+
+    void access(uint32_t physAddr, unsigned char reqtype);
+    // the same for a block translated by PageTable::translateBatch
+    void accessBatch(const uint32_t* physAddrs, const p2AddrTr* records, size_t count);
+
+    // page colors of the largest level, the number of page sized slices its sets divide into
+    unsigned int colors(unsigned int pageSizeBytes);
+
+    void report();
+
+    CacheLevel* levels[CACHE_LEVELS];   // L1, L2, LLC, NULL where not simulated
+    unsigned int lineBytes;
+    unsigned int lineShift;
+    unsigned long long memoryReads;     // accesses that missed every level
+    unsigned long long memoryWrites;    // dirty lines written back from the last level
+
+private:
+    void writeBack(int level, unsigned int line);  // dirty victim of level - 1 goes into level
+};
+
+
+// parses "size:ways[:policy]" into a new CacheLevel. size is in bytes with an optional K or M
+// suffix. Returns NULL if the spec is malformed or the size isn't a multiple of ways * lineBytes
+CacheLevel* parseCacheLevel(const char* name, const char* spec, unsigned int lineBytes, unsigned int seed);
+
+#endif
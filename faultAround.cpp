@@ -0,0 +1,144 @@
+#include <stdio.h>
+#include <algorithm>
+#include "faultAround.h"
+
+
+/**
+ * @brief - constructor, every readahead window starts closed
+ * @param faultAroundPages - block of pages mapped around a fault, a power of two. 0 or 1 for none
+ * @param readaheadMax - largest readahead window in pages, 0 for no readahead
+ */
+FaultAround::FaultAround(unsigned int faultAroundPages, unsigned int readaheadMax)
+{
+    this->faultAroundPages = faultAroundPages;
+    this->readaheadMax = readaheadMax;
+    for (int kind = 0; kind < 2; kind++) {
+        this->pagesMapped[kind] = 0;
+        this->faultsAvoided[kind] = 0;
+        this->evictedUnused[kind] = 0;
+    }
+    this->windowGrown = 0;
+    this->windowShrunk = 0;
+}
+
+
+/**
+ * @brief - picks the pages to map ahead for a fault on vpn. Fault-around takes the aligned block of
+ * faultAroundPages pages holding vpn, no bigger than the leaf. Readahead grows or shrinks the
+ * process's window and takes that many pages after vpn that fault-around didn't already take
+ * @param asid - process of the fault, NO_ASID without --asid
+ * @param vpn - page that faulted
+ * @param leafPages - pages covered by one leaf level, a power of two
+ * @param numPages - pages in the virtual address space
+ */
+void FaultAround::plan(unsigned int asid, unsigned int vpn, unsigned int leafPages, unsigned int numPages)
+{
+    candidates.clear();
+    unsigned int highest = vpn;
+    Candidate candidate;
+
+    if (faultAroundPages > 1) {
+        unsigned int block = std::min(faultAroundPages, leafPages);
+        unsigned int start = vpn - vpn % block;
+        candidate.readahead = false;
+        for (unsigned int page = start; page < start + block; page++) {
+            if (page != vpn) {
+                candidate.vpn = page;
+                candidates.push_back(candidate);
+            }
+        }
+        highest = start + block - 1;
+    }
+
+    if (readaheadMax > 0) {
+        Stream fresh = { 0, 0xFFFFFFFF };
+        Stream* stream = &streams.insert(std::make_pair(asid, fresh)).first->second;
+        if (vpn == stream->next) {
+            stream->window = stream->window == 0 ? std::min((unsigned int)READAHEAD_INITIAL_WINDOW, readaheadMax)
+                : std::min(stream->window * 2, readaheadMax);
+            windowGrown++;
+        }
+        else if (stream->window > 0) {
+            stream->window /= 2;
+            windowShrunk++;
+        }
+        candidate.readahead = true;
+        for (unsigned int page = highest + 1; page <= vpn + stream->window && page < numPages; page++) {
+            candidate.vpn = page;
+            candidates.push_back(candidate);
+        }
+        highest = std::max(highest, vpn + stream->window);
+        stream->next = highest + 1;
+    }
+}
+
+
+/**
+ * @brief - notes a page mapped ahead of use
+ * @param page - vpn, with the asid above ASID_SHIFT
+ * @param readahead - true if readahead mapped it, false for fault-around
+ */
+void FaultAround::mapped(unsigned long long page, bool readahead)
+{
+    pagesMapped[readahead]++;
+    unused[page] = readahead;
+}
+
+
+/**
+ * @brief - a page table walk found page mapped. The first walk to a page mapped ahead would have
+ * been a fault without it
+ */
+void FaultAround::walked(unsigned long long page)
+{
+    if (unused.empty()) {
+        return;
+    }
+    std::unordered_map<unsigned long long, bool>::iterator it = unused.find(page);
+    if (it != unused.end()) {
+        faultsAvoided[it->second]++;
+        unused.erase(it);
+    }
+}
+
+
+/**
+ * @brief - a page lost its frame to a --frames eviction. If it was mapped ahead and never walked
+ * to, the frame was wasted
+ */
+void FaultAround::evicted(unsigned long long page)
+{
+    std::unordered_map<unsigned long long, bool>::iterator it = unused.find(page);
+    if (it != unused.end()) {
+        evictedUnused[it->second]++;
+        unused.erase(it);
+    }
+}
+
+
+/**
+ * @brief - prints the pages each policy mapped ahead, the faults they avoided and the pages that
+ * were never used, evicted first or still mapped at the end
+ * @param faults - page faults taken in the run
+ * @param frames - frames allocated in the run, including the pages mapped ahead
+ */
+void FaultAround::report(unsigned long long faults, unsigned long long frames)
+{
+    unsigned long long stillUnused[2] = { 0, 0 };
+    for (std::unordered_map<unsigned long long, bool>::iterator it = unused.begin(); it != unused.end(); it++) {
+        stillUnused[it->second]++;
+    }
+    unsigned long long ahead = pagesMapped[0] + pagesMapped[1];
+    unsigned long long avoided = faultsAvoided[0] + faultsAvoided[1];
+
+    printf("Fault-around: %u pages, readahead: up to %u pages (window grown: %llu, shrunk: %llu)\n",
+        faultAroundPages > 1 ? faultAroundPages : 0, readaheadMax, windowGrown, windowShrunk);
+    printf("  Pages mapped ahead: fault-around: %llu, readahead: %llu, share of frames allocated: %.2f%%\n",
+        pagesMapped[0], pagesMapped[1], frames ? (double)ahead / frames * 100.0 : 0.0);
+    printf("  Faults avoided: fault-around: %llu, readahead: %llu, share of faults without them: %.2f%%\n",
+        faultsAvoided[0], faultsAvoided[1], faults + avoided ? (double)avoided / (faults + avoided) * 100.0 : 0.0);
+    printf("  Never used: fault-around: %llu, readahead: %llu (evicted first: %llu, still mapped: %llu)\n",
+        evictedUnused[0] + stillUnused[0], evictedUnused[1] + stillUnused[1],
+        evictedUnused[0] + evictedUnused[1], stillUnused[0] + stillUnused[1]);
+    fflush(stdout);
+}
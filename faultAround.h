@@ -0,0 +1,65 @@
+#ifndef FAULTAROUND
+#define FAULTAROUND
+
+#include <vector>
+#include <unordered_map>
+
+#define READAHEAD_INITIAL_WINDOW 4      // pages read ahead once a fault looks sequential
+
+
+/**
+ * @brief - --fault-around and --readahead, pages mapped ahead of use on a page fault.
+ *      fault-around - the aligned block of K pages around the faulting page, clipped to its leaf
+ *          level so a fault never allocates a new leaf
+ *      readahead - the window of pages after the faulting page. A fault on the page right after
+ *          everything the previous fault of the process mapped is sequential and doubles the
+ *          window, up to the maximum, any other fault halves it
+ * Pages that are already mapped are skipped. A page mapped ahead counts as a fault avoided the
+ * first time it is walked to, and as never used if it is still untouched at the end or evicted first.
+ */
+class FaultAround
+{
+public:
+    // faultAroundPages a power of two, 0 for none. readaheadMax 0 for no readahead
+    FaultAround(unsigned int faultAroundPages, unsigned int readaheadMax);
+
+    struct Candidate
+    {
+        unsigned int vpn;
+        bool readahead;         // false for fault-around
+    };
+
+    // fills candidates with the pages to map ahead for a fault on vpn by process asid, inside a
+    // leaf level of leafPages pages and below numPages. Updates the readahead window
+    void plan(unsigned int asid, unsigned int vpn, unsigned int leafPages, unsigned int numPages);
+    std::vector<Candidate> candidates;
+
+    // page keys are the vpn with the asid above ASID_SHIFT
+    void mapped(unsigned long long page, bool readahead);
+    void walked(unsigned long long page);       // the page was walked to, counts the fault it avoided
+    void evicted(unsigned long long page);      // the page lost its frame
+
+    // faults - page faults taken, frames - frames allocated including the pages mapped ahead
+    void report(unsigned long long faults, unsigned long long frames);
+
+    unsigned int faultAroundPages;
+    unsigned int readaheadMax;
+
+    // statistics, [0] fault-around and [1] readahead
+    unsigned long long pagesMapped[2];
+    unsigned long long faultsAvoided[2];
+    unsigned long long evictedUnused[2];
+    unsigned long long windowGrown;
+    unsigned long long windowShrunk;
+
+private:
+    struct Stream
+    {
+        unsigned int window;        // pages read ahead on the next fault
+        unsigned int next;          // page after the last one mapped for the previous fault
+    };
+    std::unordered_map<unsigned int, Stream> streams;       // readahead state per asid
+    std::unordered_map<unsigned long long, bool> unused;    // pages mapped ahead and not walked to yet -> readahead
+};
+
+#endif
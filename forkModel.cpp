@@ -0,0 +1,159 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+#include "forkModel.h"
+#include "pageTable.h"
+
+
+ForkModel::ForkModel()
+{
+    this->nextEvent = 0;
+    this->forks = 0;
+    this->skippedForks = 0;
+    this->framesShared = 0;
+    this->cowFaults = 0;
+}
+
+
+/**
+ * @brief - adds a reference to every frame mapped under level, which a new child now maps too
+ */
+void ForkModel::shareFrames(PageTable* pTable, Level* level)
+{
+    unsigned int entries = pTable->entryCountArr[level->currDepth];
+    if (level->mapPtr != nullptr) {
+        for (unsigned int i = 0; i < entries; i++) {
+            if (level->mapPtr[i].isValid()) {
+                frameRefs.insert(std::make_pair(level->mapPtr[i].getFrameNum(), 1u)).first->second++;
+                framesShared++;
+            }
+        }
+    }
+    for (unsigned int i = 0; level->nextLevel != nullptr && i < entries; i++) {
+        if (level->nextLevel[i] != nullptr) {
+            shareFrames(pTable, level->nextLevel[i]);
+        }
+    }
+}
+
+
+/**
+ * @brief - runs every fork due before record. A fork whose parent hasn't run a record yet, or whose
+ * child already has, is skipped
+ */
+void ForkModel::runForks(PageTable* pTable, unsigned long long record)
+{
+    while (nextEvent < events.size() && events[nextEvent].record <= record) {
+        Event* event = &events[nextEvent++];
+        if (!pTable->forkProcess(event->parent, event->child)) {
+            skippedForks++;
+            continue;
+        }
+        shareFrames(pTable, pTable->processRoots[event->child]);
+        forks++;
+    }
+}
+
+
+/**
+ * @brief - COW fault for a write to a page whose frame other processes map too. The writer's path
+ * to the page is made private, the page gets a frame of its own and the old frame loses a
+ * reference. The writer's stale translation leaves the TLB, so the write walks to the new frame.
+ * The last process left on a frame writes it in place
+ */
+void ForkModel::copyOnWrite(PageTable* pTable, tlb* cache, const p2AddrTr* trace)
+{
+    unsigned int vpn = trace->addr >> pTable->offsetShift;
+    Map* frame = pTable->lookup(vpn);
+    if (frame == nullptr) {
+        return;
+    }
+    std::unordered_map<unsigned int, unsigned int>::iterator shared = frameRefs.find(frame->getFrameNum());
+    if (shared == frameRefs.end()) {
+        return;
+    }
+    if (--shared->second == 1) {
+        frameRefs.erase(shared);
+    }
+
+    frame = pTable->privateMap(vpn);
+    frame->setFrameNum(pTable->nextFrame(vpn, trace->proc));
+    pTable->takeFrame(vpn, trace->proc);
+    cowFaults++;
+    if (cache != NULL) {
+        cache->invalidate(vpn);
+    }
+}
+
+
+/**
+ * @brief - prints the forks, the COW faults and the frames and page table bytes sharing still
+ * saves at the end of the run
+ */
+void ForkModel::report(PageTable* pTable)
+{
+    unsigned long long framesSaved = 0;
+    for (std::unordered_map<unsigned int, unsigned int>::iterator it = frameRefs.begin(); it != frameRefs.end(); it++) {
+        framesSaved += it->second - 1;
+    }
+    unsigned long long unshared = 0;
+    for (std::map<unsigned int, Level*>::iterator it = pTable->processRoots.begin(); it != pTable->processRoots.end(); it++) {
+        unshared += pTable->unsharedBytes(it->second);
+    }
+
+    printf("Forks: %llu (skipped: %llu), processes: %lu\n", forks, skippedForks,
+        (unsigned long)std::max(pTable->processRoots.size(), (size_t)1));
+    printf("  COW faults: %llu, frames shared at fork: %llu, page table levels copied on write: %llu\n",
+        cowFaults, framesShared, pTable->levelsCopied);
+    printf("  Shared frames: %lu, frames saved: %llu (%llu bytes)\n", (unsigned long)frameRefs.size(), framesSaved,
+        framesSaved * pTable->pageSizeBytes);
+    printf("  Page table bytes: %u, without sharing: %llu, saved: %.2f%%\n", pTable->numBytesSize, unshared,
+        unshared ? (double)(unshared - std::min(unshared, (unsigned long long)pTable->numBytesSize)) / unshared * 100.0 : 0.0);
+    fflush(stdout);
+}
+
+
+/**
+ * @brief - reads a --fork file of "record parent child" lines, sorted by record. Blank lines and #
+ * comments are skipped
+ * @return false after printing why if the file can't be read or a line is malformed
+ */
+static bool loadForks(const char* path, std::vector<ForkModel::Event>* events)
+{
+    FILE* in = fopen(path, "r");
+    if (in == NULL) {
+        fprintf(stderr, "Unable to open fork events %s\n", path);
+        return false;
+    }
+    char line[256];
+    unsigned int lineNum = 0;
+    while (fgets(line, sizeof(line), in) != NULL) {
+        lineNum++;
+        char first[2];
+        if (sscanf(line, " %1s", first) != 1 || first[0] == '#') {
+            continue;
+        }
+        ForkModel::Event event;
+        if (sscanf(line, "%llu %u %u", &event.record, &event.parent, &event.child) != 3 || event.parent == event.child) {
+            fprintf(stderr, "%s:%u: expected \"record parent child\" with two different procs\n", path, lineNum);
+            fclose(in);
+            return false;
+        }
+        events->push_back(event);
+    }
+    fclose(in);
+    std::stable_sort(events->begin(), events->end(),
+        [](const ForkModel::Event& a, const ForkModel::Event& b) { return a.record < b.record; });
+    return true;
+}
+
+
+ForkModel* createForkModel(const char* path)
+{
+    ForkModel* forks = new ForkModel();
+    if (!loadForks(path, &forks->events)) {
+        delete forks;
+        return NULL;
+    }
+    return forks;
+}
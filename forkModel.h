@@ -0,0 +1,72 @@
+#ifndef FORKMODEL
+#define FORKMODEL
+
+#include <vector>
+#include <unordered_map>
+#include "tlb.h"
+#include "tracereader.h"
+
+class PageTable;
+class Level;
+
+
+/**
+ * @brief - --fork, pre-fork workloads. A fork event makes a process a copy-on-write copy of
+ * another before a given record: the child shares the parent's page table levels and frames. Every
+ * frame mapped by more than one process has a reference count, and the first write of a process to
+ * such a page is a COW fault that copies the frame and the page table levels on its path. Reads and
+ * pages faulted in after the fork never copy anything.
+ */
+class ForkModel
+{
+public:
+    ForkModel();
+
+    // runs the forks due before simulated record number record. Called before the context switch
+    // to the record's proc, so a child's first record finds the page table it was forked with
+    void beforeSwitch(PageTable* pTable, unsigned long long record)
+    {
+        if (nextEvent < events.size() && events[nextEvent].record <= record) {
+            runForks(pTable, record);
+        }
+    }
+
+    // takes a COW fault if trace writes a shared frame. Called after the context switch
+    void beforeAccess(PageTable* pTable, tlb* cache, const p2AddrTr* trace)
+    {
+        if (!frameRefs.empty() && (trace->reqtype == MEMWRITE || trace->reqtype == IOWRITE)) {
+            copyOnWrite(pTable, cache, trace);
+        }
+    }
+
+    void report(PageTable* pTable);
+
+    struct Event
+    {
+        unsigned long long record;      // simulated records before the fork
+        unsigned int parent;            // trace procs
+        unsigned int child;
+    };
+
+    std::vector<Event> events;          // --fork in record order
+    size_t nextEvent;
+    std::unordered_map<unsigned int, unsigned int> frameRefs;   // frame -> processes mapping it, when more than 1
+
+    // statistics
+    unsigned long long forks;
+    unsigned long long skippedForks;    // parent hadn't run yet or child already had
+    unsigned long long framesShared;    // frame references handed to children
+    unsigned long long cowFaults;       // writes that copied a frame
+
+private:
+    void runForks(PageTable* pTable, unsigned long long record);
+    void copyOnWrite(PageTable* pTable, tlb* cache, const p2AddrTr* trace);
+    void shareFrames(PageTable* pTable, Level* level);
+};
+
+
+// creates a ForkModel from a file of "record parent child" lines. Returns NULL after printing why if
+// the file can't be read
+ForkModel* createForkModel(const char* path);
+
+#endif
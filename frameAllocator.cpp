@@ -0,0 +1,320 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "frameAllocator.h"
+
+
+/**
+ * @brief - constructor
+ * @param name - label used by report
+ * @param frameSpace - number of frames that may be handed out
+ */
+FrameAllocator::FrameAllocator(const char* name, unsigned int frameSpace)
+{
+    this->name = name;
+    this->frameSpace = frameSpace;
+    this->countsAccesses = false;
+    this->beyondSpace = 0;
+}
+
+
+void FrameAllocator::report()
+{
+    printf("Frame allocation: %s\n", name);
+    if (beyondSpace > 0) {
+        printf("  Faults numbered past the %u frame space: %llu\n", frameSpace, beyondSpace);
+    }
+    fflush(stdout);
+}
+
+
+/**
+ * @brief - constructor starts with the identity permutation
+ * @param frameSpace - frames to shuffle
+ * @param seed - rng seed
+ */
+RandomFrameAllocator::RandomFrameAllocator(unsigned int frameSpace, unsigned int seed)
+    : FrameAllocator("random", frameSpace), rng(seed)
+{
+    this->handedOut = 0;
+    this->drawn = 0;
+    this->pending = false;
+}
+
+/**
+ * @brief - frame at shuffle position, positions never swapped still hold their own number
+ */
+unsigned int RandomFrameAllocator::at(unsigned int position)
+{
+    std::unordered_map<unsigned int, unsigned int>::iterator it = swapped.find(position);
+    return it == swapped.end() ? position : it->second;
+}
+
+/**
+ * @brief - draws the Fisher-Yates position of the next frame, once per fault. Once the whole space
+ * is handed out, frames are numbered sequentially past it
+ */
+unsigned int RandomFrameAllocator::next(unsigned int vpn, unsigned int proc)
+{
+    if (handedOut >= frameSpace) {
+        return frameSpace + beyondSpace;
+    }
+    if (!pending) {
+        drawn = handedOut + rng() % (frameSpace - handedOut);
+        pending = true;
+    }
+    return at(drawn);
+}
+
+/**
+ * @brief - swaps the drawn frame into the next position of the shuffle
+ */
+void RandomFrameAllocator::take(unsigned int vpn, unsigned int proc)
+{
+    if (handedOut >= frameSpace) {
+        beyondSpace++;
+        return;
+    }
+    next(vpn, proc);
+    swapped[drawn] = at(handedOut);
+    swapped.erase(handedOut);
+    handedOut++;
+    pending = false;
+}
+
+
+/**
+ * @brief - constructor
+ * @param name - label used by report
+ * @param frameSpace - frames split over the bins
+ * @param numBins - number of bins, frame f is in bin f % numBins
+ */
+BinnedFrameAllocator::BinnedFrameAllocator(const char* name, unsigned int frameSpace, unsigned int numBins)
+    : FrameAllocator(name, frameSpace)
+{
+    this->numBins = numBins;
+    this->used.assign(numBins, 0);
+    this->fallbacks = 0;
+}
+
+/**
+ * @brief - frames in bin b, numbered b, b + numBins, ... below frameSpace
+ */
+unsigned int BinnedFrameAllocator::capacity(unsigned int b)
+{
+    return b < frameSpace ? (frameSpace - b + numBins - 1) / numBins : 0;
+}
+
+/**
+ * @brief - the preferred bin if it has frames left, otherwise the next one round that does
+ * @param fallback - set to true if the preferred bin was full
+ * @return the bin, numBins if every bin is full
+ */
+unsigned int BinnedFrameAllocator::binWithRoom(unsigned int vpn, unsigned int proc, bool* fallback)
+{
+    unsigned int b = bin(vpn, proc);
+    *fallback = false;
+    for (unsigned int i = 0; used[b] >= capacity(b); i++) {
+        if (i == numBins) {
+            return numBins;
+        }
+        b = (b + 1) % numBins;
+        *fallback = true;
+    }
+    return b;
+}
+
+/**
+ * @brief - the next frame of the bin with room. Once every bin is full, frames are numbered
+ * sequentially past frameSpace
+ */
+unsigned int BinnedFrameAllocator::next(unsigned int vpn, unsigned int proc)
+{
+    bool fallback;
+    unsigned int b = binWithRoom(vpn, proc, &fallback);
+    return b == numBins ? frameSpace + beyondSpace : b + numBins * used[b];
+}
+
+void BinnedFrameAllocator::take(unsigned int vpn, unsigned int proc)
+{
+    bool fallback;
+    unsigned int b = binWithRoom(vpn, proc, &fallback);
+    if (b == numBins) {
+        beyondSpace++;
+    }
+    else {
+        used[b]++;
+        fallbacks += fallback;
+    }
+}
+
+
+/**
+ * @brief - constructor
+ * @param frameSpace - frames that may be handed out
+ * @param colors - number of page colors
+ */
+ColorFrameAllocator::ColorFrameAllocator(unsigned int frameSpace, unsigned int colors)
+    : BinnedFrameAllocator("color", frameSpace, colors)
+{
+}
+
+unsigned int ColorFrameAllocator::bin(unsigned int vpn, unsigned int proc)
+{
+    return vpn % numBins;
+}
+
+void ColorFrameAllocator::report()
+{
+    printf("Frame allocation: page coloring, %u colors, faults given another color: %llu\n", numBins, fallbacks);
+    if (beyondSpace > 0) {
+        printf("  Faults numbered past the %u frame space: %llu\n", frameSpace, beyondSpace);
+    }
+    fflush(stdout);
+}
+
+
+/**
+ * @brief - constructor
+ * @param frameSpace - frames split over the nodes
+ * @param nodes - number of NUMA nodes
+ * @param interleave - true for round robin placement, false for first touch
+ * @param latencies - nodes * nodes access latencies in ns, row major by accessing node
+ */
+NumaFrameAllocator::NumaFrameAllocator(unsigned int frameSpace, unsigned int nodes, bool interleave,
+    const std::vector<double>& latencies)
+    : BinnedFrameAllocator("numa", frameSpace, nodes)
+{
+    this->interleave = interleave;
+    this->latencies = latencies;
+    this->countsAccesses = true;
+    this->localAccesses = 0;
+    this->remoteAccesses = 0;
+    this->totalLatency = 0;
+    this->localLatency = 0;
+    this->faults = 0;
+}
+
+unsigned int NumaFrameAllocator::bin(unsigned int vpn, unsigned int proc)
+{
+    return interleave ? faults % numBins : proc % numBins;
+}
+
+void NumaFrameAllocator::take(unsigned int vpn, unsigned int proc)
+{
+    BinnedFrameAllocator::take(vpn, proc);
+    faults++;
+}
+
+/**
+ * @brief - counts the access as local or remote and charges its latency
+ * @param frameNum - frame the access translated to
+ * @param proc - trace proc that made it
+ */
+void NumaFrameAllocator::access(unsigned int frameNum, unsigned int proc)
+{
+    unsigned int cpuNode = proc % numBins;
+    unsigned int memNode = frameNum % numBins;
+    if (cpuNode == memNode) {
+        localAccesses++;
+    }
+    else {
+        remoteAccesses++;
+    }
+    totalLatency += latencies[cpuNode * numBins + memNode];
+    localLatency += latencies[cpuNode * numBins + cpuNode];
+}
+
+/**
+ * @brief - prints the placement, the frames on every node, the remote access fraction and the
+ * average latency against an all local run
+ */
+void NumaFrameAllocator::report()
+{
+    unsigned long long accesses = localAccesses + remoteAccesses;
+    printf("Frame allocation: NUMA, %u nodes, %s\n", numBins, interleave ? "interleave" : "first touch");
+    for (unsigned int node = 0; node < numBins; node++) {
+        printf("  Node %u: %u frames\n", node, used[node]);
+    }
+    printf("  Local accesses: %llu, remote accesses: %llu, remote percentage: %.2f%%\n",
+        localAccesses, remoteAccesses, accesses ? (double)remoteAccesses / accesses * 100.0 : 0.0);
+    printf("  Average memory latency: %.1f ns, all local: %.1f ns, slowdown: %.2f%%\n",
+        accesses ? totalLatency / accesses : 0.0, accesses ? localLatency / accesses : 0.0,
+        localLatency > 0 ? (totalLatency / localLatency - 1.0) * 100.0 : 0.0);
+    if (fallbacks > 0) {
+        printf("  Faults placed on another node because the preferred one was full: %llu\n", fallbacks);
+    }
+    if (beyondSpace > 0) {
+        printf("  Faults numbered past the %u frame space: %llu\n", frameSpace, beyondSpace);
+    }
+    fflush(stdout);
+}
+
+
+/**
+ * @brief - parses a spec, see isFrameAllocator
+ * @return 0 sequential, 1 random, 2 color, 3 numa, -1 malformed. count and interleave are set
+ * from the spec
+ */
+static int parseFrameAllocator(const char* spec, unsigned int* count, bool* interleave)
+{
+    char placement[16] = "first-touch";
+    *count = 0;
+    *interleave = false;
+    if (strcmp(spec, "sequential") == 0) return 0;
+    if (strcmp(spec, "random") == 0) return 1;
+    if (strcmp(spec, "color") == 0) return 2;
+    if (sscanf(spec, "color:%u", count) == 1 && *count > 0) return 2;
+    if (sscanf(spec, "numa:%u:%15s", count, placement) >= 1 && *count > 0) {
+        if (strcmp(placement, "first-touch") == 0) return 3;
+        if (strcmp(placement, "interleave") == 0) {
+            *interleave = true;
+            return 3;
+        }
+    }
+    return -1;
+}
+
+
+/**
+ * @brief - returns true if spec names a frame allocation policy
+ */
+bool isFrameAllocator(const char* spec)
+{
+    unsigned int count;
+    bool interleave;
+    return parseFrameAllocator(spec, &count, &interleave) >= 0;
+}
+
+
+/**
+ * @brief - factory for --frame-alloc
+ * @param spec - sequential, random, color[:N] or numa:N[:first-touch|interleave]
+ * @param frameSpace - frames that may be handed out
+ * @param colors - colors for a spec of plain color
+ * @param latencies - NUMA latency table, empty for NUMA_LOCAL_LATENCY / NUMA_REMOTE_LATENCY
+ * @param seed - rng seed for random
+ */
+FrameAllocator* createFrameAllocator(const char* spec, unsigned int frameSpace, unsigned int colors,
+    const std::vector<double>& latencies, unsigned int seed)
+{
+    unsigned int count;
+    bool interleave;
+    switch (parseFrameAllocator(spec, &count, &interleave)) {
+    case 1:
+        return new RandomFrameAllocator(frameSpace, seed);
+    case 2:
+        return new ColorFrameAllocator(frameSpace, count > 0 ? count : colors);
+    case 3: {
+        std::vector<double> table = latencies;
+        if (table.empty()) {
+            for (unsigned int i = 0; i < count * count; i++) {
+                table.push_back(i / count == i % count ? NUMA_LOCAL_LATENCY : NUMA_REMOTE_LATENCY);
+            }
+        }
+        return new NumaFrameAllocator(frameSpace, count, interleave, table);
+    }
+    default:
+        return NULL;
+    }
+}
@@ -0,0 +1,142 @@
+#ifndef FRAMEALLOCATOR
+#define FRAMEALLOCATOR
+
+#include <vector>
+#include <random>
+#include <unordered_map>
+
+#define NUMA_LOCAL_LATENCY 80.0     // default ns for an access to the cpu's own node
+#define NUMA_REMOTE_LATENCY 140.0   // default ns for an access to any other node
+
+
+/**
+ * @brief - --frame-alloc policy, picks the frame a page fault maps. next is the frame the fault
+ * would get and has no side effects, take hands it out. Frames are numbered 0..frameSpace-1. With
+ * --frames PageTable never asks for more (it evicts once they're all used), but without it every
+ * --asid process faults into the one pool, so once the space is used up the remaining faults are
+ * numbered sequentially past frameSpace, as PageTable numbers them without an allocator.
+ * Sequential allocation is done by PageTable itself and has no FrameAllocator.
+ */
+class FrameAllocator
+{
+public:
+    FrameAllocator(const char* name, unsigned int frameSpace);
+    virtual ~FrameAllocator() {}
+
+    // vpn is the faulting page and proc the trace proc (cpu) that touched it
+    virtual unsigned int next(unsigned int vpn, unsigned int proc) = 0;
+    virtual void take(unsigned int vpn, unsigned int proc) = 0;
+
+    // called for every access when countsAccesses is set
+    virtual void access(unsigned int frameNum, unsigned int proc) {}
+    bool countsAccesses;
+
+    virtual void report();
+
+    const char* name;
+    unsigned int frameSpace;        // frames that may be handed out
+    unsigned long long beyondSpace; // faults numbered past frameSpace
+};
+
+
+/**
+ * @brief - frames in a uniformly random order, like a long running kernel's free lists. The order
+ * is a Fisher-Yates shuffle of the frame space drawn lazily, one frame per fault, so memory is
+ * proportional to the frames handed out. Seeded so runs are repeatable
+ */
+class RandomFrameAllocator : public FrameAllocator
+{
+public:
+    RandomFrameAllocator(unsigned int frameSpace, unsigned int seed);
+    unsigned int next(unsigned int vpn, unsigned int proc);
+    void take(unsigned int vpn, unsigned int proc);
+
+private:
+    std::mt19937 rng;
+    std::unordered_map<unsigned int, unsigned int> swapped;    // shuffle positions moved so far
+    unsigned int handedOut;
+    unsigned int drawn;         // position picked for the pending fault
+    bool pending;
+
+    unsigned int at(unsigned int position);
+};
+
+
+/**
+ * @brief - frames split into numBins classes by frameNum % numBins. A fault takes the next frame of
+ * the bin bin() prefers, or of the following bin with frames left once that one is used up
+ */
+class BinnedFrameAllocator : public FrameAllocator
+{
+public:
+    BinnedFrameAllocator(const char* name, unsigned int frameSpace, unsigned int numBins);
+    unsigned int next(unsigned int vpn, unsigned int proc);
+    void take(unsigned int vpn, unsigned int proc);
+
+    unsigned int numBins;
+    std::vector<unsigned int> used;     // frames handed out per bin
+    unsigned long long fallbacks;       // faults that didn't get their preferred bin
+
+protected:
+    virtual unsigned int bin(unsigned int vpn, unsigned int proc) = 0;
+
+private:
+    unsigned int capacity(unsigned int b);
+    unsigned int binWithRoom(unsigned int vpn, unsigned int proc, bool* fallback);      // numBins if every bin is full
+};
+
+
+/**
+ * @brief - page coloring. A page's color is vpn % colors and it gets a frame of the same color, so
+ * pages only compete for cache sets with pages that share their virtual color
+ */
+class ColorFrameAllocator : public BinnedFrameAllocator
+{
+public:
+    ColorFrameAllocator(unsigned int frameSpace, unsigned int colors);
+    void report();
+
+protected:
+    unsigned int bin(unsigned int vpn, unsigned int proc);
+};
+
+
+/**
+ * @brief - NUMA placement over nodes nodes. Frame f lives on node f % nodes and trace proc p runs on
+ * node p % nodes. First touch puts a page on the node of the cpu that faults it, interleave
+ * spreads pages round robin over the nodes. Every access is charged the latency of the accessing
+ * node to the page's node.
+ */
+class NumaFrameAllocator : public BinnedFrameAllocator
+{
+public:
+    // latencies is nodes * nodes ns, row the accessing node and column the memory node
+    NumaFrameAllocator(unsigned int frameSpace, unsigned int nodes, bool interleave, const std::vector<double>& latencies);
+    void take(unsigned int vpn, unsigned int proc);
+    void access(unsigned int frameNum, unsigned int proc);
+    void report();
+
+    bool interleave;
+    std::vector<double> latencies;
+    unsigned long long localAccesses;
+    unsigned long long remoteAccesses;
+    double totalLatency;            // ns over every access
+    double localLatency;            // ns had every access been to the cpu's own node
+
+protected:
+    unsigned int bin(unsigned int vpn, unsigned int proc);
+
+private:
+    unsigned int faults;
+};
+
+
+// true if spec is sequential, random, color, color:N, numa:N, numa:N:first-touch or numa:N:interleave
+bool isFrameAllocator(const char* spec);
+
+// returns the allocator for spec, NULL for sequential. colors is used for color without N, and
+// latencies (nodes * nodes ns) for numa, empty for the default local / remote latencies
+FrameAllocator* createFrameAllocator(const char* spec, unsigned int frameSpace, unsigned int colors,
+    const std::vector<double>& latencies, unsigned int seed);
+
+#endif
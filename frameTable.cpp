@@ -0,0 +1,129 @@
+#include "frameTable.h"
+#include "pageTable.h"
+#include <stdio.h>
+
+
+/**
+ * @brief - constructor. PageTable hands frames out, in order or through its FrameAllocator, until the
+ * table is full, so none hold a page yet
+ * @param numFrames - physical frames available
+ * @param pageSizeBytes - bytes written back per dirty eviction
+ */
+FrameTable::FrameTable(unsigned int numFrames, unsigned int pageSizeBytes)
+{
+    this->numFrames = numFrames;
+    this->pageSizeBytes = pageSizeBytes;
+    this->frameVpn.assign(numFrames, 0);
+    this->frameAsid.assign(numFrames, NO_ASID);
+    this->hand = 0;
+    this->cleanEvictions = 0;
+    this->dirtyEvictions = 0;
+    this->writebackBytes = 0;
+    this->tiers = NULL;
+}
+
+
+/**
+ * @brief - returns true when every frame has been handed out
+ * @param framesHandedOut - PageTable::currFrameNum
+ */
+bool FrameTable::full(unsigned int framesHandedOut)
+{
+    return framesHandedOut >= numFrames;
+}
+
+
+/**
+ * @brief - records that frameNum now holds vpn of process asid
+ * @param frameNum - frame being filled
+ * @param vpn - page mapped to it
+ * @param asid - PageTable::currAsid of the fault
+ */
+void FrameTable::assign(unsigned int frameNum, unsigned int vpn, unsigned int asid)
+{
+    frameVpn[frameNum] = vpn;
+    frameAsid[frameNum] = asid;
+}
+
+
+/**
+ * @brief - returns the vpn held by frameNum
+ * @param frameNum - frame to check
+ */
+unsigned int FrameTable::vpnIn(unsigned int frameNum)
+{
+    return frameVpn[frameNum];
+}
+
+
+/**
+ * @brief - returns the asid of the process whose page frameNum holds
+ * @param frameNum - frame to check
+ */
+unsigned int FrameTable::asidIn(unsigned int frameNum)
+{
+    return frameAsid[frameNum];
+}
+
+
+/**
+ * @brief - enhanced second chance. Odd passes look for (unreferenced, dirty) and clear the
+ * referenced bit of every page they pass, so the fourth pass at the latest finds a victim.
+ * Only called when every frame is full
+ * @param pTable - pageTable holding the access bits of each frame's page, in any process
+ */
+unsigned int FrameTable::victim(PageTable* pTable)
+{
+    for (int pass = 0; ; pass++) {
+        for (unsigned int i = 0; i < numFrames; i++) {
+            unsigned int frameNum = hand;
+            hand = (hand + 1) % numFrames;
+            Map* frame = pTable->lookupIn(frameAsid[frameNum], frameVpn[frameNum]);
+            if (frame->isReferenced()) {
+                if (pass % 2 == 1) {
+                    frame->clearReferenced();
+                }
+                continue;
+            }
+            if (!frame->isDirty()) {
+                cleanEvictions++;
+                return frameNum;
+            }
+            if (pass % 2 == 1) {
+                dirtyEvictions++;
+                writebackBytes += pageSizeBytes;
+                return frameNum;
+            }
+        }
+    }
+}
+
+
+/**
+ * @brief - counts the dirty pages still in memory, which would need writing back at exit. Frames
+ * that were never handed out hold no page mapped to them
+ * @param pTable - pageTable holding the access bits of every process
+ */
+unsigned int FrameTable::dirtyResident(PageTable* pTable)
+{
+    unsigned int dirty = 0;
+    for (unsigned int frameNum = 0; frameNum < numFrames; frameNum++) {
+        Map* frame = pTable->lookupIn(frameAsid[frameNum], frameVpn[frameNum]);
+        dirty += frame != nullptr && frame->getFrameNum() == frameNum && frame->isDirty();
+    }
+    return dirty;
+}
+
+
+/**
+ * @brief - prints the eviction counts and writeback traffic
+ * @param pTable - pageTable, for the dirty pages left in memory
+ */
+void FrameTable::report(PageTable* pTable)
+{
+    unsigned long long evictions = cleanEvictions + dirtyEvictions;
+    printf("Frame limit: %u frames, evictions: %llu (clean: %llu, dirty: %llu)\n",
+        numFrames, evictions, cleanEvictions, dirtyEvictions);
+    printf("  Writeback bytes: %llu, dirty pages resident: %u\n", writebackBytes, dirtyResident(pTable));
+    fflush(stdout);
+}
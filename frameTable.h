@@ -0,0 +1,50 @@
+#ifndef FRAMETABLE
+#define FRAMETABLE
+
+#include <vector>
+#include "translationBackend.h"
+#include "memoryTiers.h"
+
+class PageTable;
+
+/**
+ * @brief - physical memory for --frames. Holds the vpn mapped in each frame so a victim can be
+ * unmapped, and picks victims with enhanced second chance: a clock over the frames that takes the
+ * first page that is neither referenced nor dirty, then the first unreferenced dirty page
+ * (clearing referenced bits on the way), repeating until one is found. With --asid the frames are
+ * shared by every process, so each frame also remembers the asid of its page.
+ */
+class FrameTable
+{
+public:
+    FrameTable(unsigned int numFrames, unsigned int pageSizeBytes);
+
+    unsigned int numFrames;
+    unsigned int pageSizeBytes;
+
+    bool full(unsigned int framesHandedOut);            // true once every frame holds a page
+    void assign(unsigned int frameNum, unsigned int vpn, unsigned int asid);
+    unsigned int vpnIn(unsigned int frameNum);
+    unsigned int asidIn(unsigned int frameNum);     // NO_ASID without --asid
+
+    // picks the frame to reuse and counts its eviction. The caller unmaps its page
+    unsigned int victim(PageTable* pTable);
+
+    // counts for the summary
+    unsigned long long cleanEvictions;
+    unsigned long long dirtyEvictions;
+    unsigned long long writebackBytes;      // dirty evictions * page size
+
+    // --zswap / --swap tiers evicted pages go to, NULL when only evictions are counted
+    MemoryTiers* tiers;
+
+    unsigned int dirtyResident(PageTable* pTable);      // dirty pages still in memory
+    void report(PageTable* pTable);
+
+private:
+    std::vector<unsigned int> frameVpn;     // vpn held by each frame
+    std::vector<unsigned int> frameAsid;    // and the process it belongs to
+    unsigned int hand;                      // clock position
+};
+
+#endif
@@ -0,0 +1,169 @@
+#include <stdio.h>
+#include <string.h>
+#include "geometryTuner.h"
+#include "level.h"
+
+
+/**
+ * @brief - constructor, with a bitmap covering every vpn
+ * @param vpnNumBits - bits in a vpn, split over the levels of every candidate geometry
+ */
+GeometryTuner::GeometryTuner(unsigned int vpnNumBits)
+{
+    this->vpnNumBits = vpnNumBits;
+    this->pages = 0;
+    this->counted = false;
+    this->bitmap.assign(((1ULL << vpnNumBits) + 63) / 64, 0);
+}
+
+
+/**
+ * @brief - marks pages as touched
+ * @param vpns - page numbers, repeats are fine
+ * @param count - number of vpns
+ */
+void GeometryTuner::addPages(const uint32_t* vpns, size_t count)
+{
+    for (size_t i = 0; i < count; i++) {
+        uint64_t bit = 1ULL << (vpns[i] & 63);
+        uint64_t* word = &bitmap[vpns[i] >> 6];
+        pages += (*word & bit) == 0;
+        *word |= bit;
+    }
+    counted = false;
+}
+
+
+/**
+ * @brief - counts the distinct prefixes of every length in one pass over the touched vpns in order.
+ * Two neighbouring vpns whose highest differing bit is h have the same prefixes up to length
+ * vpnNumBits - h - 1 and different ones from length vpnNumBits - h on
+ */
+void GeometryTuner::countPrefixes()
+{
+    std::vector<unsigned long long> firstDifference(vpnNumBits + 1, 0);
+    bool first = true;
+    uint32_t previous = 0;
+    for (size_t w = 0; w < bitmap.size(); w++) {
+        uint64_t word = bitmap[w];
+        while (word != 0) {
+            uint32_t vpn = (uint32_t)(w * 64 + __builtin_ctzll(word));
+            word &= word - 1;
+            if (!first) {
+                unsigned int highest = 31 - __builtin_clz(vpn ^ previous);
+                firstDifference[vpnNumBits - highest]++;
+            }
+            first = false;
+            previous = vpn;
+        }
+    }
+
+    prefixes.assign(vpnNumBits + 1, 0);
+    prefixes[0] = pages > 0 ? 1 : 0;
+    for (unsigned int b = 1; b <= vpnNumBits; b++) {
+        prefixes[b] = prefixes[b - 1] + firstDifference[b];
+    }
+    counted = true;
+}
+
+
+/**
+ * @brief - nodes and bytes of the radix tree for a split of the vpn bits. A node exists below the
+ * root for every distinct prefix ending at its level, and bytes are counted the way
+ * PageTable::pageInsert counts numBytesSize
+ * @param bitsInLevel - bits of each level, summing to vpnNumBits
+ */
+GeometryTuner::Geometry GeometryTuner::evaluate(const std::vector<unsigned int>& bitsInLevel)
+{
+    if (!counted) {
+        countPrefixes();
+    }
+    Geometry geometry;
+    geometry.bitsInLevel = bitsInLevel;
+    geometry.interiorNodes = 0;
+    geometry.bytes = sizeof(Level);     // root
+
+    unsigned int levels = bitsInLevel.size();
+    unsigned int prefixBits = 0;
+    for (unsigned int d = 1; d < levels; d++) {
+        prefixBits += bitsInLevel[d - 1];
+        geometry.bytes += prefixes[prefixBits] * sizeof(Level) * (1ULL << bitsInLevel[d - 1]);
+        if (d < levels - 1) {
+            geometry.interiorNodes += prefixes[prefixBits];
+        }
+    }
+    if (levels > 1) {
+        geometry.interiorNodes++;       // root
+    }
+    geometry.leafNodes = levels > 1 ? prefixes[prefixBits] : 1;
+    geometry.bytes += prefixes[prefixBits] * sizeof(Map) * (1ULL << bitsInLevel[levels - 1]);
+    return geometry;
+}
+
+
+/**
+ * @brief - tries every split of bitsLeft over at most levelsLeft more levels, keeping the smallest
+ * tree of each depth
+ * @param bits - levels chosen so far
+ * @param best - best[levels - 1] is the smallest tree found with that many levels
+ */
+void GeometryTuner::search(std::vector<unsigned int>* bits, unsigned int bitsLeft, unsigned int levelsLeft,
+    std::vector<Geometry>* best)
+{
+    if (bitsLeft == 0) {
+        Geometry geometry = evaluate(*bits);
+        Geometry* slot = &(*best)[bits->size() - 1];
+        if (slot->bitsInLevel.empty() || geometry.bytes < slot->bytes) {
+            *slot = geometry;
+        }
+        return;
+    }
+    if (levelsLeft == 0) {
+        return;
+    }
+    for (unsigned int levelBits = 1; levelBits <= bitsLeft; levelBits++) {
+        bits->push_back(levelBits);
+        search(bits, bitsLeft - levelBits, levelsLeft - 1, best);
+        bits->pop_back();
+    }
+}
+
+
+/**
+ * @brief - prints one row per page table depth with the split that needs the least memory. A row is
+ * on the Pareto frontier if it needs less memory than every shallower tree, each level costing one
+ * memory reference per walk
+ * @param maxLevels - deepest tree to consider
+ * @param current - split given on the command line, reported for comparison
+ */
+void GeometryTuner::report(unsigned int maxLevels, const std::vector<unsigned int>& current)
+{
+    std::vector<Geometry> best(maxLevels);
+    std::vector<unsigned int> bits;
+    search(&bits, vpnNumBits, maxLevels, &best);
+
+    printf("Page table geometry search: %u vpn bits, %llu distinct pages\n", vpnNumBits, pages);
+    printf("%-8s%-18s%16s%16s%16s  %s\n", "Levels", "Bits per level", "Interior nodes", "Leaf nodes", "Bytes", "Pareto");
+    unsigned long long frontier = 0;
+    for (unsigned int levels = 1; levels <= maxLevels && levels <= vpnNumBits; levels++) {
+        Geometry* geometry = &best[levels - 1];
+        char split[64] = "";
+        for (unsigned int d = 0; d < levels; d++) {
+            snprintf(split + strlen(split), sizeof(split) - strlen(split), d ? "/%u" : "%u", geometry->bitsInLevel[d]);
+        }
+        bool pareto = levels == 1 || geometry->bytes < frontier;
+        if (pareto) {
+            frontier = geometry->bytes;
+        }
+        printf("%-8u%-18s%16llu%16llu%16llu  %s\n", levels, split, geometry->interiorNodes,
+            geometry->leafNodes, geometry->bytes, pareto ? "yes" : "");
+    }
+
+    Geometry given = evaluate(current);
+    printf("Given split ");
+    for (unsigned int d = 0; d < current.size(); d++) {
+        printf(d ? "/%u" : "%u", current[d]);
+    }
+    printf(": %llu interior nodes, %llu leaf nodes, %llu bytes\n", given.interiorNodes, given.leafNodes, given.bytes);
+    fflush(stdout);
+}
@@ -0,0 +1,50 @@
+#ifndef GEOMETRYTUNER
+#define GEOMETRYTUNER
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+
+#define DEFAULT_TUNE_LEVELS 4       // deepest page table --tune considers
+
+
+/**
+ * @brief - --tune page table geometry search. The distinct vpns of a trace are collected once in a
+ * bitmap, and from them the number of distinct prefixes of every length. The radix tree for a split
+ * of the vpn bits has one node per distinct prefix ending at a level boundary, so its node counts
+ * and numBytesSize follow for every split without replaying the trace.
+ */
+class GeometryTuner
+{
+public:
+    GeometryTuner(unsigned int vpnNumBits);
+
+    void addPages(const uint32_t* vpns, size_t count);
+
+    // bytes and nodes of the tree for bitsInLevel, as PageTable would count them
+    struct Geometry
+    {
+        std::vector<unsigned int> bitsInLevel;
+        unsigned long long interiorNodes;
+        unsigned long long leafNodes;
+        unsigned long long bytes;
+    };
+    Geometry evaluate(const std::vector<unsigned int>& bitsInLevel);
+
+    // the smallest split for every depth up to maxLevels and its place on the memory / walk length frontier
+    void report(unsigned int maxLevels, const std::vector<unsigned int>& current);
+
+    unsigned int vpnNumBits;
+    unsigned long long pages;       // distinct vpns
+
+private:
+    std::vector<uint64_t> bitmap;               // bit vpn set once vpn is touched
+    std::vector<unsigned long long> prefixes;   // prefixes[b] = distinct b bit vpn prefixes
+    bool counted;
+
+    void countPrefixes();
+    void search(std::vector<unsigned int>* bits, unsigned int bitsLeft, unsigned int levelsLeft,
+        std::vector<Geometry>* best);
+};
+
+#endif
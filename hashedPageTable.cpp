@@ -0,0 +1,171 @@
+#include "hashedPageTable.h"
+
+
+/**
+ * @brief - constructor allocates HASHED_INITIAL_CAPACITY empty slots
+ */
+HashedPageTable::HashedPageTable()
+{
+    this->usedCount = 0;
+    this->tombstoneCount = 0;
+    rehash(HASHED_INITIAL_CAPACITY);
+}
+
+
+/**
+ * @brief - fibonacci hash of the vpn. The multiply spreads neighbouring vpns across the table
+ * @param vpn - key to hash
+ */
+unsigned int HashedPageTable::hash(unsigned int vpn)
+{
+    return (vpn * 2654435769u) & capacityMask;
+}
+
+
+/**
+ * @brief - walks the probe sequence for vpn. Returns the slot holding vpn if found, otherwise the
+ * first reusable slot (tombstone or empty) on the sequence.
+ * @param vpn - key to search for
+ * @param found - set to true if vpn is in the table
+ */
+unsigned int HashedPageTable::findSlot(unsigned int vpn, bool* found)
+{
+    unsigned int idx = hash(vpn);
+    unsigned int firstFree = HASHED_EMPTY_KEY;
+
+    while (true) {
+        unsigned int key = slots[idx].vpn;
+        if (key == vpn) {
+            *found = true;
+            return idx;
+        }
+        if (key == HASHED_EMPTY_KEY) {
+            *found = false;
+            return (firstFree != HASHED_EMPTY_KEY) ? firstFree : idx;
+        }
+        if (key == HASHED_TOMBSTONE_KEY && firstFree == HASHED_EMPTY_KEY) {
+            firstFree = idx;
+        }
+        idx = (idx + 1) & capacityMask;
+    }
+}
+
+
+/**
+ * @brief - reallocates the table with newCapacity slots and reinserts every valid mapping.
+ * Tombstones are dropped in the process.
+ * @param newCapacity - new number of slots. Must be a power of 2
+ */
+void HashedPageTable::rehash(unsigned int newCapacity)
+{
+    std::vector<Slot> old;
+    old.swap(slots);
+
+    Slot empty;
+    empty.vpn = HASHED_EMPTY_KEY;
+    slots.assign(newCapacity, empty);
+    capacityMask = newCapacity - 1;
+    tombstoneCount = 0;
+
+    for (unsigned int i = 0; i < old.size(); i++) {
+        if (old[i].vpn == HASHED_EMPTY_KEY || old[i].vpn == HASHED_TOMBSTONE_KEY) continue;
+        bool found;
+        slots[findSlot(old[i].vpn, &found)] = old[i];
+    }
+}
+
+
+/**
+ * @brief - returns the Map for vpn or nullptr if not mapped
+ * @param vpn - page number to look up
+ */
+Map* HashedPageTable::lookup(unsigned int vpn)
+{
+    bool found;
+    unsigned int idx = findSlot(vpn, &found);
+    return found ? &slots[idx].entry : nullptr;
+}
+
+
+/**
+ * @brief - maps vpn to frameNum, overwriting any existing mapping
+ * @param vpn - page number to map
+ * @param frameNum - frame to map it to
+ */
+Map* HashedPageTable::insert(unsigned int vpn, unsigned int frameNum)
+{
+    bool hit;
+    Map* frame = lookupOrInsert(vpn, frameNum, &hit);
+    frame->setFrameNum(frameNum);
+    return frame;
+}
+
+
+/**
+ * @brief - single probe lookup that claims the free slot it lands on when vpn is missing
+ * @param vpn - page number to translate
+ * @param frameNum - frame to map vpn to on a miss
+ * @param hit - set to true if vpn was already mapped
+ */
+Map* HashedPageTable::lookupOrInsert(unsigned int vpn, unsigned int frameNum, bool* hit)
+{
+    // keep the load factor under 3/4 so probe sequences stay short
+    if ((usedCount + tombstoneCount + 1) * 4 > slots.size() * 3) {
+        // grow if mostly live entries, otherwise just sweep the tombstones out
+        rehash(usedCount * 2 >= slots.size() ? slots.size() * 2 : slots.size());
+    }
+
+    unsigned int idx = findSlot(vpn, hit);
+    if (!*hit) {
+        if (slots[idx].vpn == HASHED_TOMBSTONE_KEY) {
+            tombstoneCount--;
+        }
+        slots[idx].vpn = vpn;
+        slots[idx].entry = Map();
+        slots[idx].entry.setFrameNum(frameNum);
+        slots[idx].entry.setValid();
+        usedCount++;
+    }
+    return &slots[idx].entry;
+}
+
+
+/**
+ * @brief - removes vpn from the table leaving a tombstone so later probe sequences stay intact
+ * @param vpn - page number to unmap
+ */
+bool HashedPageTable::invalidate(unsigned int vpn)
+{
+    bool found;
+    unsigned int idx = findSlot(vpn, &found);
+    if (!found) {
+        return false;
+    }
+    slots[idx].vpn = HASHED_TOMBSTONE_KEY;
+    slots[idx].entry.setInvalid();
+    usedCount--;
+    tombstoneCount++;
+    return true;
+}
+
+
+/**
+ * @brief - bytes used by the slot array
+ */
+unsigned int HashedPageTable::bytesUsed()
+{
+    return slots.size() * sizeof(Slot);
+}
+
+
+/**
+ * @brief - visits every valid mapping in slot order
+ * @param visit - called with (vpn, map) for each mapping
+ */
+void HashedPageTable::forEach(const std::function<void(unsigned int, Map*)>& visit)
+{
+    for (unsigned int i = 0; i < slots.size(); i++) {
+        if (slots[i].vpn == HASHED_EMPTY_KEY || slots[i].vpn == HASHED_TOMBSTONE_KEY) continue;
+        visit(slots[i].vpn, &slots[i].entry);
+    }
+}
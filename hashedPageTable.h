@@ -0,0 +1,50 @@
+#ifndef HASHEDPAGETABLE
+#define HASHEDPAGETABLE
+
+#include <vector>
+#include "translationBackend.h"
+
+#define HASHED_INITIAL_CAPACITY 1024    // must be a power of 2
+#define HASHED_EMPTY_KEY 0xFFFFFFFF     // vpns are at most 28 bits so these can never be real keys
+#define HASHED_TOMBSTONE_KEY 0xFFFFFFFE
+
+
+/**
+ * @brief - open addressing hashed page table. Keys and mappings live side by side in one
+ * flat array so a probe sequence stays within a few cache lines. Uses linear probing and
+ * doubles the table once it is 3/4 full (tombstones included).
+ */
+class HashedPageTable : public TranslationBackend
+{
+public:
+    // constructor
+    HashedPageTable();
+
+    // TranslationBackend methods
+    Map* lookup(unsigned int vpn);
+    Map* insert(unsigned int vpn, unsigned int frameNum);
+    Map* lookupOrInsert(unsigned int vpn, unsigned int frameNum, bool* hit);
+    bool invalidate(unsigned int vpn);
+    unsigned int bytesUsed();
+    void forEach(const std::function<void(unsigned int, Map*)>& visit);
+
+private:
+    // one slot of the table. vpn is HASHED_EMPTY_KEY or HASHED_TOMBSTONE_KEY when unused
+    struct Slot
+    {
+        unsigned int vpn;
+        Map entry;
+    };
+
+    std::vector<Slot> slots;
+    unsigned int capacityMask;      // slots.size() - 1
+    unsigned int usedCount;         // valid mappings
+    unsigned int tombstoneCount;    // erased slots still on probe sequences
+
+    // helper methods
+    unsigned int hash(unsigned int vpn);
+    unsigned int findSlot(unsigned int vpn, bool* found);
+    void rehash(unsigned int newCapacity);
+};
+
+#endif
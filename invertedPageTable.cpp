@@ -0,0 +1,142 @@
+#include "invertedPageTable.h"
+
+
+/**
+ * @brief - constructor creates an empty anchor table of INVERTED_INITIAL_ANCHORS buckets
+ */
+InvertedPageTable::InvertedPageTable()
+{
+    this->usedCount = 0;
+    this->anchors.assign(INVERTED_INITIAL_ANCHORS, INVERTED_NO_ENTRY);
+    this->anchorMask = INVERTED_INITIAL_ANCHORS - 1;
+}
+
+
+/**
+ * @brief - fibonacci hash of the vpn into the anchor table
+ * @param vpn - key to hash
+ */
+unsigned int InvertedPageTable::hash(unsigned int vpn)
+{
+    return (vpn * 2654435769u) & anchorMask;
+}
+
+
+/**
+ * @brief - pushes frameNum onto the front of the chain for its vpn
+ * @param frameNum - frame whose entry should be linked in
+ */
+void InvertedPageTable::link(unsigned int frameNum)
+{
+    unsigned int bucket = hash(frames[frameNum].vpn);
+    frames[frameNum].next = anchors[bucket];
+    anchors[bucket] = frameNum;
+}
+
+
+/**
+ * @brief - doubles the anchor table and relinks every valid frame
+ */
+void InvertedPageTable::growAnchors()
+{
+    anchors.assign(anchors.size() * 2, INVERTED_NO_ENTRY);
+    anchorMask = anchors.size() - 1;
+    for (unsigned int i = 0; i < frames.size(); i++) {
+        if (frames[i].entry.isValid()) {
+            link(i);
+        }
+    }
+}
+
+
+/**
+ * @brief - walks the chain for vpn. Returns the Map of the frame holding vpn or nullptr
+ * @param vpn - page number to look up
+ */
+Map* InvertedPageTable::lookup(unsigned int vpn)
+{
+    for (int i = anchors[hash(vpn)]; i != INVERTED_NO_ENTRY; i = frames[i].next) {
+        if (frames[i].vpn == vpn) {
+            return &frames[i].entry;
+        }
+    }
+    return nullptr;
+}
+
+
+/**
+ * @brief - records that frameNum now holds vpn. If the frame was holding another page that
+ * mapping is dropped first, just like a real inverted table can only hold one page per frame.
+ * @param vpn - page number to map
+ * @param frameNum - frame to map it to
+ */
+Map* InvertedPageTable::insert(unsigned int vpn, unsigned int frameNum)
+{
+    invalidate(vpn);
+    if (frameNum >= frames.size()) {
+        FrameEntry empty;
+        empty.vpn = 0;
+        empty.next = INVERTED_NO_ENTRY;
+        frames.resize(frameNum + 1, empty);
+    }
+    if (frames[frameNum].entry.isValid()) {
+        invalidate(frames[frameNum].vpn);
+    }
+
+    frames[frameNum].vpn = vpn;
+    frames[frameNum].entry.setFrameNum(frameNum);
+    frames[frameNum].entry.setValid();
+    usedCount++;
+
+    if (usedCount > anchors.size()) {
+        growAnchors();      // relinks this frame too
+    }
+    else {
+        link(frameNum);
+    }
+    return &frames[frameNum].entry;
+}
+
+
+/**
+ * @brief - unlinks the frame holding vpn from its chain and marks it free
+ * @param vpn - page number to unmap
+ */
+bool InvertedPageTable::invalidate(unsigned int vpn)
+{
+    int* prev = &anchors[hash(vpn)];
+    for (int i = *prev; i != INVERTED_NO_ENTRY; i = frames[i].next) {
+        if (frames[i].vpn == vpn) {
+            *prev = frames[i].next;
+            frames[i].next = INVERTED_NO_ENTRY;
+            frames[i].entry.setInvalid();
+            usedCount--;
+            return true;
+        }
+        prev = &frames[i].next;
+    }
+    return false;
+}
+
+
+/**
+ * @brief - bytes used by the frame array and the hash anchor table
+ */
+unsigned int InvertedPageTable::bytesUsed()
+{
+    return frames.size() * sizeof(FrameEntry) + anchors.size() * sizeof(int);
+}
+
+
+/**
+ * @brief - visits every valid mapping in frame order
+ * @param visit - called with (vpn, map) for each mapping
+ */
+void InvertedPageTable::forEach(const std::function<void(unsigned int, Map*)>& visit)
+{
+    for (unsigned int i = 0; i < frames.size(); i++) {
+        if (frames[i].entry.isValid()) {
+            visit(frames[i].vpn, &frames[i].entry);
+        }
+    }
+}
@@ -0,0 +1,50 @@
+#ifndef INVERTEDPAGETABLE
+#define INVERTEDPAGETABLE
+
+#include <vector>
+#include "translationBackend.h"
+
+#define INVERTED_INITIAL_ANCHORS 1024   // must be a power of 2
+#define INVERTED_NO_ENTRY -1
+
+
+/**
+ * @brief - inverted page table. Holds one entry per physical frame, indexed by frame number,
+ * plus a hash anchor table whose buckets point at the first frame in a chain of frames that
+ * hash to the same bucket. Since physical memory is not bounded in this simulator the frame
+ * array grows as frames are handed out and the anchor table doubles to stay at most 1 entry/bucket.
+ */
+class InvertedPageTable : public TranslationBackend
+{
+public:
+    // constructor
+    InvertedPageTable();
+
+    // TranslationBackend methods
+    Map* lookup(unsigned int vpn);
+    Map* insert(unsigned int vpn, unsigned int frameNum);
+    bool invalidate(unsigned int vpn);
+    unsigned int bytesUsed();
+    void forEach(const std::function<void(unsigned int, Map*)>& visit);
+
+private:
+    // one entry per physical frame
+    struct FrameEntry
+    {
+        unsigned int vpn;   // page currently held by this frame
+        int next;           // next frame in the same hash chain, or INVERTED_NO_ENTRY
+        Map entry;
+    };
+
+    std::vector<FrameEntry> frames;     // indexed by frame number
+    std::vector<int> anchors;           // hash anchor table, first frame of each chain
+    unsigned int anchorMask;            // anchors.size() - 1
+    unsigned int usedCount;             // valid mappings
+
+    // helper methods
+    unsigned int hash(unsigned int vpn);
+    void link(unsigned int frameNum);
+    void growAnchors();
+};
+
+#endif
@@ -1,9 +1,11 @@
+#include <new>
 #include "pageTable.h"
 
 // default constructor needed for nextLevel[]
 Level::Level()
 {
     currDepth = 0;
+    validCount = 0;
     pTable = NULL;
 }
 
@@ -11,30 +13,38 @@ Level::Level()
 Level::Level(int depth, PageTable* tablePtr)
 {
     currDepth = depth;
+    validCount = 0;
     pTable = tablePtr;
     setNextLevel();
     setNextLevelNull();     // set zeroeth levels netLevel[] to all nulls
     mapPtr = nullptr;       // initialize to nullptr to avoid segFault.
 }
 
-// assigns nextLevel to an array of Level*
+// assigns nextLevel to an array of Level* from the pageTable's arena. Leaves have no next level
 void Level::setNextLevel()
 {
+    if (currDepth == pTable->levelCount - 1) {
+        nextLevel = nullptr;
+        return;
+    }
     // size of nextLevel = num possible levels at the currDepth
-    nextLevel = new Level * [pTable->entryCountArr[currDepth]];
+    nextLevel = (Level**)pTable->arena->allocate(sizeof(Level*) * pTable->entryCountArr[currDepth]);
 }
 
 // ensures that all elements of nextLevel are set to Null
 void Level::setNextLevelNull()
 {
-    for (int i = 0; i < pTable->entryCountArr[currDepth]; i++) {
+    for (int i = 0; nextLevel != nullptr && i < pTable->entryCountArr[currDepth]; i++) {
         nextLevel[i] = nullptr;
     }
 }
 
-// use new operator to assign mapPtr a Map arr
+// assigns mapPtr a Map arr from the pageTable's arena
 void Level::setMapPtr()
 {
     // size of mapPtr = num possible levels based on numBits in level
-    this->mapPtr = new Map[pTable->entryCountArr[currDepth]];
+    this->mapPtr = (Map*)pTable->arena->allocate(sizeof(Map) * pTable->entryCountArr[currDepth]);
+    for (unsigned int i = 0; i < pTable->entryCountArr[currDepth]; i++) {
+        new (&mapPtr[i]) Map();
+    }
 }
\ No newline at end of file
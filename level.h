@@ -15,8 +15,9 @@ public:
     Level** nextLevel;          // double pointer enables arr of Level* ptrs
     Map* mapPtr;                // single pointer so arr of Map objects
     unsigned int currDepth;     // depth of this Level. Referenced in main
+    unsigned int validCount;    // valid Map entries in a leaf, non null nextLevel entries above it
     PageTable* pTable;          // pointer to PageTable object that contains the levels and info about masks and levels
-    void setNextLevel();        // assigns nextLevel to arr of Level* ptrs
+    void setNextLevel();        // assigns nextLevel to arr of Level* ptrs, nullptr for a leaf
     void setNextLevelNull();    // instantiates each element of nextLevel to NULL
     void setMapPtr();           // assigns mapPtr to arr of Map objects
 };
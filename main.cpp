@@ -1,65 +1,829 @@
 #include <iostream>
 #include <fstream>
 #include "unistd.h"
+#include <getopt.h>
 #include <stdlib.h>
 #include <string.h>
+#include <limits.h>
 #include "pageTable.h"
+#include "hashedPageTable.h"
+#include "invertedPageTable.h"
 #include "output_mode_helpers.h"
 #include "Map.h"
 #include "tlb.h"
+#include "traceCompactor.h"
+#include "traceSource.h"
+#include "checkpoint.h"
+#include "tlbHierarchy.h"
+#include "workingSet.h"
+#include "geometryTuner.h"
+#include "tenantScheduler.h"
+#include "simulator.h"
+#include "daemon.h"
+#include "resultCache.h"
+#include "reclaim.h"
+#include "forkModel.h"
+#include "simPoint.h"
+#include <algorithm>
 #include "main.h"
 #define MEMORY_SPACE_SIZE 32
 #define DEFAULT_NUM_ADDRESSES -1
 #define DEFAULT_CACHE_SIZE 0
 #define DEFAULT_OUTPUT_MODE (char*)"summary"
+#define DEFAULT_PAGE_TABLE_TYPE (char*)"radix"
+#define DEFAULT_PREFETCH_BUFFER 16
+#define DEFAULT_INTERVAL_LENGTH 100000
+#define DEFAULT_STATS_EVERY 1000000
+
+// values for long-only options, kept out of the char range used by the short flags
+#define OPT_COMPACT 256
+#define OPT_SKIP 257
+#define OPT_RANGE 258
+#define OPT_SAMPLE 259
+#define OPT_CHECKPOINT 260
+#define OPT_RESUME 261
+#define OPT_ITLB 262
+#define OPT_DTLB 263
+#define OPT_STLB 264
+#define OPT_TLB_EXCLUSIVE 265
+#define OPT_TLB_POLICY 266
+#define OPT_TLB_SEED 267
+#define OPT_ASID 268
+#define OPT_PREFETCH 269
+#define OPT_PREFETCH_DEGREE 270
+#define OPT_PREFETCH_BUFFER 271
+#define OPT_FRAMES 272
+#define OPT_INTERVAL 273
+#define OPT_TAU 274
+#define OPT_DAEMON 275
+#define OPT_STREAM_FORMAT 276
+#define OPT_STATS_EVERY 277
+#define OPT_CONTROL 278
+#define OPT_L1 279
+#define OPT_L2 280
+#define OPT_LLC 281
+#define OPT_LINE_SIZE 282
+#define OPT_FRAME_ALLOC 283
+#define OPT_NUMA_LATENCY 284
+#define OPT_TUNE 285
+#define OPT_TUNE_LEVELS 286
+#define OPT_CORES 287
+#define OPT_CORE_MAP 288
+#define OPT_CORE_EVENTS 289
+#define OPT_SHOOTDOWN_LATENCY 290
+#define OPT_ZSWAP 291
+#define OPT_SWAP 292
+#define OPT_TIER_LATENCY 293
+#define OPT_TENANT 294
+#define OPT_QUANTUM 295
+#define OPT_WEIGHTS 296
+#define OPT_FAULT_AROUND 297
+#define OPT_READAHEAD 298
+#define OPT_NO_CACHE 299
+#define OPT_CACHE_DIR 300
+#define OPT_CACHE_MAX 301
+#define OPT_CACHE_CLEAR 302
+#define OPT_RECLAIM 303
+#define OPT_UNMAP 304
+#define OPT_RENUMBER_EVERY 305
+#define OPT_FOOTPRINT_EVERY 306
+#define OPT_FORK 307
+#define OPT_SIMPOINT 308
+#define OPT_SIMPOINT_WARMUP 309
+#define OPT_SIMPOINT_SAMPLES 310
 
 /**
  * @brief - Processes command line args. Checks that appropiate num of cmd ln args.
  * Checks if number of bits specified for levels are viable.
  * @param argc - count of cmd ln args
  * @param argv - arr of cmd ln args as char*
- * @param nFlag - int* for nFlag. Indicates number of addresses to process
- * @param cFlag - int* for cFlag. Indicates capacity for TLB
- * @param oFlag - char** for oFlag. Indicates output mode
+ * @param opts - CmdLnOptionsType* filled in from the optional flags. Fields not given keep their defaults
+ *      nFlag - number of addresses to process
+ *      cFlag - capacity for TLB
+ *      oFlag - output mode
+ *      pFlag - page table backend (radix, hashed or inverted)
+ *      compact - --compact, run-length compact the trace (summary mode only)
+ *      startRecord, endRecord - --skip=N and --range=A:B, records of the trace to simulate
+ *      sampleWindow, samplePeriod - --sample=W:P, only simulate the first W records of every P
+ *      checkpoints - --checkpoint=N:file, may be given more than once
+ *      resumeFile - --resume=file, checkpoint to continue from
+ *      itlb, dtlb, stlb - --itlb/--dtlb/--stlb=entries:ways[:policy], TLB hierarchy levels
+ *      tlbExclusive - --tlb-exclusive, STLB holds only L1 victims instead of a superset of L1
+ *      tlbPolicy - --tlb-policy=lru|fifo|random|clock|srrip|brrip|lfu, replacement for -c and hierarchy levels
+ *      tlbSeed - --tlb-seed=N, seed for the random and brrip policies
+ *      asidMode - --asid=flush|tagged, give every trace proc its own page table and model context switches
+ *      prefetch - --prefetch=next|stride|distance, TLB prefetcher trained on -c TLB misses
+ *      prefetchDegree - --prefetch-degree=N, most pages prefetched per miss
+ *      prefetchBuffer - --prefetch-buffer=N, prefetch buffer entries. 0 prefetches into the TLB
+ *      frames - --frames=N, physical frames available. 0 for unlimited
+ *      tiers, zswapBytes, zswapRatio - --zswap=size[:ratio], compressed pool evicted pages go to
+ *      swapLatency, swapDepth - --swap=us[:depth], swap device behind the pool
+ *      tierLatencies - --tier-latency=memory,minor,compress,decompress, ns charged for AMAT
+ *      faultAround - --fault-around=K, map the aligned block of K pages around every page fault
+ *      readahead - --readahead=MAX, map up to MAX pages after sequential page faults
+ *      reclaim - --reclaim, free page table levels and leaf arrays left empty by an unmap
+ *      unmapFile - --unmap=FILE, "record vpn [pages]" lines unmapping pages of the current process
+ *      renumberEvery - --renumber-every=N, copy the page table into a fresh arena every N records
+ *      footprintEvery - --footprint-every=N, sample the page table bytes every N records
+ *      forkFile - --fork=FILE, "record parent child" lines making procs copy-on-write copies of others
+ *      simpointInterval, simpointClusters - --simpoint=N[:K], only simulate representative intervals of N records
+ *      simpointWarmup - --simpoint-warmup=N, records simulated before every representative interval
+ *      simpointSamples - --simpoint-samples=N, intervals simulated per cluster
+ *      intervalByTime, intervalLength - --interval=records:N|time:T, -o workingset interval boundaries
+ *      taus - --tau=A,B,..., -o workingset window sizes, in the unit of --interval
+ *      l1, l2, llc - --l1/--l2/--llc=size:ways[:policy], physically addressed data cache levels
+ *      lineSize - --line-size=N, cache line bytes
+ *      frameAlloc - --frame-alloc=sequential|random|color[:N]|numa:N[:first-touch|interleave], how page faults pick frames
+ *      numaLatencies - --numa-latency=A,B,..., node to node latencies in ns for numa:N, N * N of them
+ *      cores - --cores=N, simulated cores with a -c TLB each, trace procs run on proc % N
+ *      coreMap - --core-map=FILE, "proc core" lines overriding proc % N
+ *      coreEvents - --core-events=FILE, "record unmap|remap vpn [core]" lines causing shootdowns
+ *      shootdownLocal, shootdownIpi - --shootdown-latency=LOCAL,IPI, ns per shootdown and per IPI
+ *      tune - --tune, search page table geometries for the trace's pages instead of simulating
+ *      tuneLevels - --tune-levels=N, deepest geometry --tune considers
+ *      tenants - --tenant=FILE, may be given more than once. More traces run next to the trace argument
+ *      quantum - --quantum=N, records a tenant runs before the next one is scheduled
+ *      weights - --weights=A,B,..., slice length multipliers, one per trace starting with the trace argument
+ *      daemon - --daemon, read the trace as a live stream from stdin (-) or a UNIX socket (unix:PATH)
+ *      streamFormat - --stream-format=byu|addr32, p2AddrTr records or bare 32 bit addresses
+ *      statsEvery - --stats-every=N, daemon stats snapshot every N records
+ *      controlPath - --control=PATH, daemon control socket
  *
  */
-void processCmdLnArgs(int argc, char* argv[], int* nFlag, int* cFlag, char** oFlag)
+void processCmdLnArgs(int argc, char* argv[], CmdLnOptionsType* opts)
 {
-    // check that the minimum # of cmd-line args are given
-    if (argc < 3)
+    // check that the minimum # of cmd-line args are given. --cache-clear alone needs none
+    if (argc < 3 && !(argc == 2 && strcmp(argv[1], "--cache-clear") == 0))
     {
         std::cerr << "Error: Not enough command-line args given" << std::endl;
         std::cerr << "  \nExiting..." << std::endl;
         exit(EXIT_FAILURE);
     }
 
+    static struct option longOptions[] = {
+        {"compact", no_argument, NULL, OPT_COMPACT},
+        {"skip", required_argument, NULL, OPT_SKIP},
+        {"range", required_argument, NULL, OPT_RANGE},
+        {"sample", required_argument, NULL, OPT_SAMPLE},
+        {"checkpoint", required_argument, NULL, OPT_CHECKPOINT},
+        {"resume", required_argument, NULL, OPT_RESUME},
+        {"itlb", required_argument, NULL, OPT_ITLB},
+        {"dtlb", required_argument, NULL, OPT_DTLB},
+        {"stlb", required_argument, NULL, OPT_STLB},
+        {"tlb-exclusive", no_argument, NULL, OPT_TLB_EXCLUSIVE},
+        {"tlb-policy", required_argument, NULL, OPT_TLB_POLICY},
+        {"tlb-seed", required_argument, NULL, OPT_TLB_SEED},
+        {"asid", required_argument, NULL, OPT_ASID},
+        {"prefetch", required_argument, NULL, OPT_PREFETCH},
+        {"prefetch-degree", required_argument, NULL, OPT_PREFETCH_DEGREE},
+        {"prefetch-buffer", required_argument, NULL, OPT_PREFETCH_BUFFER},
+        {"frames", required_argument, NULL, OPT_FRAMES},
+        {"interval", required_argument, NULL, OPT_INTERVAL},
+        {"tau", required_argument, NULL, OPT_TAU},
+        {"daemon", no_argument, NULL, OPT_DAEMON},
+        {"stream-format", required_argument, NULL, OPT_STREAM_FORMAT},
+        {"stats-every", required_argument, NULL, OPT_STATS_EVERY},
+        {"control", required_argument, NULL, OPT_CONTROL},
+        {"l1", required_argument, NULL, OPT_L1},
+        {"l2", required_argument, NULL, OPT_L2},
+        {"llc", required_argument, NULL, OPT_LLC},
+        {"line-size", required_argument, NULL, OPT_LINE_SIZE},
+        {"frame-alloc", required_argument, NULL, OPT_FRAME_ALLOC},
+        {"numa-latency", required_argument, NULL, OPT_NUMA_LATENCY},
+        {"tune", no_argument, NULL, OPT_TUNE},
+        {"cores", required_argument, NULL, OPT_CORES},
+        {"core-map", required_argument, NULL, OPT_CORE_MAP},
+        {"core-events", required_argument, NULL, OPT_CORE_EVENTS},
+        {"shootdown-latency", required_argument, NULL, OPT_SHOOTDOWN_LATENCY},
+        {"zswap", required_argument, NULL, OPT_ZSWAP},
+        {"swap", required_argument, NULL, OPT_SWAP},
+        {"tier-latency", required_argument, NULL, OPT_TIER_LATENCY},
+        {"tune-levels", required_argument, NULL, OPT_TUNE_LEVELS},
+        {"tenant", required_argument, NULL, OPT_TENANT},
+        {"quantum", required_argument, NULL, OPT_QUANTUM},
+        {"weights", required_argument, NULL, OPT_WEIGHTS},
+        {"fault-around", required_argument, NULL, OPT_FAULT_AROUND},
+        {"readahead", required_argument, NULL, OPT_READAHEAD},
+        {"no-cache", no_argument, NULL, OPT_NO_CACHE},
+        {"cache-dir", required_argument, NULL, OPT_CACHE_DIR},
+        {"cache-max", required_argument, NULL, OPT_CACHE_MAX},
+        {"cache-clear", no_argument, NULL, OPT_CACHE_CLEAR},
+        {"reclaim", no_argument, NULL, OPT_RECLAIM},
+        {"unmap", required_argument, NULL, OPT_UNMAP},
+        {"renumber-every", required_argument, NULL, OPT_RENUMBER_EVERY},
+        {"footprint-every", required_argument, NULL, OPT_FOOTPRINT_EVERY},
+        {"fork", required_argument, NULL, OPT_FORK},
+        {"simpoint", required_argument, NULL, OPT_SIMPOINT},
+        {"simpoint-warmup", required_argument, NULL, OPT_SIMPOINT_WARMUP},
+        {"simpoint-samples", required_argument, NULL, OPT_SIMPOINT_SAMPLES},
+        {NULL, 0, NULL, 0}
+    };
     int opt;
 
     // process optional flags
     // skips over if no optional flags
-    while ((opt = getopt(argc, argv, "n:c:o:")) != -1)
+    while ((opt = getopt_long(argc, argv, "n:c:o:p:", longOptions, NULL)) != -1)
     {
         switch (opt)
         {
         case 'n':
-            *nFlag = atoi(optarg);
+            opts->nFlag = atoi(optarg);
             break;
         case 'c':
-            *cFlag = atoi(optarg);
+            opts->cFlag = atoi(optarg);
             // check if cFlag is valid
-            if (*cFlag < 0) {
+            if (opts->cFlag < 0) {
                 std::cerr << "Cache capacity must be a number, greater than or equal to 0" << std::endl;
                 exit(EXIT_FAILURE);
             }
             break;
         case 'o':
-            *oFlag = optarg;
+            opts->oFlag = optarg;
+            break;
+        case 'p':
+            opts->pFlag = optarg;
+            // check if pFlag is valid
+            if (strcmp(optarg, "radix") != 0 && strcmp(optarg, "hashed") != 0 && strcmp(optarg, "inverted") != 0) {
+                std::cerr << "Page table type must be radix, hashed or inverted" << std::endl;
+                exit(EXIT_FAILURE);
+            }
+            break;
+        case OPT_COMPACT:
+            opts->compact = true;
+            break;
+        case OPT_SKIP:
+            opts->startRecord = strtoull(optarg, NULL, 10);
+            break;
+        case OPT_RANGE:
+            if (sscanf(optarg, "%llu:%llu", &opts->startRecord, &opts->endRecord) != 2
+                || opts->endRecord < opts->startRecord) {
+                std::cerr << "Range must be given as A:B with A <= B" << std::endl;
+                exit(EXIT_FAILURE);
+            }
+            break;
+        case OPT_SAMPLE:
+            if (sscanf(optarg, "%llu:%llu", &opts->sampleWindow, &opts->samplePeriod) != 2
+                || opts->sampleWindow < 1 || opts->samplePeriod < opts->sampleWindow) {
+                std::cerr << "Sample must be given as W:P with 1 <= W <= P" << std::endl;
+                exit(EXIT_FAILURE);
+            }
+            break;
+        case OPT_CHECKPOINT: {
+            CheckpointType checkpoint;
+            char* colon = strchr(optarg, ':');
+            if (colon == NULL || colon[1] == '\0') {
+                std::cerr << "Checkpoint must be given as N:file" << std::endl;
+                exit(EXIT_FAILURE);
+            }
+            checkpoint.record = strtoull(optarg, NULL, 10);
+            checkpoint.fname = colon + 1;
+            opts->checkpoints.push_back(checkpoint);
+            break;
+        }
+        case OPT_RESUME:
+            opts->resumeFile = optarg;
+            break;
+        case OPT_ITLB:
+            opts->itlb = optarg;
+            break;
+        case OPT_DTLB:
+            opts->dtlb = optarg;
+            break;
+        case OPT_STLB:
+            opts->stlb = optarg;
+            break;
+        case OPT_TLB_EXCLUSIVE:
+            opts->tlbExclusive = true;
+            break;
+        case OPT_TLB_POLICY:
+            opts->tlbPolicy = optarg;
+            if (!isReplacementPolicy(optarg)) {
+                std::cerr << "TLB policy must be lru, fifo, random, clock, srrip, brrip or lfu" << std::endl;
+                exit(EXIT_FAILURE);
+            }
+            break;
+        case OPT_TLB_SEED:
+            opts->tlbSeed = strtoul(optarg, NULL, 10);
+            break;
+        case OPT_ASID:
+            if (strcmp(optarg, "flush") == 0) {
+                opts->asidMode = ASID_FLUSH;
+            }
+            else if (strcmp(optarg, "tagged") == 0) {
+                opts->asidMode = ASID_TAGGED;
+            }
+            else {
+                std::cerr << "ASID mode must be flush or tagged" << std::endl;
+                exit(EXIT_FAILURE);
+            }
+            break;
+        case OPT_PREFETCH:
+            opts->prefetch = optarg;
+            if (!isTlbPrefetcher(optarg)) {
+                std::cerr << "Prefetcher must be next, stride or distance" << std::endl;
+                exit(EXIT_FAILURE);
+            }
+            break;
+        case OPT_PREFETCH_DEGREE:
+            if (atoi(optarg) < 1) {
+                std::cerr << "Prefetch degree must be at least 1" << std::endl;
+                exit(EXIT_FAILURE);
+            }
+            opts->prefetchDegree = atoi(optarg);
+            break;
+        case OPT_PREFETCH_BUFFER:
+            if (atoi(optarg) < 0) {
+                std::cerr << "Prefetch buffer entries must be a number, greater than or equal to 0" << std::endl;
+                exit(EXIT_FAILURE);
+            }
+            opts->prefetchBuffer = atoi(optarg);
+            break;
+        case OPT_FRAMES:
+            if (atoi(optarg) < 1) {
+                std::cerr << "Frames must be a number, greater than 0" << std::endl;
+                exit(EXIT_FAILURE);
+            }
+            opts->frames = atoi(optarg);
             break;
+        case OPT_INTERVAL:
+            if (sscanf(optarg, "records:%llu", &opts->intervalLength) == 1) {
+                opts->intervalByTime = false;
+            }
+            else if (sscanf(optarg, "time:%llu", &opts->intervalLength) == 1) {
+                opts->intervalByTime = true;
+            }
+            else {
+                opts->intervalLength = 0;
+            }
+            if (opts->intervalLength == 0) {
+                std::cerr << "Interval must be given as records:N or time:T with N, T > 0" << std::endl;
+                exit(EXIT_FAILURE);
+            }
+            break;
+        case OPT_TAU: {
+            opts->taus.clear();
+            char* next = optarg;
+            do {
+                char* end;
+                unsigned long long tau = strtoull(next, &end, 10);
+                if (end == next || tau == 0 || (*end != ',' && *end != '\0')) {
+                    std::cerr << "Tau must be a comma separated list of numbers greater than 0" << std::endl;
+                    exit(EXIT_FAILURE);
+                }
+                opts->taus.push_back(tau);
+                next = (*end == ',') ? end + 1 : NULL;
+            } while (next != NULL);
+            break;
+        }
+        case OPT_DAEMON:
+            opts->daemon = true;
+            break;
+        case OPT_STREAM_FORMAT:
+            if (strcmp(optarg, "byu") == 0) {
+                opts->streamFormat = STREAM_BYU;
+            }
+            else if (strcmp(optarg, "addr32") == 0) {
+                opts->streamFormat = STREAM_ADDR32;
+            }
+            else {
+                std::cerr << "Stream format must be byu or addr32" << std::endl;
+                exit(EXIT_FAILURE);
+            }
+            break;
+        case OPT_STATS_EVERY:
+            opts->statsEvery = strtoull(optarg, NULL, 10);
+            break;
+        case OPT_CONTROL:
+            opts->controlPath = optarg;
+            break;
+        case OPT_L1:
+            opts->l1 = optarg;
+            break;
+        case OPT_L2:
+            opts->l2 = optarg;
+            break;
+        case OPT_LLC:
+            opts->llc = optarg;
+            break;
+        case OPT_LINE_SIZE:
+            opts->lineSize = atoi(optarg);
+            if (opts->lineSize < 4 || (opts->lineSize & (opts->lineSize - 1)) != 0) {
+                std::cerr << "Line size must be a power of two, at least 4" << std::endl;
+                exit(EXIT_FAILURE);
+            }
+            break;
+        case OPT_FRAME_ALLOC:
+            if (!isFrameAllocator(optarg)) {
+                std::cerr << "Frame allocation must be sequential, random, color, color:N or numa:N[:first-touch|interleave] with N > 0" << std::endl;
+                exit(EXIT_FAILURE);
+            }
+            opts->frameAlloc = optarg;
+            break;
+        case OPT_NUMA_LATENCY: {
+            opts->numaLatencies.clear();
+            char* next = optarg;
+            do {
+                char* end;
+                double latency = strtod(next, &end);
+                if (end == next || latency <= 0 || (*end != ',' && *end != '\0')) {
+                    std::cerr << "NUMA latency must be a comma separated list of numbers greater than 0" << std::endl;
+                    exit(EXIT_FAILURE);
+                }
+                opts->numaLatencies.push_back(latency);
+                next = (*end == ',') ? end + 1 : NULL;
+            } while (next != NULL);
+            break;
+        }
+        case OPT_CORES:
+            opts->cores = atoi(optarg);
+            if (opts->cores < 1 || opts->cores > MAX_CORES) {
+                std::cerr << "Cores must be a number from 1 to " << MAX_CORES << std::endl;
+                exit(EXIT_FAILURE);
+            }
+            break;
+        case OPT_CORE_MAP:
+            opts->coreMap = optarg;
+            break;
+        case OPT_CORE_EVENTS:
+            opts->coreEvents = optarg;
+            break;
+        case OPT_SHOOTDOWN_LATENCY:
+            if (sscanf(optarg, "%lf,%lf", &opts->shootdownLocal, &opts->shootdownIpi) != 2
+                || opts->shootdownLocal < 0 || opts->shootdownIpi < 0) {
+                std::cerr << "Shootdown latency must be given as LOCAL,IPI in ns" << std::endl;
+                exit(EXIT_FAILURE);
+            }
+            break;
+        case OPT_ZSWAP:
+            if (!parseZswap(optarg, &opts->zswapBytes, &opts->zswapRatio)) {
+                std::cerr << "zswap must be given as size[K|M|G][:ratio] with a ratio of at least 1" << std::endl;
+                exit(EXIT_FAILURE);
+            }
+            opts->tiers = true;
+            break;
+        case OPT_SWAP: {
+            char* end;
+            opts->swapLatency = strtod(optarg, &end);
+            if (*end == ':') {
+                opts->swapDepth = strtoul(end + 1, &end, 10);
+            }
+            if (end == optarg || *end != '\0' || opts->swapLatency <= 0 || opts->swapDepth == 0) {
+                std::cerr << "Swap must be given as us[:depth] with a latency and depth greater than 0" << std::endl;
+                exit(EXIT_FAILURE);
+            }
+            opts->tiers = true;
+            break;
+        }
+        case OPT_TIER_LATENCY:
+            if (sscanf(optarg, "%lf,%lf,%lf,%lf", &opts->tierLatencies[0], &opts->tierLatencies[1],
+                &opts->tierLatencies[2], &opts->tierLatencies[3]) != 4) {
+                std::cerr << "Tier latency must be given as memory,minor,compress,decompress in ns" << std::endl;
+                exit(EXIT_FAILURE);
+            }
+            opts->tiers = true;
+            break;
+        case OPT_FAULT_AROUND:
+            opts->faultAround = atoi(optarg);
+            if (opts->faultAround < 2 || (opts->faultAround & (opts->faultAround - 1)) != 0) {
+                std::cerr << "Fault-around must be a power of two, at least 2" << std::endl;
+                exit(EXIT_FAILURE);
+            }
+            break;
+        case OPT_READAHEAD:
+            if (atoi(optarg) < 1) {
+                std::cerr << "Readahead must be a number, greater than 0" << std::endl;
+                exit(EXIT_FAILURE);
+            }
+            opts->readahead = atoi(optarg);
+            break;
+        case OPT_NO_CACHE:
+            opts->noCache = true;
+            break;
+        case OPT_CACHE_DIR:
+            opts->cacheDir = optarg;
+            break;
+        case OPT_CACHE_MAX:
+            if (atoi(optarg) < 1) {
+                std::cerr << "Cache max must be a number, greater than 0" << std::endl;
+                exit(EXIT_FAILURE);
+            }
+            opts->cacheMax = atoi(optarg);
+            break;
+        case OPT_CACHE_CLEAR:
+            opts->cacheClear = true;
+            break;
+        case OPT_RECLAIM:
+            opts->reclaim = true;
+            break;
+        case OPT_UNMAP:
+            opts->unmapFile = optarg;
+            break;
+        case OPT_RENUMBER_EVERY:
+            opts->renumberEvery = strtoull(optarg, NULL, 10);
+            if (opts->renumberEvery == 0) {
+                std::cerr << "Renumber every must be a number greater than 0" << std::endl;
+                exit(EXIT_FAILURE);
+            }
+            break;
+        case OPT_FORK:
+            opts->forkFile = optarg;
+            break;
+        case OPT_SIMPOINT: {
+            char* end;
+            opts->simpointInterval = strtoull(optarg, &end, 10);
+            opts->simpointClusters = DEFAULT_SIMPOINT_CLUSTERS;
+            if (*end == ':') {
+                opts->simpointClusters = strtoul(end + 1, &end, 10);
+            }
+            if (opts->simpointInterval == 0 || opts->simpointClusters == 0 || *end != '\0') {
+                std::cerr << "SimPoint must be given as N[:K] with N, K > 0" << std::endl;
+                exit(EXIT_FAILURE);
+            }
+            break;
+        }
+        case OPT_SIMPOINT_WARMUP: {
+            char* end;
+            opts->simpointWarmup = strtoull(optarg, &end, 10);
+            if (end == optarg || *end != '\0') {
+                std::cerr << "SimPoint warmup must be a number, greater than or equal to 0" << std::endl;
+                exit(EXIT_FAILURE);
+            }
+            break;
+        }
+        case OPT_SIMPOINT_SAMPLES:
+            if (atoi(optarg) < 1) {
+                std::cerr << "SimPoint samples must be a number, greater than 0" << std::endl;
+                exit(EXIT_FAILURE);
+            }
+            opts->simpointSamples = atoi(optarg);
+            break;
+        case OPT_FOOTPRINT_EVERY:
+            opts->footprintEvery = strtoull(optarg, NULL, 10);
+            if (opts->footprintEvery == 0) {
+                std::cerr << "Footprint every must be a number greater than 0" << std::endl;
+                exit(EXIT_FAILURE);
+            }
+            break;
+        case OPT_TUNE:
+            opts->tune = true;
+            break;
+        case OPT_TUNE_LEVELS:
+            opts->tuneLevels = atoi(optarg);
+            if (opts->tuneLevels < 1) {
+                std::cerr << "Tune levels must be a number greater than 0" << std::endl;
+                exit(EXIT_FAILURE);
+            }
+            break;
+        case OPT_TENANT:
+            opts->tenants.push_back(optarg);
+            break;
+        case OPT_QUANTUM:
+            opts->quantum = strtoull(optarg, NULL, 10);
+            if (opts->quantum == 0) {
+                std::cerr << "Quantum must be a number greater than 0" << std::endl;
+                exit(EXIT_FAILURE);
+            }
+            break;
+        case OPT_WEIGHTS: {
+            opts->weights.clear();
+            char* next = optarg;
+            do {
+                char* end;
+                unsigned long weight = strtoul(next, &end, 10);
+                if (end == next || weight == 0 || (*end != ',' && *end != '\0')) {
+                    std::cerr << "Weights must be a comma separated list of numbers greater than 0" << std::endl;
+                    exit(EXIT_FAILURE);
+                }
+                opts->weights.push_back(weight);
+                next = (*end == ',') ? end + 1 : NULL;
+            } while (next != NULL);
+            break;
+        }
         default:
             exit(EXIT_FAILURE);
         }
     }
 
+    // --cache-clear without a trace only empties the cache
+    if (opts->cacheClear && optind == argc) {
+        ResultCache resultCache(opts->cacheDir != NULL ? opts->cacheDir : defaultCacheDir().c_str(), opts->cacheMax);
+        if (!resultCache.usable) {
+            std::cerr << "Unable to use cache directory <<" << resultCache.dir << ">>" << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        printf("Removed %u cached results from %s\n", resultCache.clear(), resultCache.dir.c_str());
+        exit(EXIT_SUCCESS);
+    }
+    if (opts->noCache && (opts->cacheDir != NULL || opts->cacheMax != DEFAULT_CACHE_ENTRIES || opts->cacheClear)) {
+        std::cerr << "--no-cache can't be combined with --cache-dir, --cache-max or --cache-clear" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    // every tenant is a process of its own, interleaved from the first record of every trace to the last
+    if (!opts->tenants.empty()) {
+        if (opts->daemon || opts->compact || opts->startRecord != 0 || opts->endRecord != ULLONG_MAX
+            || opts->samplePeriod > 0 || opts->resumeFile != NULL || !opts->checkpoints.empty() || opts->tune
+            || strcmp(opts->oFlag, "workingset") == 0) {
+            std::cerr << "--tenant can't be combined with --daemon, --compact, --skip, --range, --sample, checkpoints, --tune or -o workingset" << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        if (!opts->weights.empty() && opts->weights.size() != opts->tenants.size() + 1) {
+            std::cerr << "--weights needs " << opts->tenants.size() + 1 << " values, one per trace" << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        if (opts->asidMode == ASID_NONE) {
+            opts->asidMode = ASID_TAGGED;
+        }
+    }
+    else if (opts->quantum != DEFAULT_QUANTUM || !opts->weights.empty()) {
+        std::cerr << "--quantum and --weights need --tenant" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    // compaction skips records in bulk, so it can't stop at sample windows or checkpoints
+    if (opts->compact && (opts->samplePeriod > 0 || !opts->checkpoints.empty())) {
+        std::cerr << "--compact can't be combined with --sample or --checkpoint" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    // the hierarchy replaces the flat -c TLB
+    bool hierarchy = opts->itlb != NULL || opts->dtlb != NULL || opts->stlb != NULL;
+    if (hierarchy && opts->cFlag != DEFAULT_CACHE_SIZE) {
+        std::cerr << "-c can't be combined with --itlb, --dtlb or --stlb" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    // same-page runs can switch between the iTLB and dTLB, so they are not guaranteed hits
+    if (hierarchy && opts->compact) {
+        std::cerr << "--compact can't be combined with --itlb, --dtlb or --stlb" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    if (hierarchy && (opts->resumeFile != NULL || !opts->checkpoints.empty())) {
+        std::cerr << "Checkpoints don't save the TLB hierarchy" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    // LFU counts every repeat access, so same-page runs can't be collapsed
+    if (opts->compact && opts->tlbPolicy != NULL && strcmp(opts->tlbPolicy, "lfu") == 0) {
+        std::cerr << "--compact can't be combined with --tlb-policy=lfu" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    if (opts->tlbPolicy != NULL && (opts->resumeFile != NULL || !opts->checkpoints.empty())) {
+        std::cerr << "Checkpoints don't save --tlb-policy state" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    // runs and checkpoints assume one address space, and the hierarchy levels aren't tagged
+    if (opts->asidMode != ASID_NONE && (opts->compact || hierarchy || opts->resumeFile != NULL || !opts->checkpoints.empty())) {
+        std::cerr << "--asid can't be combined with --compact, the TLB hierarchy or checkpoints" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    // prefetches are made into the flat -c TLB in one address space, and aren't checkpointed
+    if (opts->prefetch != NULL && (opts->cFlag == 0 || opts->asidMode != ASID_NONE
+        || opts->resumeFile != NULL || !opts->checkpoints.empty())) {
+        std::cerr << "--prefetch needs -c and can't be combined with --asid or checkpoints" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    // prefetches into the TLB may evict the page a same-page run is counted as hitting
+    if (opts->prefetch != NULL && opts->prefetchBuffer == 0 && opts->compact) {
+        std::cerr << "--compact needs a prefetch buffer, --prefetch-buffer can't be 0" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    // every core's TLB is a -c TLB in the one shared address space. TLB state isn't checkpointed and
+    // same-page runs may come from different cores
+    if (opts->cores > 0 && (opts->cFlag == 0 || opts->compact || opts->asidMode != ASID_NONE || opts->prefetch != NULL
+        || opts->resumeFile != NULL || !opts->checkpoints.empty())) {
+        std::cerr << "--cores needs -c and can't be combined with --compact, --asid, --prefetch or checkpoints" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    if (opts->cores == 0 && (opts->coreMap != NULL || opts->coreEvents != NULL)) {
+        std::cerr << "--core-map and --core-events need --cores" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    if (opts->coreEvents != NULL && opts->frames > 0) {
+        std::cerr << "--core-events can't be combined with --frames" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    if (opts->tiers && opts->frames == 0) {
+        std::cerr << "--zswap, --swap and --tier-latency need --frames" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    // access bits are set per record and the frame table isn't checkpointed
+    if (opts->frames > 0 && (opts->compact || opts->resumeFile != NULL || !opts->checkpoints.empty())) {
+        std::cerr << "--frames can't be combined with --compact or checkpoints" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    // the readahead windows and the pages mapped ahead aren't checkpointed, and prefetched
+    // translations would hide the first use of a page mapped ahead
+    if ((opts->faultAround > 0 || opts->readahead > 0) && (opts->prefetch != NULL
+        || opts->resumeFile != NULL || !opts->checkpoints.empty())) {
+        std::cerr << "--fault-around and --readahead can't be combined with --prefetch or checkpoints" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    // node memory is only tracked for the multi-level tree. Unmaps run before records of one address
+    // space, between the frame table and the TLBs it doesn't know about
+    bool reclaimer = opts->unmapFile != NULL || opts->renumberEvery > 0 || opts->footprintEvery > 0;
+    if ((opts->reclaim || reclaimer) && strcmp(opts->pFlag, "radix") != 0) {
+        std::cerr << "--reclaim, --unmap, --renumber-every and --footprint-every need -p radix" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    if (reclaimer && (opts->compact || opts->daemon || opts->tune)) {
+        std::cerr << "--unmap, --renumber-every and --footprint-every can't be combined with --compact, --daemon or --tune" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    if (opts->unmapFile != NULL && (opts->frames > 0 || opts->cores > 0 || opts->itlb != NULL || opts->dtlb != NULL
+        || opts->stlb != NULL || !opts->tenants.empty())) {
+        std::cerr << "--unmap can't be combined with --frames, --cores, --itlb, --dtlb, --stlb or --tenant" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    // forked processes share page table levels and frames, which unmapping, evicting and
+    // renumbering would each have to follow to every sharer
+    if (opts->forkFile != NULL && (opts->asidMode == ASID_NONE || strcmp(opts->pFlag, "radix") != 0)) {
+        std::cerr << "--fork needs --asid and -p radix" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    if (opts->forkFile != NULL && (opts->frames > 0 || opts->unmapFile != NULL || opts->renumberEvery > 0
+        || opts->itlb != NULL || opts->dtlb != NULL || opts->stlb != NULL || !opts->tenants.empty()
+        || opts->compact || opts->daemon || opts->resumeFile != NULL || !opts->checkpoints.empty())) {
+        std::cerr << "--fork can't be combined with --frames, --unmap, --renumber-every, --itlb, --dtlb, --stlb, --tenant, --compact, --daemon or checkpoints" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    // representative intervals are simulated out of order from a seekable trace, and only the
+    // summary's hit rates are estimated. Events placed at record numbers would be skipped
+    if (opts->simpointInterval == 0 && (opts->simpointWarmup != ULLONG_MAX || opts->simpointSamples != DEFAULT_SIMPOINT_SAMPLES)) {
+        std::cerr << "--simpoint-warmup and --simpoint-samples need --simpoint" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    if (opts->simpointInterval > 0 && (strcmp(opts->oFlag, "summary") != 0 || opts->compact || opts->daemon
+        || !opts->tenants.empty() || opts->samplePeriod > 0 || opts->resumeFile != NULL || !opts->checkpoints.empty()
+        || opts->tune || opts->coreEvents != NULL || reclaimer || opts->forkFile != NULL)) {
+        std::cerr << "--simpoint needs -o summary and can't be combined with --compact, --daemon, --tenant, --sample, checkpoints, --tune, --core-events, --unmap, --renumber-every, --footprint-every or --fork" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    if (opts->simpointWarmup == ULLONG_MAX) {
+        opts->simpointWarmup = opts->simpointInterval;
+    }
+
+    // same-page runs cover many lines, and allocator state is not checkpointed
+    bool caches = opts->l1 != NULL || opts->l2 != NULL || opts->llc != NULL;
+    if (caches && opts->compact) {
+        std::cerr << "--compact can't be combined with --l1, --l2 or --llc" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    if (strcmp(opts->frameAlloc, "sequential") != 0 && (opts->resumeFile != NULL || !opts->checkpoints.empty())) {
+        std::cerr << "--frame-alloc=" << opts->frameAlloc << " can't be combined with checkpoints" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    if (strcmp(opts->frameAlloc, "color") == 0 && !caches) {
+        std::cerr << "--frame-alloc=color needs a cache level to take the colors from, or color:N" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    // NUMA latency is charged per access, and first touch needs the proc of every fault
+    unsigned int nodes = 0;
+    if (sscanf(opts->frameAlloc, "numa:%u", &nodes) == 1) {
+        if (opts->compact) {
+            std::cerr << "--frame-alloc=numa can't be combined with --compact" << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        if (!opts->numaLatencies.empty() && opts->numaLatencies.size() != (size_t)nodes * nodes) {
+            std::cerr << "--numa-latency needs " << nodes * nodes << " values for " << nodes << " nodes" << std::endl;
+            exit(EXIT_FAILURE);
+        }
+    }
+    else if (!opts->numaLatencies.empty()) {
+        std::cerr << "--numa-latency needs --frame-alloc=numa:N" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    // a stream is read once front to back as it arrives, and only translated
+    if (opts->daemon && (opts->compact || opts->startRecord != 0 || opts->endRecord != ULLONG_MAX
+        || opts->samplePeriod > 0 || opts->resumeFile != NULL || !opts->checkpoints.empty())) {
+        std::cerr << "--daemon can't be combined with --compact, --skip, --range, --sample or checkpoints" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    if (opts->daemon && (strcmp(opts->oFlag, "bitmasks") == 0 || strcmp(opts->oFlag, "workingset") == 0)) {
+        std::cerr << "--daemon can't be combined with -o bitmasks or workingset" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    if (opts->daemon && opts->tune) {
+        std::cerr << "--daemon can't be combined with --tune" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    if (!opts->daemon && opts->controlPath != NULL) {
+        std::cerr << "--control needs --daemon" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    std::sort(opts->checkpoints.begin(), opts->checkpoints.end(),
+        [](const CheckpointType& a, const CheckpointType& b) { return a.record < b.record; });
+
     // go here if only optional cmd-line args are given but not the mandatory ones
     if (optind > (argc - 2)) {
         std::cerr << "Error:\n  Gave optional cmd line args but not mandatory ones\n";
@@ -87,18 +851,18 @@ void processCmdLnArgs(int argc, char* argv[], int* nFlag, int* cFlag, char** oFl
 
 
 /**
- * @brief - Checks if tracefile exists and can be read.
+ * @brief - Checks if tracefile exists and can be read. Raw BYU traces and ctrace files are both accepted.
  * @param argc - count of cmdln args
  * @param argv - arr of cmdln args
- * @return FILE* for tracefile
+ * @return TraceSource* for tracefile
  */
-FILE* readTraceFile(int argc, char* argv[])
+TraceSource* readTraceFile(int argc, char* argv[])
 {
-    FILE* traceFile;
+    TraceSource* traceFile;
 
     // check that trace file can be opened
     char* traceFname = argv[optind];
-    if ((traceFile = fopen(traceFname, "rb")) == NULL) {
+    if ((traceFile = openTraceSource(traceFname)) == NULL) {
         std::cerr << "Unable to open <<" << traceFname << ">>" << std::endl;
         exit(EXIT_FAILURE);
     }
@@ -108,198 +872,534 @@ FILE* readTraceFile(int argc, char* argv[])
 
 
 /**
- * @brief - Conditionally calls the report functions ferom output_mode_helpers.c based on output mode chosen
- * @param pTable - pointer to the pageTable
- * @param virtAddr - virtual address value
- * @param physAddr - physical address value translated from virtAddr
- * @param frameNum - physical frame number for this address
- * @param tlbHit - true if address was already in TLB, else false
- * @param pageTableHit - true if address was already in pageTable, else false
- * @param v2p - true if virtual_to_physical mode
- * @param v2p_tlb - true if v2p_tlb_pt mode
- * @param vpn2pfn - true if vpn2pfn mode
- * @param offset - true if offset mode
+ * @brief - called to read address from trace file. If nFlag default mode, will read all addresses.
+ * Else, will read specified numAddresses from nFlag. Every record is passed to the Simulator.
+ * Only records inside the --skip/--range window and the current --sample window are processed, and
+ * --checkpoint snapshots are written as their record positions are reached.
+ * @param traceFile - TraceSource* for traceFile
+ * @param trace - p2AddrTr*. Used for getting the nextAddress to process
+ * @param sim - Simulator for the output mode and TLB type
+ * @param cache - tlb ptr, switched with --asid and saved in checkpoints
+ * @param opts - parsed cmd line options. Supplies nFlag, the record window, sampling and checkpoints
+ */
+template <class Sim>
+void readAddresses(TraceSource* traceFile, p2AddrTr* trace, Sim& sim, tlb* cache, CmdLnOptionsType* opts)
+{
+    PageTable* pTable = sim.pTable;
+    int numAddresses = opts->nFlag;
+    int processed = 0;
+    unsigned long long recordPos = 0;       // record traceFile returns next
+    size_t nextCheckpoint = 0;
+
+    if (!moveToRecord(traceFile, trace, &recordPos, opts->startRecord)) {
+        return;
+    }
+
+    // read virtual addresses and insert into tree if not already present
+    // numAddresses == DEFAULT_NUM_ADDRESSES reads ALL addresses in the window
+    while (recordPos < opts->endRecord && (numAddresses == DEFAULT_NUM_ADDRESSES || processed < numAddresses)) {
+        // jump to the start of the next sample window
+        if (opts->samplePeriod > 0 && recordPos % opts->samplePeriod >= opts->sampleWindow) {
+            unsigned long long windowStart = recordPos - recordPos % opts->samplePeriod + opts->samplePeriod;
+            if (!moveToRecord(traceFile, trace, &recordPos, std::min(windowStart, opts->endRecord))) {
+                break;
+            }
+            continue;
+        }
+
+        if (!traceFile->next(trace)) {
+            break;
+        }
+        recordPos++;
+
+        if (pTable->forks != NULL) {
+            pTable->forks->beforeSwitch(pTable, pTable->addressCount);
+        }
+        if (opts->asidMode != ASID_NONE) {
+            switchContext(trace, pTable, cache, opts->asidMode == ASID_FLUSH);
+        }
+        if (pTable->reclaimer != NULL) {
+            pTable->reclaimer->beforeRecord(pTable, cache, pTable->addressCount);
+        }
+        if (pTable->forks != NULL) {
+            pTable->forks->beforeAccess(pTable, cache, trace);
+        }
+        sim.process(trace);
+        processed++;
+
+        // write any checkpoints that have been reached
+        while (nextCheckpoint < opts->checkpoints.size() && opts->checkpoints[nextCheckpoint].record <= recordPos) {
+            if (!saveCheckpoint(opts->checkpoints[nextCheckpoint].fname, pTable, cache, opts->pFlag, recordPos)) {
+                exit(EXIT_FAILURE);
+            }
+            nextCheckpoint++;
+        }
+    }
+
+}
+
+/**
+ * @brief - number of records the bulk summary engines may consume, from -n and the --skip/--range window
+ * @param opts - parsed cmd line options
  */
-void report(PageTable* pTable, unsigned int virtAddr, unsigned int physAddr, unsigned int frameNum,
-    bool tlbHit, bool pageTableHit, bool v2p, bool v2p_tlb, bool vpn2pfn, bool offset)
+unsigned long long recordBudget(CmdLnOptionsType* opts)
 {
-    if (v2p) {  // virtual2PhysicalMode
-        report_virtual2physical(virtAddr, physAddr);
+    unsigned long long budget = opts->endRecord - opts->startRecord;
+    if (opts->nFlag != DEFAULT_NUM_ADDRESSES) {
+        budget = std::min(budget, (unsigned long long)std::max(opts->nFlag, 0));
     }
-    else if (v2p_tlb) {     // v2p_tlb_pt
-        // this mode prints virt to phys translation and tlbHit and pageTableHit info
-        report_v2pUsingTLB_PTwalk(virtAddr, physAddr, tlbHit, pageTableHit);
+    return budget;
+}
+
+/**
+ * @brief - simulates the next count records of traceFile, in batches unless a record needs more than
+ * the TLB in front of the pageTable
+ * @param perRecord - true to switch contexts and process the records one at a time
+ * @return records simulated, less than count if the trace ends
+ */
+template <class Sim>
+unsigned long long simulateSpan(TraceSource* traceFile, p2AddrTr* trace, Sim& sim, tlb* cache, CmdLnOptionsType* opts,
+    bool perRecord, unsigned long long count)
+{
+    if (!perRecord) {
+        return sim.runBatched(traceFile, count);
     }
-    else if (vpn2pfn) {
-        unsigned int pages[pTable->levelCount];
-        for (int i = 0; i < pTable->levelCount; i++) {
-            pages[i] = pTable->virtualAddressToPageNum(virtAddr, pTable->maskArr[i], pTable->shiftArr[i]);
+    unsigned long long done = 0;
+    for (; done < count && traceFile->next(trace); done++) {
+        if (opts->asidMode != ASID_NONE) {
+            switchContext(trace, sim.pTable, cache, opts->asidMode == ASID_FLUSH);
         }
-        // this mode shows vpn to pfn mapping
-        report_pagemap(pTable->levelCount, pages, frameNum);
+        sim.process(trace);
+    }
+    return done;
+}
+
+/**
+ * @brief - --simpoint run. Phase one reads the --skip/--range window once into a SimPoint, which
+ * clusters its intervals and picks the ones to simulate. Phase two seeks to each picked interval in
+ * trace order and simulates the simpointWarmup records before it, continuing from the previous one
+ * when it is close enough, and then the interval itself, whose TLB and page table hits go back to
+ * the SimPoint for the estimates. In one address space without --frames or pages mapped ahead, the
+ * page table is exactly the pages touched so far, so the pages first touched in the skipped
+ * intervals are mapped before the warm-up
+ * @param traceFile - TraceSource* for traceFile, needs seekRecord to go back for phase two
+ * @param trace - p2AddrTr* used as scratch space when seeking
+ * @param sim - Simulator with SummaryOutput
+ * @param cache - tlb ptr, switched with --asid
+ * @param opts - parsed cmd line options. Supplies the record window and the --simpoint settings
+ * @param perRecord - true to process the records one at a time
+ */
+template <class Sim>
+void readSimPoints(TraceSource* traceFile, p2AddrTr* trace, Sim& sim, tlb* cache, CmdLnOptionsType* opts, bool perRecord)
+{
+    PageTable* pTable = sim.pTable;
+    SimPoint simPoint(opts->simpointInterval, opts->simpointClusters, opts->simpointSamples, SIMPOINT_SEED);
+    unsigned long long recordPos = 0;
+    if (!moveToRecord(traceFile, trace, &recordPos, opts->startRecord)) {
+        return;
     }
-    else if (offset) {
-        // this mode shows the offset vals of each virtAddr
-        hexnum(pTable->getOffsetOfAddress(virtAddr));
+
+    // phase one, signatures of every interval
+    p2AddrTr records[TRANSLATE_BATCH_SIZE];
+    unsigned long long budget = recordBudget(opts);
+    size_t count;
+    while (budget > 0 && (count = traceFile->nextBatch(records, std::min(budget, (unsigned long long)TRANSLATE_BATCH_SIZE))) > 0) {
+        simPoint.profile(records, count, pTable->offsetShift, opts->asidMode != ASID_NONE);
+        budget -= count;
+        recordPos += count;
+    }
+    simPoint.finishProfile();
+    simPoint.cluster();
+
+    // phase two, warm up and simulate the picked intervals
+    bool mapSkipped = opts->asidMode == ASID_NONE && pTable->frames == NULL && pTable->faultAround == NULL;
+    size_t mapped = 0;      // pages of simPoint.firstTouched mapped
+    for (size_t i = 0; i < simPoint.picked.size(); i++) {
+        const SimPoint::Interval& interval = simPoint.intervals[simPoint.picked[i]];
+        unsigned long long start = opts->startRecord + interval.start;
+        unsigned long long warmStart = start - std::min(opts->simpointWarmup, interval.start);
+        size_t touched = mapSkipped ? simPoint.touchedBefore(warmStart - opts->startRecord) : 0;
+        for (; mapped < touched; mapped++) {
+            unsigned int vpn = (unsigned int)simPoint.firstTouched[mapped];
+            if (pTable->backend->lookup(vpn) == nullptr) {
+                pTable->backend->insert(vpn, pTable->nextFrame(vpn));
+                pTable->takeFrame(vpn);
+            }
+        }
+        if (recordPos < warmStart || recordPos > start) {
+            if (!traceFile->seekRecord(warmStart)) {
+                std::cerr << "--simpoint needs a seekable trace file" << std::endl;
+                exit(EXIT_FAILURE);
+            }
+            recordPos = warmStart;
+        }
+        recordPos += simulateSpan(traceFile, trace, sim, cache, opts, perRecord, start - recordPos);
+
+        unsigned int tlbHits = pTable->countTlbHits;
+        unsigned int pageTableHits = pTable->countPageTableHits;
+        recordPos += simulateSpan(traceFile, trace, sim, cache, opts, perRecord, interval.length);
+        simPoint.simulated(simPoint.picked[i], pTable->countTlbHits - tlbHits, pTable->countPageTableHits - pageTableHits);
     }
+    simPoint.report(opts->simpointWarmup);
 }
 
 /**
- * @brief - Takes in next address and calculates framenum, physAddr, and pageTableHit.
- * Checks pageTable to see if there's a hit. Inserts mapping into pageTable if not present.
- * @param trace - p2AddrTr*. Used for getting the nextAddress to process
- * @param pTable - pointer to pageTable obj. Holds info about the levels and masks
- * @param v2p - true if virtual2physical mode
- * @param v2p_tlb - true if v2p_tlb_pt mode
- * @param vpn2pfn - true if vpn2pfn mode
- * @param offset - true if offset mode
+ * @brief - summary mode run, simulated with the fastest engine the options allow: same-page runs
+ * with --compact, batches when every record is translated in one address space with nothing but
+ * the TLB in front of the pageTable, otherwise one record at a time
+ * @param traceFile - TraceSource* for traceFile
+ * @param trace - p2AddrTr* used as scratch space when seeking
+ * @param sim - Simulator with SummaryOutput
+ * @param cache - tlb ptr, switched with --asid and saved in checkpoints
+ * @param opts - parsed cmd line options
  */
-void processNextAddress(p2AddrTr* trace, PageTable* pTable,
-    bool v2p, bool v2p_tlb, bool vpn2pfn, bool offset)
+template <class Sim>
+void readSummary(TraceSource* traceFile, p2AddrTr* trace, Sim& sim, tlb* cache, CmdLnOptionsType* opts)
 {
-    unsigned int virtAddr = 0;
-    unsigned int frameNum = 0;
-    unsigned int physAddr = 0;
-    bool tlbHit = false;
-    bool pageTableHit = true;   // default true, conditional check if not
-    Map* frame;
-
-    virtAddr = trace->addr;     // assign virtAddr a value
-
-    frame = pTable->pageLookup(pTable->rootLevel, virtAddr);
-    if (frame == nullptr) {
-        // go here if PageTable MISS
-        pageTableHit = false;
-        pTable->pageInsert(pTable->rootLevel, virtAddr);
-        frame = pTable->pageLookup(pTable->rootLevel, virtAddr);
-        frameNum = frame->getFrameNum();
-        pTable->frameCount++;
+    bool perRecord = opts->samplePeriod > 0 || !opts->checkpoints.empty() || opts->asidMode != ASID_NONE
+        || opts->prefetch != NULL || opts->frames > 0 || strncmp(opts->frameAlloc, "numa", 4) == 0
+        || opts->coreEvents != NULL || opts->faultAround > 0 || opts->readahead > 0 || opts->unmapFile != NULL
+        || opts->renumberEvery > 0 || opts->footprintEvery > 0;
+    if (opts->simpointInterval > 0) {
+        readSimPoints(traceFile, trace, sim, cache, opts, perRecord);
+        return;
+    }
+    if (!opts->compact && perRecord) {
+        readAddresses(traceFile, trace, sim, cache, opts);
+        return;
+    }
+
+    unsigned long long recordPos = 0;
+    if (!moveToRecord(traceFile, trace, &recordPos, opts->startRecord)) {
+        return;
+    }
+    if (opts->compact) {
+        sim.runCompacted(traceFile, recordBudget(opts));
     }
     else {
-        // go here if PageTable HIT
-        frameNum = frame->getFrameNum();
-        pTable->countPageTableHits++;
+        sim.runBatched(traceFile, recordBudget(opts));
     }
+}
+
+/**
+ * @brief - --daemon engine. Simulates records as the Daemon hands them over, keeping the pageTable
+ * and TLB state across producers, and answers stats requests between batches. A snapshot goes to
+ * stderr every statsEvery records. Blocks are translated with processBatch when every record is
+ * in one address space with nothing but the TLB in front of the pageTable
+ * @param daemon - Daemon with the stream endpoints
+ * @param sim - Simulator for the output mode and TLB type
+ * @param cache - tlb ptr, switched with --asid
+ * @param opts - parsed cmd line options. Supplies nFlag and statsEvery
+ */
+template <class Sim>
+void readStream(Daemon* daemon, Sim& sim, tlb* cache, CmdLnOptionsType* opts)
+{
+    PageTable* pTable = sim.pTable;
+    bool batched = opts->asidMode == ASID_NONE && opts->prefetch == NULL && opts->frames == 0
+        && strncmp(opts->frameAlloc, "numa", 4) != 0 && opts->coreEvents == NULL && opts->faultAround == 0
+        && opts->readahead == 0;
+    unsigned long long maxRecords = (opts->nFlag == DEFAULT_NUM_ADDRESSES) ? ULLONG_MAX : (unsigned long long)std::max(opts->nFlag, 0);
+    unsigned long long processed = 0;
+    unsigned long long nextSnapshot = opts->statsEvery;
+    p2AddrTr records[TRANSLATE_BATCH_SIZE];
+    char line[DAEMON_STATS_LEN];
+    int event;
 
-    physAddr = pTable->appendOffset(frameNum, virtAddr);    // calculate physical address
+    while (processed < maxRecords && (event = daemon->wait()) != DAEMON_STOP) {
+        if (event == DAEMON_STATS) {
+            formatStats(line, sizeof(line), pTable);
+            daemon->answerStats(line);
+            continue;
+        }
 
-    // call reporting functions
-    report(pTable, virtAddr, physAddr, frameNum, tlbHit, pageTableHit, v2p, v2p_tlb, vpn2pfn, offset);
+        // simulate everything buffered, stopping at snapshots so they fall on exact record counts
+        unsigned long long limit = std::min(maxRecords - processed, (unsigned long long)TRANSLATE_BATCH_SIZE);
+        if (nextSnapshot > 0) {
+            limit = std::min(limit, nextSnapshot - processed);
+        }
+        size_t count;
+        while ((count = daemon->source->takeBuffered(records, limit)) > 0) {
+            if (batched) {
+                sim.processBatch(records, count);
+            }
+            else {
+                for (size_t i = 0; i < count; i++) {
+                    if (opts->asidMode != ASID_NONE) {
+                        switchContext(&records[i], pTable, cache, opts->asidMode == ASID_FLUSH);
+                    }
+                    sim.process(&records[i]);
+                }
+            }
+            processed += count;
 
+            if (processed == nextSnapshot) {
+                formatStats(line, sizeof(line), pTable);
+                fprintf(stderr, "%s\n", line);
+                nextSnapshot += opts->statsEvery;
+            }
+            limit = std::min(maxRecords - processed, (unsigned long long)TRANSLATE_BATCH_SIZE);
+            if (nextSnapshot > 0) {
+                limit = std::min(limit, nextSnapshot - processed);
+            }
+            if (limit == 0) {
+                break;
+            }
+        }
+    }
+    fflush(stdout);
 }
 
 /**
- * @brief - Overloaded version that takes into account the TLB cache.
- * Takes in next address and calculates framenum, physAddr, tlbHit and pageTableHit.
- * First checks if mapping in TLB. If not, updates the TLB and checks pageTable to see if there's a hit.
- * Inserts mapping into pageTable if not present. Regardless of hit status for tlb or pageTable, updates the
- * recent address queue.
- * @param trace - p2AddrTr*. Used for getting the nextAddress to process
- * @param pTable - pointer to pageTable obj. Holds info about the levels and masks
- * @param cache - tlb* for accessing cache info and mappings
- * @param v2p - true if virtual2physical mode
- * @param v2p_tlb - true if v2p_tlb_pt mode
- * @param vpn2pfn - true if vpn2pfn mode
- * @param offset - true if offset mode
+ * @brief - per-record output modes, reads the daemon's stream if there is one, otherwise the trace file
  */
-void processNextAddress(p2AddrTr* trace, PageTable* pTable, tlb* cache,
-    bool v2p, bool v2p_tlb, bool vpn2pfn, bool offset)
+template <class Sim>
+void readRecords(TraceSource* traceFile, Daemon* daemon, p2AddrTr* trace, Sim& sim, tlb* cache, CmdLnOptionsType* opts)
 {
-    unsigned int virtAddr = 0;
-    unsigned int vpn = 0;
-    unsigned int frameNum = 0;
-    unsigned int physAddr = 0;
-    bool tlbHit = false;
-    bool pageTableHit = true;   // default true, conditional check if not
-    Map* frame;
-
-    virtAddr = trace->addr;     // assign virtAddr a value
-    vpn = virtAddr & cache->vpnMask;
-    vpn = vpn >> (MEMORY_SPACE_SIZE - pTable->vpnNumBits);
-
-    // go here if TLB hit
-    if (cache->hasMapping(vpn)) {
-        frameNum = cache->vpn2pfn[vpn];
-        tlbHit = true;
-        pTable->countTlbHits++;
-        cache->updateQueue(vpn);    // update most recently used
-    }
-    // go here if TLB MISS
+    if (daemon != NULL) {
+        readStream(daemon, sim, cache, opts);
+    }
     else {
-        frame = pTable->pageLookup(pTable->rootLevel, virtAddr);
-        if (frame == nullptr) {
-            // go here if PageTable MISS
-            pageTableHit = false;
-            pTable->pageInsert(pTable->rootLevel, virtAddr);
-            frame = pTable->pageLookup(pTable->rootLevel, virtAddr);
-            frameNum = frame->getFrameNum();
-            cache->insertMapping(vpn, frameNum);    // update cache
-            pTable->frameCount++;
+        readAddresses(traceFile, trace, sim, cache, opts);
+    }
+}
+
+/**
+ * @brief - builds the Simulator for the output mode with TlbPolicy in front of the pageTable and
+ * runs the trace file, or the daemon's stream, through it
+ * @param traceFile - TraceSource* for traceFile, unused with a daemon
+ * @param daemon - Daemon* for --daemon, otherwise NULL
+ * @param trace - p2AddrTr* scratch record
+ * @param pTable - ptr to pageTable
+ * @param cache - tlb ptr, switched with --asid and saved in checkpoints
+ * @param tlbPolicy - NoTlb, FlatTlb or HierarchyTlb
+ * @param caches - data caches fed with the physical addresses, or NULL
+ * @param opts - parsed cmd line options. oFlag picks the OutputPolicy
+ */
+template <class TlbPolicy>
+void simulate(TraceSource* traceFile, Daemon* daemon, p2AddrTr* trace, PageTable* pTable, tlb* cache,
+    const TlbPolicy& tlbPolicy, DataCaches* caches, CmdLnOptionsType* opts)
+{
+    if (strcmp(opts->oFlag, "virtual2physical") == 0) {
+        Simulator<Virtual2PhysicalOutput, TlbPolicy> sim(pTable, tlbPolicy, caches);
+        readRecords(traceFile, daemon, trace, sim, cache, opts);
+    }
+    else if (strcmp(opts->oFlag, "v2p_tlb_pt") == 0) {
+        Simulator<V2PTlbPtOutput, TlbPolicy> sim(pTable, tlbPolicy, caches);
+        readRecords(traceFile, daemon, trace, sim, cache, opts);
+    }
+    else if (strcmp(opts->oFlag, "vpn2pfn") == 0) {
+        Simulator<Vpn2PfnOutput, TlbPolicy> sim(pTable, tlbPolicy, caches);
+        readRecords(traceFile, daemon, trace, sim, cache, opts);
+    }
+    else if (strcmp(opts->oFlag, "offset") == 0) {
+        Simulator<OffsetOutput, TlbPolicy> sim(pTable, tlbPolicy, caches);
+        readRecords(traceFile, daemon, trace, sim, cache, opts);
+    }
+    else {
+        Simulator<SummaryOutput, TlbPolicy> sim(pTable, tlbPolicy, caches);
+        if (daemon != NULL) {
+            readStream(daemon, sim, cache, opts);
         }
         else {
-            // go here if PageTable HIT
-            frameNum = frame->getFrameNum();
-            cache->insertMapping(vpn, frameNum);    // update cache
-            pTable->countPageTableHits++;
+            readSummary(traceFile, trace, sim, cache, opts);
         }
-        cache->updateQueue(vpn);    // update most recently used
     }
+}
+
+/**
+ * @brief - -o workingset engine. Streams the --skip/--range window of the trace through a
+ * WorkingSetAnalyzer without simulating translation. Times are record numbers, or p2AddrTr::time
+ * with --interval=time:T (a time lower than the previous one is taken as the 32 bit counter wrapping)
+ * @param traceFile - TraceSource* for traceFile
+ * @param trace - p2AddrTr* used as scratch space when seeking
+ * @param pTable - ptr to pageTable. Supplies the page size
+ * @param opts - parsed cmd line options. Supplies nFlag, the record window, interval and taus
+ */
+void analyzeWorkingSet(TraceSource* traceFile, p2AddrTr* trace, PageTable* pTable, CmdLnOptionsType* opts)
+{
+    unsigned long long recordPos = 0;
+    std::vector<unsigned long long> taus = opts->taus;
+    if (taus.empty()) {
+        taus.push_back(opts->intervalLength);
+    }
+    WorkingSetAnalyzer analyzer(opts->intervalLength, taus);
 
-    physAddr = pTable->appendOffset(frameNum, virtAddr);    // calculate physAddr
+    if (moveToRecord(traceFile, trace, &recordPos, opts->startRecord)) {
+        p2AddrTr records[TRANSLATE_BATCH_SIZE];
+        unsigned long long remaining = recordBudget(opts);
+        unsigned long long timeBase = 0;
+        uint32_t lastTime = 0;
+        size_t count;
 
-    // call reporting function
-    report(pTable, virtAddr, physAddr, frameNum, tlbHit, pageTableHit, v2p, v2p_tlb, vpn2pfn, offset);
+        while (remaining > 0 && (count = traceFile->nextBatch(records, std::min(remaining, (unsigned long long)TRANSLATE_BATCH_SIZE))) > 0) {
+            for (size_t i = 0; i < count; i++) {
+                unsigned long long time = recordPos + i;
+                if (opts->intervalByTime) {
+                    if (records[i].time < lastTime) {
+                        timeBase += 1ULL << 32;
+                    }
+                    lastTime = records[i].time;
+                    time = timeBase + records[i].time;
+                }
+                analyzer.access(records[i].addr >> pTable->offsetShift, time);
+            }
+            recordPos += count;
+            remaining -= count;
+        }
+    }
 
+    analyzer.finish();
 }
 
 
 /**
- * @brief - called to read address from trace file. If nFlag default mode, will read all addresses.
- * Else, will read specified numAddresses from nFlag. Also will process addresses based on if usingTlb.
- * @param traceFile - FILE* for traceFile
- * @param trace - p2AddrTr*. Used for getting the nextAddress to process. Will be passed to processNextAddress
- * @param pTable - ptr to pageTable which holds info about masks and levels. Will be passed to processNextAddress
- * @param cache - tlb ptr with info about cache and recent address queue. Used to determine if tlb is being used
- * @param numAddresses - how many addresses to process based on nFlag optional cmdln arg
- * @param v2p - true if virtual2physical mode
- * @param v2p_tlb - true if v2p_tlb_pt mode
- * @param vpn2pfn - true if vpn2pfn mode
- * @param offset - true if offset mode
+ * @brief - --tune, collects the distinct pages of the --skip/--range/-n window and prints the
+ * smallest page table split of the vpn bits for every depth, next to the split that was given
+ * @param traceFile - TraceSource* for traceFile
+ * @param trace - p2AddrTr* used as scratch space when seeking
+ * @param pTable - pageTable holding the given split and the offset shift
+ * @param opts - parsed cmd line options
  */
-void readAddresses(FILE* traceFile, p2AddrTr* trace, PageTable* pTable, tlb* cache, int numAddresses,
-    bool v2p, bool v2p_tlb, bool vpn2pfn, bool offset)
+void tuneGeometry(TraceSource* traceFile, p2AddrTr* trace, PageTable* pTable, CmdLnOptionsType* opts)
 {
-    // read all virtual addresses and insert into tree if not already present
-    if (numAddresses == DEFAULT_NUM_ADDRESSES) {
-        while (!feof(traceFile)) {
-            if (NextAddress(traceFile, trace)) {     // traceFile: File handle from fOpen
-                if (cache->usingTlb()) {
-                    processNextAddress(trace, pTable, cache, v2p, v2p_tlb, vpn2pfn, offset);
-                }
-                else {
-                    processNextAddress(trace, pTable, v2p, v2p_tlb, vpn2pfn, offset);
-                }
-                pTable->addressCount++;
+    unsigned long long recordPos = 0;
+    GeometryTuner tuner(pTable->vpnNumBits);
+
+    if (moveToRecord(traceFile, trace, &recordPos, opts->startRecord)) {
+        p2AddrTr records[TRANSLATE_BATCH_SIZE];
+        uint32_t vpns[TRANSLATE_BATCH_SIZE];
+        unsigned long long remaining = recordBudget(opts);
+        size_t count;
+
+        while (remaining > 0 && (count = traceFile->nextBatch(records, std::min(remaining, (unsigned long long)TRANSLATE_BATCH_SIZE))) > 0) {
+            for (size_t i = 0; i < count; i++) {
+                vpns[i] = records[i].addr >> pTable->offsetShift;
             }
+            tuner.addPages(vpns, count);
+            recordPos += count;
+            remaining -= count;
         }
-        // read only numAddresses number of addresses
+    }
+
+    std::vector<unsigned int> given(pTable->bitsInLevel, pTable->bitsInLevel + pTable->levelCount);
+    tuner.report(opts->tuneLevels, given);
+}
+
+
+/**
+ * @brief - swaps in the -p translation structure. Levels are still used for masks and vpn2pfn output
+ * @param pTable - pageTable to give the backend
+ * @param pFlag - radix, hashed or inverted
+ */
+void useBackend(PageTable* pTable, const char* pFlag)
+{
+    if (strcmp(pFlag, "hashed") == 0) {
+        pTable->createBackend = []() -> TranslationBackend* { return new HashedPageTable(); };
+        pTable->backend = pTable->createBackend();
+    }
+    else if (strcmp(pFlag, "inverted") == 0) {
+        pTable->createBackend = []() -> TranslationBackend* { return new InvertedPageTable(); };
+        pTable->backend = pTable->createBackend();
+    }
+}
+
+
+/**
+ * @brief - --tenant solo run. Simulates the records tenant got in the shared run on a machine of its
+ * own, with the same page table, -c TLB, --frames limit and fault-around, and fills in its solo results. Frames are
+ * handed out in order, the allocation policy doesn't change hits, faults or evictions
+ * @param tenant - tenant of the shared run, its trace is opened again
+ * @param numLevels, bitsInLevel, vpnNumBits - page table geometry
+ * @param opts - parsed cmd line options
+ */
+void soloRun(TenantScheduler::Tenant* tenant, unsigned int numLevels, unsigned int* bitsInLevel, int vpnNumBits,
+    CmdLnOptionsType* opts)
+{
+    TraceSource* source = openTraceSource(tenant->name.c_str());
+    if (source == NULL) {
+        std::cerr << "Unable to open <<" << tenant->name << ">>" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    PageTable pTable(numLevels, bitsInLevel, vpnNumBits);
+    useBackend(&pTable, opts->pFlag);
+    tlb* cache = (opts->tlbPolicy != NULL && opts->cFlag > 0) ? new tlb(vpnNumBits, opts->cFlag, opts->tlbPolicy, opts->tlbSeed)
+        : new tlb(vpnNumBits, opts->cFlag);
+    if (opts->frames > 0) {
+        pTable.frames = new FrameTable(opts->frames, pTable.pageSizeBytes);
+    }
+    if (opts->faultAround > 0 || opts->readahead > 0) {
+        pTable.faultAround = new FaultAround(opts->faultAround, opts->readahead);
+    }
+    pTable.reclaim = opts->reclaim;
+
+    if (cache->usingTlb()) {
+        Simulator<SummaryOutput, FlatTlb> sim(&pTable, FlatTlb(cache));
+        sim.run(source, tenant->records);
     }
     else {
-        for (int i = 0; i < numAddresses; i++) {
-            if (NextAddress(traceFile, trace)) {     // traceFile: File handle from fOpen
-                if (cache->usingTlb()) {
-                    processNextAddress(trace, pTable, cache, v2p, v2p_tlb, vpn2pfn, offset);
-                }
-                else {
-                    processNextAddress(trace, pTable, v2p, v2p_tlb, vpn2pfn, offset);
-                }
-                pTable->addressCount++;
-            }
-        }
+        Simulator<SummaryOutput, NoTlb> sim(&pTable, NoTlb());
+        sim.run(source, tenant->records);
     }
 
+    tenant->soloRun = true;
+    tenant->soloTlbHits = pTable.countTlbHits;
+    tenant->soloPageTableHits = pTable.countPageTableHits;
+    if (pTable.frames != NULL) {
+        tenant->soloEvictions = pTable.frames->cleanEvictions + pTable.frames->dirtyEvictions;
+        delete pTable.frames;
+    }
+    delete pTable.faultAround;
+    delete cache;
+    delete source;
+}
+
+
+/**
+ * @brief - whether the run only prints report_summary, so its result can be cached. Anything that
+ * adds a report of its own, reads a stream, or starts from a checkpoint is simulated every time
+ */
+bool cacheable(CmdLnOptionsType* opts)
+{
+    return strcmp(opts->oFlag, "summary") == 0 && !opts->daemon && !opts->tune && opts->tenants.empty()
+        && opts->itlb == NULL && opts->dtlb == NULL && opts->stlb == NULL && opts->prefetch == NULL
+        && opts->frames == 0 && opts->l1 == NULL && opts->l2 == NULL && opts->llc == NULL
+        && strcmp(opts->frameAlloc, "sequential") == 0 && opts->cores == 0 && opts->asidMode == ASID_NONE
+        && opts->faultAround == 0 && opts->readahead == 0 && opts->checkpoints.empty() && opts->resumeFile == NULL
+        && !opts->reclaim && opts->unmapFile == NULL && opts->renumberEvery == 0 && opts->footprintEvery == 0
+        && opts->simpointInterval == 0;
 }
 
+
+/**
+ * @brief - the configuration part of a result cache key. Only options that change the summary are
+ * included, so --compact, which gives the same result, and a --tlb-seed the policy doesn't use share
+ * the result of the plain run
+ * @param numLevels - number of page table levels
+ * @param bitsInLevel - bits in each level
+ */
+std::string cacheConfig(CmdLnOptionsType* opts, unsigned int numLevels, unsigned int* bitsInLevel)
+{
+    char field[128];
+    snprintf(field, sizeof(field), "v%d levels=", RESULT_CACHE_VERSION);
+    std::string config = field;
+    for (unsigned int i = 0; i < numLevels; i++) {
+        snprintf(field, sizeof(field), i == 0 ? "%u" : ",%u", bitsInLevel[i]);
+        config += field;
+    }
+    snprintf(field, sizeof(field), " n=%d c=%d p=%s records=%llu:%llu sample=%llu:%llu", opts->nFlag, opts->cFlag,
+        opts->pFlag, opts->startRecord, opts->endRecord, opts->sampleWindow, opts->samplePeriod);
+    config += field;
+    if (opts->cFlag > 0 && opts->tlbPolicy != NULL) {
+        config += std::string(" policy=") + opts->tlbPolicy;
+        if (strncmp(opts->tlbPolicy, "random", 6) == 0 || strncmp(opts->tlbPolicy, "brrip", 5) == 0) {
+            snprintf(field, sizeof(field), " seed=%u", opts->tlbSeed);
+            config += field;
+        }
+    }
+    return config;
+}
+
+
 /**
  * @brief - process cmd line args. Number of levels, bits in each level and numVpnBits based on cmd line args.
  * Call readTraceFile to check if traceFile can be opened. Create pageTable and tlb objects. Conditionally readAddresses
@@ -307,11 +1407,76 @@ void readAddresses(FILE* traceFile, p2AddrTr* trace, PageTable* pTable, tlb* cac
  */
 int main(int argc, char** argv)
 {
-    int nFlag = DEFAULT_NUM_ADDRESSES;      // how many addresses to read in (default -1 = read ALL addresses)
-    int cFlag = DEFAULT_CACHE_SIZE;         // cache capacity (default 0 = no TLB)
-    char* oFlag = DEFAULT_OUTPUT_MODE;      // what type of output to show (default = summary)
+    CmdLnOptionsType opts;
+    opts.nFlag = DEFAULT_NUM_ADDRESSES;     // how many addresses to read in (default -1 = read ALL addresses)
+    opts.cFlag = DEFAULT_CACHE_SIZE;        // cache capacity (default 0 = no TLB)
+    opts.oFlag = DEFAULT_OUTPUT_MODE;       // what type of output to show (default = summary)
+    opts.pFlag = DEFAULT_PAGE_TABLE_TYPE;   // which translation structure to simulate (default = radix)
+    opts.compact = false;                   // simulate every record one at a time (default)
+    opts.startRecord = 0;                   // simulate the whole trace (default)
+    opts.endRecord = ULLONG_MAX;
+    opts.sampleWindow = 0;                  // no sampling (default)
+    opts.samplePeriod = 0;
+    opts.resumeFile = NULL;                 // start from an empty pageTable and tlb (default)
+    opts.itlb = NULL;                       // flat -c TLB, no hierarchy (default)
+    opts.dtlb = NULL;
+    opts.stlb = NULL;
+    opts.tlbExclusive = false;              // inclusive hierarchy (default)
+    opts.tlbPolicy = NULL;                  // recent pages queue for -c, lru for hierarchy levels (default)
+    opts.tlbSeed = 1;
+    opts.asidMode = ASID_NONE;              // ignore proc, one address space (default)
+    opts.prefetch = NULL;                   // no TLB prefetching (default)
+    opts.prefetchDegree = 1;
+    opts.prefetchBuffer = DEFAULT_PREFETCH_BUFFER;
+    opts.frames = 0;                        // unlimited physical memory (default)
+    opts.tiers = false;                     // evictions are only counted (default)
+    opts.zswapBytes = 0;
+    opts.zswapRatio = DEFAULT_ZSWAP_RATIO;
+    opts.swapLatency = DEFAULT_SWAP_LATENCY;
+    opts.swapDepth = DEFAULT_SWAP_DEPTH;
+    opts.tierLatencies[0] = TIER_MEMORY_LATENCY;
+    opts.tierLatencies[1] = TIER_MINOR_LATENCY;
+    opts.tierLatencies[2] = TIER_COMPRESS_LATENCY;
+    opts.tierLatencies[3] = TIER_DECOMPRESS_LATENCY;
+    opts.faultAround = 0;                   // map only the faulting page (default)
+    opts.readahead = 0;
+    opts.intervalByTime = false;            // -o workingset intervals of 100000 records (default)
+    opts.intervalLength = DEFAULT_INTERVAL_LENGTH;
+    opts.l1 = NULL;                         // no data caches (default)
+    opts.l2 = NULL;
+    opts.llc = NULL;
+    opts.lineSize = DEFAULT_LINE_SIZE;
+    opts.frameAlloc = (char*)"sequential";  // frames handed out in order (default)
+    opts.daemon = false;                    // read a trace file (default)
+    opts.streamFormat = STREAM_BYU;
+    opts.statsEvery = DEFAULT_STATS_EVERY;
+    opts.controlPath = NULL;
+    opts.cores = 0;                         // one TLB (default)
+    opts.coreMap = NULL;
+    opts.coreEvents = NULL;
+    opts.shootdownLocal = SHOOTDOWN_LOCAL_LATENCY;
+    opts.shootdownIpi = SHOOTDOWN_IPI_LATENCY;
+    opts.tune = false;                      // simulate the given geometry (default)
+    opts.tuneLevels = DEFAULT_TUNE_LEVELS;
+    opts.quantum = DEFAULT_QUANTUM;         // one trace (default), tenants take slices of 10000 records
+    opts.noCache = false;                   // cache summary results (default)
+    opts.cacheDir = NULL;
+    opts.cacheMax = DEFAULT_CACHE_ENTRIES;
+    opts.cacheClear = false;
+    opts.reclaim = false;                   // freed nodes stay in the tree (default)
+    opts.unmapFile = NULL;
+    opts.renumberEvery = 0;
+    opts.footprintEvery = 0;
+    opts.forkFile = NULL;                   // every proc starts with an empty address space (default)
+    opts.simpointInterval = 0;              // simulate every record (default)
+    opts.simpointClusters = DEFAULT_SIMPOINT_CLUSTERS;
+    opts.simpointWarmup = ULLONG_MAX;       // one interval once --simpoint is known
+    opts.simpointSamples = DEFAULT_SIMPOINT_SAMPLES;
 
-    processCmdLnArgs(argc, argv, &nFlag, &cFlag, &oFlag);
+    processCmdLnArgs(argc, argv, &opts);
+    int cFlag = opts.cFlag;
+    char* oFlag = opts.oFlag;
+    char* pFlag = opts.pFlag;
 
     unsigned int numLevels = (argc - 1) - optind;   // number of levels for pageTable calculated from mandatory cmd line args
     unsigned int bitsInLevel[numLevels];            // unsigned int arr holding numBits in each level
@@ -323,37 +1488,250 @@ int main(int argc, char** argv)
         vpnNumBits += bitsInLevel[i];
     }
 
-    FILE* traceFile = readTraceFile(argc, argv);    // check if traceFile can be opened
+    // a summary already cached for the trace's contents and this configuration is reported without simulating
+    ResultCache* resultCache = NULL;
+    uint64_t cacheKey = 0;
+    std::string cacheDescription;
+    if (!opts.noCache && (opts.cacheClear || cacheable(&opts))) {
+        resultCache = new ResultCache(opts.cacheDir != NULL ? opts.cacheDir : defaultCacheDir().c_str(), opts.cacheMax);
+        uint64_t digest;
+        if (!resultCache->usable) {
+            std::cerr << "Unable to use cache directory <<" << resultCache->dir << ">>, results won't be cached" << std::endl;
+            delete resultCache;
+            resultCache = NULL;
+        }
+        else if (opts.cacheClear) {
+            resultCache->clear();
+        }
+        if (resultCache != NULL && (!cacheable(&opts) || !resultCache->traceDigest(argv[optind], &digest))) {
+            delete resultCache;     // an unreadable trace is reported by readTraceFile
+            resultCache = NULL;
+        }
+        if (resultCache != NULL) {
+            std::string config = cacheConfig(&opts, numLevels, bitsInLevel);
+            cacheKey = hashFinish(hash64(config.data(), config.size(), digest), config.size());
+            cacheDescription = std::string(argv[optind]) + " " + config;
+            SummaryResult result;
+            if (resultCache->lookup(cacheKey, &result)) {
+                report_summary(result.pageSize, result.tlbHits, result.pageTableHits, result.addresses,
+                    result.frames, result.bytes);
+                delete resultCache;
+                return 0;
+            }
+        }
+    }
+
+    // with --daemon the trace argument names the stream instead of a file
+    TraceSource* traceFile = NULL;
+    Daemon* daemon = NULL;
+    if (opts.daemon) {
+        if ((daemon = startDaemon(argv[optind], opts.controlPath, opts.streamFormat)) == NULL) {
+            exit(EXIT_FAILURE);
+        }
+    }
+    else {
+        traceFile = readTraceFile(argc, argv);    // check if traceFile can be opened
+    }
     p2AddrTr trace;
 
     // instantiate PageTable and tlb objects
     PageTable pTable(numLevels, bitsInLevel, vpnNumBits);
-    tlb* cache = new tlb(vpnNumBits, cFlag);
+    tlb* cache = (opts.tlbPolicy != NULL && cFlag > 0) ? new tlb(vpnNumBits, cFlag, opts.tlbPolicy, opts.tlbSeed)
+        : new tlb(vpnNumBits, cFlag);
+    if (opts.prefetch != NULL) {
+        cache->prefetcher = createTlbPrefetcher(opts.prefetch, opts.prefetchDegree, opts.prefetchBuffer);
+    }
 
-    // deal with output mode
-    if (strcmp(oFlag, "bitmasks") == 0) {
-        report_bitmasks(numLevels, pTable.maskArr);
+    // optional split L1 / STLB hierarchy in place of the flat tlb
+    TlbHierarchy* tlbs = NULL;
+    if (opts.itlb != NULL || opts.dtlb != NULL || opts.stlb != NULL) {
+        const char* names[] = { "iTLB", "dTLB", "STLB" };
+        const char* specs[] = { opts.itlb, opts.dtlb, opts.stlb };
+        TlbLevel* levels[3] = { NULL, NULL, NULL };
+        for (int i = 0; i < 3; i++) {
+            const char* policy = (opts.tlbPolicy != NULL) ? opts.tlbPolicy : "lru";
+            if (specs[i] != NULL && (levels[i] = parseTlbLevel(names[i], specs[i], policy, opts.tlbSeed)) == NULL) {
+                std::cerr << names[i] << " must be given as entries:ways[:policy] with entries a multiple of ways" << std::endl;
+                exit(EXIT_FAILURE);
+            }
+        }
+        tlbs = new TlbHierarchy(levels[0], levels[1], levels[2], opts.tlbExclusive);
+    }
+
+    // per-core TLBs in place of the flat tlb
+    MultiCore* cores = NULL;
+    if (opts.cores > 0) {
+        if ((cores = createMultiCore(opts.cores, opts.coreMap, opts.coreEvents, vpnNumBits, cFlag, opts.tlbPolicy, opts.tlbSeed)) == NULL) {
+            exit(EXIT_FAILURE);
+        }
+        cores->localLatency = opts.shootdownLocal;
+        cores->ipiLatency = opts.shootdownIpi;
+    }
+
+    useBackend(&pTable, pFlag);
+
+    // optional L1 / L2 / LLC data caches behind translation
+    DataCaches* caches = NULL;
+    if (opts.l1 != NULL || opts.l2 != NULL || opts.llc != NULL) {
+        const char* names[] = { "L1", "L2", "LLC" };
+        const char* specs[] = { opts.l1, opts.l2, opts.llc };
+        CacheLevel* levels[CACHE_LEVELS] = { NULL, NULL, NULL };
+        for (int i = 0; i < CACHE_LEVELS; i++) {
+            if (specs[i] != NULL && (levels[i] = parseCacheLevel(names[i], specs[i], opts.lineSize, opts.tlbSeed)) == NULL) {
+                std::cerr << names[i] << " must be given as size[K|M]:ways[:policy] with size a multiple of ways * line size" << std::endl;
+                exit(EXIT_FAILURE);
+            }
+        }
+        caches = new DataCaches(levels[0], levels[1], levels[2], opts.lineSize);
+    }
+    // frames come from the --frames pool, or the whole physical space the vpn bits can address. --asid
+    // processes all fault into it, and the allocators number faults past it once it is used up
+    unsigned int frameSpace = opts.frames > 0 ? opts.frames : (unsigned int)std::min(1ULL << pTable.vpnNumBits, 0xFFFFFFFFULL);
+    pTable.allocator = createFrameAllocator(opts.frameAlloc, frameSpace,
+        caches != NULL ? caches->colors(pTable.pageSizeBytes) : 1, opts.numaLatencies, opts.tlbSeed);
+
+    // limited physical memory with page eviction
+    if (opts.frames > 0) {
+        pTable.frames = new FrameTable(opts.frames, pTable.pageSizeBytes);
+        if (opts.tiers) {
+            MemoryTiers* tiers = new MemoryTiers(pTable.pageSizeBytes, opts.zswapBytes, opts.zswapRatio,
+                opts.swapLatency, opts.swapDepth);
+            tiers->memoryLatency = opts.tierLatencies[0];
+            tiers->minorLatency = opts.tierLatencies[1];
+            tiers->compressLatency = opts.tierLatencies[2];
+            tiers->decompressLatency = opts.tierLatencies[3];
+            pTable.frames->tiers = tiers;
+        }
+    }
+
+    // --tenant, the trace argument is tenant 0 and the scheduler interleaves every tenant's records
+    TenantScheduler* scheduler = NULL;
+    if (!opts.tenants.empty()) {
+        scheduler = new TenantScheduler(&pTable, cache, opts.quantum);
+        scheduler->addTenant(argv[optind], traceFile, opts.weights.empty() ? 1 : opts.weights[0]);
+        for (size_t i = 0; i < opts.tenants.size(); i++) {
+            TraceSource* source = openTraceSource(opts.tenants[i]);
+            if (source == NULL) {
+                std::cerr << "Unable to open <<" << opts.tenants[i] << ">>" << std::endl;
+                exit(EXIT_FAILURE);
+            }
+            scheduler->addTenant(opts.tenants[i], source, opts.weights.empty() ? 1 : opts.weights[i + 1]);
+        }
+        traceFile = scheduler;
     }
-    else if (strcmp(oFlag, "virtual2physical") == 0) {
-        readAddresses(traceFile, &trace, &pTable, cache, nFlag, true, false, false, false);
+
+    // pages mapped ahead of use on a page fault
+    if (opts.faultAround > 0 || opts.readahead > 0) {
+        pTable.faultAround = new FaultAround(opts.faultAround, opts.readahead);
     }
-    else if (strcmp(oFlag, "v2p_tlb_pt") == 0) {
-        readAddresses(traceFile, &trace, &pTable, cache, nFlag, false, true, false, false);
+
+    // page table memory freed on unmap, unmap events, renumber passes and footprint samples
+    pTable.reclaim = opts.reclaim;
+    if (opts.reclaim || opts.unmapFile != NULL || opts.renumberEvery > 0 || opts.footprintEvery > 0) {
+        if ((pTable.reclaimer = createReclaimer(opts.unmapFile, 1ULL << pTable.vpnNumBits, opts.renumberEvery, opts.footprintEvery)) == NULL) {
+            exit(EXIT_FAILURE);
+        }
     }
-    else if (strcmp(oFlag, "vpn2pfn") == 0) {
-        readAddresses(traceFile, &trace, &pTable, cache, nFlag, false, false, true, false);
+
+    // processes created as copy-on-write copies of others
+    if (opts.forkFile != NULL && (pTable.forks = createForkModel(opts.forkFile)) == NULL) {
+        exit(EXIT_FAILURE);
     }
-    else if (strcmp(oFlag, "offset") == 0) {
-        readAddresses(traceFile, &trace, &pTable, cache, nFlag, false, false, false, true);
+
+    // continue from a checkpoint instead of replaying the trace up to it
+    if (opts.resumeFile != NULL) {
+        unsigned long long resumeRecord;
+        if (!loadCheckpoint(opts.resumeFile, &pTable, cache, pFlag, &resumeRecord)) {
+            exit(EXIT_FAILURE);
+        }
+        opts.startRecord = std::max(opts.startRecord, resumeRecord);
     }
-    else if (strcmp(oFlag, "summary") == 0) {
-        readAddresses(traceFile, &trace, &pTable, cache, nFlag, false, false, false, false);
-        report_summary(pTable.pageSizeBytes, pTable.countTlbHits,
-            pTable.countPageTableHits, pTable.addressCount, pTable.frameCount, pTable.numBytesSize);
+
+    // deal with output mode
+    if (opts.tune) {
+        tuneGeometry(traceFile, &trace, &pTable, &opts);
+    }
+    else if (strcmp(oFlag, "bitmasks") == 0) {
+        report_bitmasks(numLevels, pTable.maskArr);
+    }
+    else if (strcmp(oFlag, "workingset") == 0) {
+        analyzeWorkingSet(traceFile, &trace, &pTable, &opts);
+    }
+    else if (strcmp(oFlag, "virtual2physical") == 0 || strcmp(oFlag, "v2p_tlb_pt") == 0
+        || strcmp(oFlag, "vpn2pfn") == 0 || strcmp(oFlag, "offset") == 0 || strcmp(oFlag, "summary") == 0) {
+        if (tlbs != NULL) {
+            simulate(traceFile, daemon, &trace, &pTable, cache, HierarchyTlb(tlbs), caches, &opts);
+        }
+        else if (cores != NULL) {
+            simulate(traceFile, daemon, &trace, &pTable, cache, MultiCoreTlb(cores), caches, &opts);
+        }
+        else if (cache->usingTlb()) {
+            simulate(traceFile, daemon, &trace, &pTable, cache, FlatTlb(cache), caches, &opts);
+        }
+        else {
+            simulate(traceFile, daemon, &trace, &pTable, cache, NoTlb(), caches, &opts);
+        }
     }
     else {
         std::cout << "Invalid Output Mode" << std::endl;
         exit(EXIT_FAILURE);
     }
 
+    if (strcmp(oFlag, "summary") == 0 && !opts.tune) {
+        report_summary(pTable.pageSizeBytes, pTable.countTlbHits,
+            pTable.countPageTableHits, pTable.addressCount, pTable.frameCount, pTable.totalBytesUsed());
+        if (resultCache != NULL) {
+            SummaryResult result = { pTable.pageSizeBytes, pTable.countTlbHits, pTable.countPageTableHits,
+                pTable.addressCount, pTable.frameCount, pTable.totalBytesUsed() };
+            resultCache->store(cacheKey, result, cacheDescription);
+        }
+        if (tlbs != NULL) {
+            tlbs->report();
+        }
+        if (cache->prefetcher != NULL) {
+            cache->prefetcher->report();
+        }
+        if (cores != NULL) {
+            cores->report();
+        }
+        if (pTable.frames != NULL) {
+            pTable.frames->report(&pTable);
+            if (pTable.frames->tiers != NULL) {
+                pTable.frames->tiers->report(pTable.addressCount);
+            }
+        }
+        if (pTable.faultAround != NULL) {
+            pTable.faultAround->report(pTable.addressCount - pTable.countTlbHits - pTable.countPageTableHits, pTable.frameCount);
+        }
+        if (pTable.reclaimer != NULL) {
+            pTable.reclaimer->report(&pTable);
+        }
+        if (pTable.forks != NULL) {
+            pTable.forks->report(&pTable);
+        }
+        if (caches != NULL) {
+            caches->report();
+        }
+        if (pTable.allocator != NULL) {
+            pTable.allocator->report();
+        }
+        if (opts.asidMode != ASID_NONE) {
+            printf("Processes: %lu, context switches: %u (%s), TLB misses caused by context switches: %u\n",
+                (unsigned long)std::max(pTable.processRoots.size(), (size_t)1), pTable.contextSwitches,
+                opts.asidMode == ASID_FLUSH ? "flush" : "tagged", cache->switchMisses);
+        }
+        if (daemon != NULL) {
+            printf("Stream producers: %u\n", daemon->producers);
+        }
+        if (scheduler != NULL) {
+            scheduler->settle();
+            for (size_t i = 0; i < scheduler->tenants.size(); i++) {
+                soloRun(&scheduler->tenants[i], numLevels, bitsInLevel, vpnNumBits, &opts);
+            }
+            scheduler->report();
+        }
+    }
+
+    delete daemon;      // removes the socket files
+    delete resultCache;
 }
\ No newline at end of file
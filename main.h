@@ -1 +1,125 @@
-void processCmdLnArgs(int argc, char* argv[], int* nFlag, int* cFlag, char** oFlag);
+#ifndef MAIN
+#define MAIN
+
+#include <vector>
+
+// --asid modes. With flush or tagged every proc gets its own page table
+#define ASID_NONE 0         // one address space for the whole trace
+#define ASID_FLUSH 1        // context switches flush the TLB
+#define ASID_TAGGED 2       // TLB entries are tagged with the asid and survive context switches
+
+/*
+ * --checkpoint=N:file, snapshot the simulation to fname once N trace records have been consumed
+ */
+typedef struct {
+    unsigned long long record;
+    char* fname;
+} CheckpointType;
+
+/*
+ * command line options. Short flags from the assignment plus the long-only options
+ */
+typedef struct {
+    int nFlag;          // how many addresses to read in (-1 = read ALL addresses)
+    int cFlag;          // TLB capacity (0 = no TLB)
+    char* oFlag;        // what type of output to show
+    char* pFlag;        // which translation structure to simulate
+    bool compact;       // collapse runs of same-page accesses before simulating (summary mode)
+
+    // which trace records to simulate. Record numbers are zero based positions in the trace file
+    unsigned long long startRecord;     // --skip=N or the A of --range=A:B
+    unsigned long long endRecord;       // the B of --range=A:B, exclusive
+    unsigned long long sampleWindow;    // --sample=W:P, simulate W records out of every P (0 = off)
+    unsigned long long samplePeriod;
+
+    std::vector<CheckpointType> checkpoints;    // sorted by record
+    char* resumeFile;                           // --resume=file, NULL to start from scratch
+
+    // TLB hierarchy, each level given as entries:ways[:policy]. NULL levels are not simulated
+    char* itlb;
+    char* dtlb;
+    char* stlb;
+    bool tlbExclusive;
+
+    char* tlbPolicy;            // --tlb-policy, NULL keeps the recent pages queue for -c
+    unsigned int tlbSeed;       // --tlb-seed, for the random and brrip policies
+
+    int asidMode;               // --asid, ASID_NONE ignores p2AddrTr::proc
+
+    char* prefetch;                     // --prefetch, next|stride|distance. NULL for no prefetching
+    unsigned int prefetchDegree;        // --prefetch-degree, most pages prefetched per miss
+    unsigned int prefetchBuffer;        // --prefetch-buffer, entries. 0 prefetches into the TLB
+
+    unsigned int frames;        // --frames, physical memory limit in frames. 0 for unlimited
+
+    // backing tiers behind --frames. tiers is set by --zswap, --swap or --tier-latency
+    bool tiers;
+    unsigned long long zswapBytes;      // --zswap=size[:ratio], 0 for no compressed pool
+    double zswapRatio;
+    double swapLatency;                 // --swap=us[:depth]
+    unsigned int swapDepth;
+    double tierLatencies[4];            // --tier-latency=memory,minor,compress,decompress ns
+
+    // pages mapped ahead on a page fault
+    unsigned int faultAround;   // --fault-around=K, aligned block of K pages. 0 for none
+    unsigned int readahead;     // --readahead=MAX, largest sequential readahead window. 0 for none
+
+    // page table memory over the run
+    bool reclaim;                       // --reclaim, free levels and leaf arrays an unmap empties
+    char* unmapFile;                    // --unmap file of "record vpn [pages]" lines, NULL for none
+    unsigned long long renumberEvery;   // --renumber-every=N records, 0 for never
+    unsigned long long footprintEvery;  // --footprint-every=N records, 0 for never
+
+    char* forkFile;             // --fork file of "record parent child" lines, NULL for none
+
+    // --simpoint=N[:K] representative interval sampling, 0 intervals for off
+    unsigned long long simpointInterval;
+    unsigned int simpointClusters;
+    unsigned long long simpointWarmup;  // --simpoint-warmup=N records before every interval
+    unsigned int simpointSamples;       // --simpoint-samples=N intervals per cluster
+
+    // -o workingset intervals, --interval=records:N or time:T, and --tau window sizes in the same unit
+    bool intervalByTime;
+    unsigned long long intervalLength;
+    std::vector<unsigned long long> taus;
+
+    // physically addressed data caches, each level given as size:ways[:policy]. NULL levels are not simulated
+    char* l1;
+    char* l2;
+    char* llc;
+    unsigned int lineSize;      // --line-size, bytes per cache line
+    char* frameAlloc;           // --frame-alloc policy, see isFrameAllocator. color takes the page colors of the largest cache level
+    std::vector<double> numaLatencies;  // --numa-latency, nodes * nodes ns. Empty for the defaults
+
+    // --cores, per-core TLBs over the shared pageTable with shootdowns on unmap and remap
+    unsigned int cores;         // 0 for the single -c TLB
+    char* coreMap;              // --core-map file of proc to core lines, NULL for proc % cores
+    char* coreEvents;           // --core-events file of unmap / remap events, NULL for none
+    double shootdownLocal;      // --shootdown-latency=LOCAL,IPI in ns
+    double shootdownIpi;
+
+    // --tune searches page table splits of the vpn bits instead of simulating
+    bool tune;
+    unsigned int tuneLevels;    // --tune-levels, deepest split considered
+
+    // --tenant, more traces consolidated on the machine, each a process of its own
+    std::vector<char*> tenants;
+    unsigned long long quantum;             // --quantum, records per slice
+    std::vector<unsigned int> weights;      // --weights, one per trace. Empty for all 1
+
+    // summary results cached on disk by trace digest and configuration
+    bool noCache;               // --no-cache, always simulate and store nothing
+    char* cacheDir;             // --cache-dir, NULL for $XDG_CACHE_HOME or ~/.cache
+    unsigned int cacheMax;      // --cache-max, results kept before the least recently used are evicted
+    bool cacheClear;            // --cache-clear, empty the cache first
+
+    // --daemon, the trace argument is - (stdin) or unix:PATH and records are simulated as they arrive
+    bool daemon;
+    int streamFormat;                   // --stream-format, STREAM_BYU or STREAM_ADDR32
+    unsigned long long statsEvery;      // --stats-every=N, snapshot on stderr every N records (0 = off)
+    char* controlPath;                  // --control=PATH, socket answering stats and quit. NULL for none
+} CmdLnOptionsType;
+
+void processCmdLnArgs(int argc, char* argv[], CmdLnOptionsType* opts);
+
+#endif
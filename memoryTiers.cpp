@@ -0,0 +1,233 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+#include "memoryTiers.h"
+
+
+/**
+ * @brief - constructor, every tier starts empty
+ * @param pageSizeBytes - uncompressed page size
+ * @param zswapBytes - zswap pool capacity, 0 to evict straight to swap
+ * @param ratio - mean compression ratio, at least 1
+ * @param swapLatency - us per swap IO
+ * @param swapDepth - swap IOs served at once
+ */
+MemoryTiers::MemoryTiers(unsigned int pageSizeBytes, unsigned long long zswapBytes, double ratio,
+    double swapLatency, unsigned int swapDepth)
+{
+    this->pageSizeBytes = pageSizeBytes;
+    this->zswapBytes = zswapBytes;
+    this->ratio = ratio;
+    this->swapLatency = swapLatency * 1000.0;
+    this->swapDepth = swapDepth;
+    this->memoryLatency = TIER_MEMORY_LATENCY;
+    this->minorLatency = TIER_MINOR_LATENCY;
+    this->compressLatency = TIER_COMPRESS_LATENCY;
+    this->decompressLatency = TIER_DECOMPRESS_LATENCY;
+    this->busyUntil.assign(swapDepth, 0.0);
+
+    this->minorFaults = 0;
+    this->compressedHits = 0;
+    this->majorFaults = 0;
+    this->zswapStores = 0;
+    this->zswapRejects = 0;
+    this->zswapWritebacks = 0;
+    this->swapReads = 0;
+    this->swapWrites = 0;
+    this->zswapUsed = 0;
+    this->zswapPeak = 0;
+    this->zswapOriginal = 0;
+    this->minorStall = 0;
+    this->compressStall = 0;
+    this->decompressStall = 0;
+    this->majorStall = 0;
+    this->queueWait = 0;
+}
+
+
+/**
+ * @brief - simulated time in ns after accesses records and every stall so far
+ */
+double MemoryTiers::now(unsigned long long accesses)
+{
+    return accesses * memoryLatency + minorStall + compressStall + decompressStall + majorStall;
+}
+
+
+/**
+ * @brief - compressed size of a page. Sizes are spread evenly by a hash of the vpn over
+ * ZSWAP_SIZE_SPREAD either side of pageSizeBytes / ratio, or less when ratio is so close to 1 that
+ * the largest would pass the page size. Sizes, not ratios, average out, so the pages' bytes over
+ * their compressed bytes comes to ratio, and the same page always compresses the same way
+ */
+unsigned int MemoryTiers::compressedBytes(unsigned long long page)
+{
+    unsigned int hash = (unsigned int)page * 2654435761u;
+    double spread = (hash >> 8) / (double)(1u << 24) * 2.0 - 1.0;
+    double width = std::min((double)ZSWAP_SIZE_SPREAD, ratio - 1.0);
+    return (unsigned int)(pageSizeBytes / ratio * (1.0 + spread * width));
+}
+
+
+/**
+ * @brief - queues an IO on the first swap slot to come free
+ * @param at - ns the IO is issued
+ * @param waited - set to the ns it waited for a slot
+ * @return ns the IO completes
+ */
+double MemoryTiers::submit(double at, double* waited)
+{
+    std::vector<double>::iterator slot = std::min_element(busyUntil.begin(), busyUntil.end());
+    double start = std::max(at, *slot);
+    *waited = start - at;
+    *slot = start + swapLatency;
+    return *slot;
+}
+
+
+/**
+ * @brief - writes a page to swap in the background
+ */
+void MemoryTiers::writeToSwap(unsigned long long page, double at)
+{
+    double waited;
+    submit(at, &waited);
+    swapWrites++;
+    onSwap.insert(page);
+}
+
+
+/**
+ * @brief - a page reclaimed from memory. A dirty page's swap copy is stale. The page goes into the
+ * pool, pushing the oldest pages out to swap if it overflows, or to swap if it isn't there already
+ * @param page - page evicted
+ * @param dirty - page was written since it was mapped
+ * @param accesses - records simulated so far
+ */
+void MemoryTiers::evict(unsigned long long page, bool dirty, unsigned long long accesses)
+{
+    double at = now(accesses);
+    if (dirty) {
+        onSwap.erase(page);
+    }
+
+    if (zswapBytes > 0) {
+        unsigned int bytes = compressedBytes(page);
+        if (pageSizeBytes >= ZSWAP_MIN_RATIO * bytes) {
+            compressStall += compressLatency;
+            poolOrder.push_back(page);
+            PoolEntry entry;
+            entry.age = --poolOrder.end();
+            entry.bytes = bytes;
+            pool[page] = entry;
+            zswapStores++;
+            zswapUsed += bytes;
+            zswapOriginal += pageSizeBytes;
+
+            while (zswapUsed > zswapBytes) {
+                unsigned long long oldest = poolOrder.front();
+                poolOrder.pop_front();
+                zswapUsed -= pool[oldest].bytes;
+                zswapOriginal -= pageSizeBytes;
+                pool.erase(oldest);
+                zswapWritebacks++;
+                if (onSwap.count(oldest) == 0) {
+                    writeToSwap(oldest, at);
+                }
+            }
+            zswapPeak = std::max(zswapPeak, zswapUsed);
+            return;
+        }
+        zswapRejects++;
+    }
+
+    if (onSwap.count(page) == 0) {
+        writeToSwap(page, at);
+    }
+}
+
+
+/**
+ * @brief - classifies a page fault and charges its stall
+ * @param page - page that faulted
+ * @param accesses - records simulated so far
+ */
+void MemoryTiers::fault(unsigned long long page, unsigned long long accesses)
+{
+    std::unordered_map<unsigned long long, PoolEntry>::iterator entry = pool.find(page);
+    if (entry != pool.end()) {
+        zswapUsed -= entry->second.bytes;
+        zswapOriginal -= pageSizeBytes;
+        poolOrder.erase(entry->second.age);
+        pool.erase(entry);
+        compressedHits++;
+        decompressStall += decompressLatency;
+    }
+    else if (onSwap.count(page) != 0) {
+        double at = now(accesses);
+        double waited;
+        majorStall += submit(at, &waited) - at;
+        queueWait += waited;
+        swapReads++;
+        majorFaults++;
+    }
+    else {
+        minorFaults++;
+        minorStall += minorLatency;
+    }
+}
+
+
+/**
+ * @brief - prints the faults of each kind, what every tier holds, where the time went and the
+ * average memory access time
+ * @param accesses - records simulated
+ */
+void MemoryTiers::report(unsigned long long accesses)
+{
+    double stall = minorStall + compressStall + decompressStall + majorStall;
+    printf("Memory tiers: zswap %llu bytes (mean ratio %.2f), swap %.1f us per IO, queue depth %u\n",
+        zswapBytes, ratio, swapLatency / 1000.0, swapDepth);
+    printf("  Faults: minor: %llu, compressed hits: %llu, major: %llu\n", minorFaults, compressedHits, majorFaults);
+    printf("  zswap: stores: %llu, rejected: %llu, written back: %llu, holds: %lu pages in %llu bytes (peak %llu), effective ratio: %.2f\n",
+        zswapStores, zswapRejects, zswapWritebacks, (unsigned long)pool.size(), zswapUsed, zswapPeak,
+        zswapUsed ? (double)zswapOriginal / zswapUsed : 0.0);
+    printf("  Swap: reads: %llu, writes: %llu, holds: %lu pages\n", swapReads, swapWrites, (unsigned long)onSwap.size());
+    printf("  Stall ns: minor: %.0f, compress: %.0f, decompress: %.0f, major: %.0f (queue wait: %.0f)\n",
+        minorStall, compressStall, decompressStall, majorStall, queueWait);
+    printf("  AMAT: %.1f ns (memory: %.1f ns, faults and reclaim: %.1f ns per access)\n",
+        accesses ? memoryLatency + stall / accesses : 0.0, memoryLatency, accesses ? stall / accesses : 0.0);
+    fflush(stdout);
+}
+
+
+/**
+ * @brief - parses a --zswap spec
+ * @param spec - e.g. "64M" or "256K:2.5"
+ * @param bytes - set to the pool capacity
+ * @param ratio - set to the mean compression ratio, DEFAULT_ZSWAP_RATIO if not given
+ */
+bool parseZswap(const char* spec, unsigned long long* bytes, double* ratio)
+{
+    char* end;
+    *bytes = strtoull(spec, &end, 10);
+    if (*end == 'K' || *end == 'k') {
+        *bytes <<= 10;
+        end++;
+    }
+    else if (*end == 'M' || *end == 'm') {
+        *bytes <<= 20;
+        end++;
+    }
+    else if (*end == 'G' || *end == 'g') {
+        *bytes <<= 30;
+        end++;
+    }
+    *ratio = DEFAULT_ZSWAP_RATIO;
+    if (*end == ':') {
+        char* ratioEnd;
+        *ratio = strtod(end + 1, &ratioEnd);
+        end = ratioEnd;
+    }
+    return end != spec && *end == '\0' && *bytes > 0 && *ratio >= 1.0;
+}
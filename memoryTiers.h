@@ -0,0 +1,99 @@
+#ifndef MEMORYTIERS
+#define MEMORYTIERS
+
+#include <vector>
+#include <list>
+#include <unordered_map>
+#include <unordered_set>
+
+#define DEFAULT_ZSWAP_RATIO 3.0         // mean compression ratio of a zswap page
+#define ZSWAP_MIN_RATIO 1.25            // pages that compress worse than this go straight to swap
+#define ZSWAP_SIZE_SPREAD 0.5           // compressed sizes spread up to this share either side of their mean
+#define DEFAULT_SWAP_LATENCY 80.0       // us per swap device IO
+#define DEFAULT_SWAP_DEPTH 1            // IOs the swap device serves at once
+
+// --tier-latency defaults, ns
+#define TIER_MEMORY_LATENCY 100.0       // every access
+#define TIER_MINOR_LATENCY 1000.0       // first touch fault, a zeroed frame
+#define TIER_COMPRESS_LATENCY 5000.0    // compressing a page into zswap during reclaim
+#define TIER_DECOMPRESS_LATENCY 3000.0  // fault served from zswap
+
+
+/**
+ * @brief - --zswap / --swap backing tiers behind the --frames limit. A page evicted from memory is
+ * compressed into a zswap pool of capacity bytes, or written to the swap device if it compresses
+ * too badly or there is no pool. When the pool is full its oldest pages are written back to swap.
+ * A page fault is then
+ *      minor - the page was never evicted and gets a zeroed frame
+ *      compressed hit - the page is decompressed out of the pool
+ *      major - the page is read from swap
+ * A page read from swap keeps its swap copy until it is dirtied, so evicting it clean needs no write.
+ *
+ * Time advances by the memory latency per access plus the stalls of faults and reclaim. The swap
+ * device serves depth IOs at once, each taking latency, and an IO that finds every slot busy waits.
+ * Faults wait for their read, write backs only occupy the device.
+ */
+class MemoryTiers
+{
+public:
+    // zswapBytes 0 for no pool. swapLatency in us
+    MemoryTiers(unsigned int pageSizeBytes, unsigned long long zswapBytes, double ratio,
+        double swapLatency, unsigned int swapDepth);
+
+    // called with the records simulated so far, evict before fault when a fault reclaims a frame.
+    // page is the vpn, with the asid above ASID_SHIFT under --asid so processes don't share pages
+    void evict(unsigned long long page, bool dirty, unsigned long long accesses);
+    void fault(unsigned long long page, unsigned long long accesses);
+
+    void report(unsigned long long accesses);
+
+    unsigned int pageSizeBytes;
+    unsigned long long zswapBytes;      // pool capacity
+    double ratio;                       // mean compression ratio, page bytes over compressed bytes
+    double swapLatency;                 // ns per IO
+    unsigned int swapDepth;
+    double memoryLatency;               // ns, see TIER_MEMORY_LATENCY and the rest
+    double minorLatency;
+    double compressLatency;
+    double decompressLatency;
+
+    // statistics
+    unsigned long long minorFaults;
+    unsigned long long compressedHits;
+    unsigned long long majorFaults;
+    unsigned long long zswapStores;
+    unsigned long long zswapRejects;        // compressed too badly for the pool
+    unsigned long long zswapWritebacks;     // pushed out of the full pool to swap
+    unsigned long long swapReads;
+    unsigned long long swapWrites;
+    unsigned long long zswapUsed;           // compressed bytes in the pool
+    unsigned long long zswapPeak;
+    unsigned long long zswapOriginal;       // uncompressed bytes of the pages in the pool
+    double minorStall;                      // ns
+    double compressStall;
+    double decompressStall;
+    double majorStall;
+    double queueWait;                       // part of majorStall spent waiting for a free IO slot
+
+private:
+    struct PoolEntry
+    {
+        std::list<unsigned long long>::iterator age;
+        unsigned int bytes;
+    };
+    std::list<unsigned long long> poolOrder;                    // oldest first
+    std::unordered_map<unsigned long long, PoolEntry> pool;     // page -> compressed page
+    std::unordered_set<unsigned long long> onSwap;              // pages with a valid swap copy
+    std::vector<double> busyUntil;                          // ns each IO slot is free again
+
+    double now(unsigned long long accesses);
+    unsigned int compressedBytes(unsigned long long page);
+    double submit(double at, double* waited);               // returns when the IO completes
+    void writeToSwap(unsigned long long page, double at);
+};
+
+
+// parses "size[K|M|G][:ratio]" for --zswap. Returns false if malformed
+bool parseZswap(const char* spec, unsigned long long* bytes, double* ratio);
+
+#endif
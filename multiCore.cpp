@@ -0,0 +1,245 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include "multiCore.h"
+#include "pageTable.h"
+
+
+/**
+ * @brief - constructor, one empty TLB per core
+ * @param numCores - simulated cores, at most MAX_CORES
+ * @param vpnNumBits - bits in a vpn
+ * @param capacity - entries of every core's TLB
+ * @param policy - --tlb-policy name, NULL for the recent pages queue
+ * @param seed - rng seed for the random and brrip policies, offset per core
+ */
+MultiCore::MultiCore(unsigned int numCores, int vpnNumBits, int capacity, const char* policy, unsigned int seed)
+{
+    this->numCores = numCores;
+    for (unsigned int core = 0; core < numCores; core++) {
+        tlbs.push_back(policy != NULL ? new tlb(vpnNumBits, capacity, policy, seed + core) : new tlb(vpnNumBits, capacity));
+    }
+    this->nextEvent = 0;
+    this->localLatency = SHOOTDOWN_LOCAL_LATENCY;
+    this->ipiLatency = SHOOTDOWN_IPI_LATENCY;
+    this->hits.assign(numCores, 0);
+    this->misses.assign(numCores, 0);
+    this->shootdowns = 0;
+    this->evictionShootdowns = 0;
+    this->unmapEvents = 0;
+    this->remapEvents = 0;
+    this->localOnly = 0;
+    this->ipis = 0;
+    this->liveIpis = 0;
+    this->latency = 0;
+}
+
+
+MultiCore::~MultiCore()
+{
+    for (unsigned int core = 0; core < numCores; core++) {
+        delete tlbs[core];
+    }
+}
+
+
+/**
+ * @brief - core trace proc runs on, from --core-map or proc % numCores
+ */
+unsigned int MultiCore::coreOf(unsigned int proc)
+{
+    std::map<unsigned int, unsigned int>::iterator it = coreMap.find(proc);
+    return it != coreMap.end() ? it->second : proc % numCores;
+}
+
+
+/**
+ * @brief - adds core to the sharers of vpn after its TLB was filled
+ */
+void MultiCore::filled(unsigned int vpn, unsigned int core)
+{
+    sharers[vpn] |= 1ULL << core;
+}
+
+
+/**
+ * @brief - invalidates vpn in the initiator's TLB and sends an IPI to every other core in its sharer
+ * mask. The mask can be stale, a sharer may have evicted the entry since, so the IPIs that still
+ * found the entry are counted separately. The mask is cleared
+ * @param vpn - page unmapped or remapped
+ * @param initiator - core that changed the mapping
+ */
+void MultiCore::shootdown(unsigned int vpn, unsigned int initiator)
+{
+    uint64_t mask = 0;
+    std::unordered_map<unsigned int, uint64_t>::iterator it = sharers.find(vpn);
+    if (it != sharers.end()) {
+        mask = it->second;
+        sharers.erase(it);
+    }
+    mask &= ~(1ULL << initiator);
+
+    tlbs[initiator]->invalidate(vpn);
+    unsigned int sent = 0;
+    for (unsigned int core = 0; core < numCores; core++) {
+        if (mask & (1ULL << core)) {
+            sent++;
+            if (tlbs[core]->hasMapping(vpn)) {
+                liveIpis++;
+                tlbs[core]->invalidate(vpn);
+            }
+        }
+    }
+    shootdowns++;
+    ipis += sent;
+    localOnly += (sent == 0);
+    latency += localLatency + sent * ipiLatency;
+}
+
+
+/**
+ * @brief - runs every --core-events entry due before record. An unmap invalidates the page and a
+ * remap also maps it to a new frame. Either is shot down. Events on pages that aren't mapped do nothing
+ * @param pTable - shared pageTable
+ * @param record - simulated records so far
+ * @param core - core of the record about to be simulated, initiates events that don't name one
+ */
+void MultiCore::applyEvents(PageTable* pTable, unsigned long long record, unsigned int core)
+{
+    while (nextEvent < events.size() && events[nextEvent].record <= record) {
+        Event* event = &events[nextEvent++];
+        Map* frame = pTable->backend->lookup(event->vpn);
+        if (frame == nullptr) {
+            continue;
+        }
+        pTable->backend->invalidate(event->vpn);
+        if (event->kind == CORE_EVENT_REMAP) {
+            pTable->backend->insert(event->vpn, pTable->nextFrame(event->vpn));
+            pTable->takeFrame(event->vpn);
+            remapEvents++;
+        }
+        else {
+            unmapEvents++;
+        }
+        shootdown(event->vpn, event->core >= 0 ? event->core : core);
+    }
+}
+
+
+/**
+ * @brief - prints the TLB hits of every core and the shootdowns, IPIs and latency they cost
+ */
+void MultiCore::report()
+{
+    printf("Cores: %u\n", numCores);
+    for (unsigned int core = 0; core < numCores; core++) {
+        unsigned long long accesses = hits[core] + misses[core];
+        printf("  Core %u: accesses: %llu, TLB hits: %llu, hit percentage: %.2f%%\n", core, accesses, hits[core],
+            accesses ? (double)hits[core] / accesses * 100.0 : 0.0);
+    }
+    printf("Shootdowns: %llu (evictions: %llu, unmaps: %llu, remaps: %llu), without IPIs: %llu\n",
+        shootdowns, evictionShootdowns, unmapEvents, remapEvents, localOnly);
+    printf("  IPIs: %llu, to cores still holding the entry: %llu, IPIs per shootdown: %.2f\n",
+        ipis, liveIpis, shootdowns ? (double)ipis / shootdowns : 0.0);
+    printf("  Shootdown latency: %.0f ns, per shootdown: %.1f ns\n", latency, shootdowns ? latency / shootdowns : 0.0);
+    fflush(stdout);
+}
+
+
+/**
+ * @brief - reads a --core-map file of "proc core" lines. Blank lines and # comments are skipped
+ * @return false after printing why if the file can't be read or names a core that doesn't exist
+ */
+static bool loadCoreMap(const char* path, unsigned int numCores, std::map<unsigned int, unsigned int>* coreMap)
+{
+    FILE* in = fopen(path, "r");
+    if (in == NULL) {
+        fprintf(stderr, "Unable to open core map %s\n", path);
+        return false;
+    }
+    char line[256];
+    unsigned int lineNum = 0;
+    while (fgets(line, sizeof(line), in) != NULL) {
+        lineNum++;
+        unsigned int proc, core;
+        char first[2];
+        if (sscanf(line, " %1s", first) != 1 || first[0] == '#') {
+            continue;
+        }
+        if (sscanf(line, "%u %u", &proc, &core) != 2 || core >= numCores) {
+            fprintf(stderr, "%s:%u: expected \"proc core\" with core below %u\n", path, lineNum, numCores);
+            fclose(in);
+            return false;
+        }
+        (*coreMap)[proc] = core;
+    }
+    fclose(in);
+    return true;
+}
+
+
+/**
+ * @brief - reads a --core-events file of "record unmap|remap vpn [core]" lines, sorted by record.
+ * vpn may be given in hex with 0x. Blank lines and # comments are skipped
+ * @param numPages - pages in the vpn space, every vpn must be below it
+ * @return false after printing why if the file can't be read, a line is malformed or a vpn is out of the vpn space
+ */
+static bool loadEvents(const char* path, unsigned int numCores, unsigned long long numPages, std::vector<MultiCore::Event>* events)
+{
+    FILE* in = fopen(path, "r");
+    if (in == NULL) {
+        fprintf(stderr, "Unable to open core events %s\n", path);
+        return false;
+    }
+    char line[256];
+    unsigned int lineNum = 0;
+    while (fgets(line, sizeof(line), in) != NULL) {
+        lineNum++;
+        char first[2];
+        if (sscanf(line, " %1s", first) != 1 || first[0] == '#') {
+            continue;
+        }
+        MultiCore::Event event;
+        char kind[8] = "";
+        char vpn[24] = "";
+        int core = -1;
+        int fields = sscanf(line, "%llu %7s %23s %d", &event.record, kind, vpn, &core);
+        char* end;
+        unsigned long long page = strtoull(vpn, &end, 0);
+        bool known = strcmp(kind, "unmap") == 0 || strcmp(kind, "remap") == 0;
+        if (fields < 3 || !known || *end != '\0' || core >= (int)numCores) {
+            fprintf(stderr, "%s:%u: expected \"record unmap|remap vpn [core]\" with core below %u\n", path, lineNum, numCores);
+            fclose(in);
+            return false;
+        }
+        // a vpn past the vpn space would alias onto a low page once shifted into an address, and
+        // the shootdown of the named vpn would leave that page's translation in the TLBs
+        if (page >= numPages) {
+            fprintf(stderr, "%s:%u: vpn past the %llu page vpn space\n", path, lineNum, numPages);
+            fclose(in);
+            return false;
+        }
+        event.vpn = (unsigned int)page;
+        event.kind = strcmp(kind, "remap") == 0 ? CORE_EVENT_REMAP : CORE_EVENT_UNMAP;
+        event.core = fields == 4 ? core : -1;
+        events->push_back(event);
+    }
+    fclose(in);
+    std::stable_sort(events->begin(), events->end(),
+        [](const MultiCore::Event& a, const MultiCore::Event& b) { return a.record < b.record; });
+    return true;
+}
+
+
+MultiCore* createMultiCore(unsigned int numCores, const char* coreMapPath, const char* eventsPath,
+    int vpnNumBits, int capacity, const char* policy, unsigned int seed)
+{
+    MultiCore* cores = new MultiCore(numCores, vpnNumBits, capacity, policy, seed);
+    if ((coreMapPath != NULL && !loadCoreMap(coreMapPath, numCores, &cores->coreMap))
+        || (eventsPath != NULL && !loadEvents(eventsPath, numCores, 1ULL << vpnNumBits, &cores->events))) {
+        delete cores;
+        return NULL;
+    }
+    return cores;
+}
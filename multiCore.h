@@ -0,0 +1,82 @@
+#ifndef MULTICORE
+#define MULTICORE
+
+#include <stdint.h>
+#include <vector>
+#include <map>
+#include <unordered_map>
+#include "tlb.h"
+
+class PageTable;
+
+#define MAX_CORES 64                        // sharers are a 64 bit mask
+#define SHOOTDOWN_LOCAL_LATENCY 250.0       // default ns for the initiator to invalidate its own entry
+#define SHOOTDOWN_IPI_LATENCY 2000.0        // default ns the initiator waits per IPI it sends
+
+// --core-events kinds
+#define CORE_EVENT_UNMAP 0      // the page is unmapped, its next access faults it back in
+#define CORE_EVENT_REMAP 1      // the page moves to a new frame, e.g. migration or compaction
+
+
+/**
+ * @brief - --cores, simulated cores that share one address space. Every trace proc runs on a core
+ * (proc % cores or a --core-map entry) and every core has its own -c TLB over the shared pageTable.
+ * Each page remembers the cores that filled it into their TLB in a sharer mask. When a page is
+ * unmapped or remapped, by a --frames eviction or a --core-events entry, the core that did it
+ * invalidates its own entry and sends an IPI to every other sharer, and is charged the latency.
+ */
+class MultiCore
+{
+public:
+    MultiCore(unsigned int numCores, int vpnNumBits, int capacity, const char* policy, unsigned int seed);
+    ~MultiCore();
+
+    unsigned int coreOf(unsigned int proc);
+    void filled(unsigned int vpn, unsigned int core);       // core's TLB now holds vpn
+    // invalidates vpn in every sharer's TLB on behalf of initiator and counts the IPIs
+    void shootdown(unsigned int vpn, unsigned int initiator);
+    // runs the --core-events due before simulated record number record
+    void applyEvents(PageTable* pTable, unsigned long long record, unsigned int core);
+
+    void report();
+
+    struct Event
+    {
+        unsigned long long record;      // simulated records before the event
+        int kind;                       // CORE_EVENT_UNMAP or CORE_EVENT_REMAP
+        unsigned int vpn;
+        int core;                       // initiating core, -1 for the core of the next record
+    };
+
+    unsigned int numCores;
+    std::vector<tlb*> tlbs;                         // one per core
+    std::map<unsigned int, unsigned int> coreMap;   // proc -> core from --core-map
+    std::vector<Event> events;                      // --core-events in record order
+    size_t nextEvent;
+    double localLatency;        // ns, see SHOOTDOWN_LOCAL_LATENCY
+    double ipiLatency;          // ns, see SHOOTDOWN_IPI_LATENCY
+
+    // statistics
+    std::vector<unsigned long long> hits;           // per core
+    std::vector<unsigned long long> misses;
+    unsigned long long shootdowns;
+    unsigned long long evictionShootdowns;          // caused by --frames
+    unsigned long long unmapEvents;
+    unsigned long long remapEvents;
+    unsigned long long localOnly;       // shootdowns without any other sharer, so without IPIs
+    unsigned long long ipis;
+    unsigned long long liveIpis;        // IPIs to a core whose TLB still held the entry
+    double latency;                     // ns charged for every shootdown
+
+private:
+    std::unordered_map<unsigned int, uint64_t> sharers;     // vpn -> cores that filled it
+};
+
+
+// creates numCores cores with capacity entry TLBs. coreMapPath names a file of "proc core" lines
+// and eventsPath one of "record unmap|remap vpn [core]" lines, either may be NULL. Returns NULL
+// after printing why if a file can't be read
+MultiCore* createMultiCore(unsigned int numCores, const char* coreMapPath, const char* eventsPath,
+    int vpnNumBits, int capacity, const char* policy, unsigned int seed);
+
+#endif
@@ -0,0 +1,47 @@
+#include <stdlib.h>
+#include <new>
+#include "nodeArena.h"
+
+
+NodeArena::NodeArena()
+{
+    this->reservedBytes = 0;
+    this->allocatedBytes = 0;
+    this->slabLeft = 0;
+    this->next = NULL;
+}
+
+
+NodeArena::~NodeArena()
+{
+    for (size_t i = 0; i < slabs.size(); i++) {
+        free(slabs[i]);
+    }
+}
+
+
+/**
+ * @brief - hands out the next bytes of the current slab, starting a new slab when they don't fit.
+ * Requests bigger than a slab get a slab of their own
+ * @param bytes - size of the node or array
+ */
+void* NodeArena::allocate(size_t bytes)
+{
+    bytes = (bytes + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+    if (bytes > slabLeft) {
+        size_t slabBytes = bytes > ARENA_SLAB_BYTES ? bytes : ARENA_SLAB_BYTES;
+        char* slab = (char*)malloc(slabBytes);      // malloc alignment covers ARENA_ALIGN on 64 bit hosts
+        if (slab == NULL) {
+            throw std::bad_alloc();
+        }
+        slabs.push_back(slab);
+        reservedBytes += slabBytes;
+        next = slab;
+        slabLeft = slabBytes;
+    }
+    void* node = next;
+    next += bytes;
+    slabLeft -= bytes;
+    allocatedBytes += bytes;
+    return node;
+}
@@ -0,0 +1,34 @@
+#ifndef NODEARENA
+#define NODEARENA
+
+#include <stddef.h>
+#include <vector>
+
+#define ARENA_SLAB_BYTES (1 << 20)      // bytes reserved at a time
+#define ARENA_ALIGN 16
+
+
+/**
+ * @brief - bump allocator the multi-level page table takes its Levels, nextLevel arrays and Map
+ * arrays from. Memory is reserved in slabs and only given back all at once when the arena is
+ * deleted, so nodes freed during a run are recycled through PageTable's freelists instead, and
+ * PageTable::renumberNodes copies the live tree into a fresh arena to drop the holes.
+ */
+class NodeArena
+{
+public:
+    NodeArena();
+    ~NodeArena();
+
+    void* allocate(size_t bytes);       // ARENA_ALIGN aligned, never fails short of running out of memory
+
+    size_t reservedBytes;       // every slab
+    size_t allocatedBytes;      // handed out, including alignment
+
+private:
+    std::vector<char*> slabs;
+    size_t slabLeft;            // bytes left in the last slab
+    char* next;
+};
+
+#endif
@@ -1,4 +1,11 @@
 #include "pageTable.h"
+#include <set>
+
+// the AVX2 index extraction is compiled for x86 with gcc/clang and picked at runtime
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define PAGETABLE_AVX2 1
+#include <immintrin.h>
+#endif
 
 /**
  * @brief - constructor zero initializes count and size fields.
@@ -18,6 +25,23 @@ PageTable::PageTable(unsigned int numLevels, unsigned int bitsInLevel[], int vpn
     this->countTlbHits = 0;
     this->countPageTableHits = 0;
     this->currFrameNum = 0;
+    this->allocator = NULL;
+    this->createBackend = NULL;
+    this->frames = NULL;
+    this->faultAround = NULL;
+    this->arena = new NodeArena();
+    this->reclaim = false;
+    this->peakBytes = 0;
+    this->levelsFreed = 0;
+    this->leafArraysFreed = 0;
+    this->bytesFreed = 0;
+    this->nodesReused = 0;
+    this->renumberPasses = 0;
+    this->reclaimer = NULL;
+    this->forks = NULL;
+    this->levelsCopied = 0;
+    this->currAsid = NO_ASID;
+    this->contextSwitches = 0;
 
     // initialize from constructor args
     this->vpnNumBits = vpnNumBits;
@@ -37,10 +61,33 @@ PageTable::PageTable(unsigned int numLevels, unsigned int bitsInLevel[], int vpn
     setMaskArr();
     setShiftArr();
 
-    // initialize rootLevel ptr
-    this->rootLevel = new Level(0, this);        // 'this' is pointer to this PageTable
+    // initialize rootLevel ptr, newLevel counts its bytes
+    this->freeLevels.resize(numLevels);
+    this->rootLevel = newLevel(0);
+    this->backend = this;                        // multi-level tree unless main picks another backend
+}
+
 
-    this->numBytesSize += sizeof(Level);         // incrementing numBytesSize by size of Level * number of possible Levels in nextLevelArr
+/**
+ * @brief - destructor. Every Level and array lives in the arena, so deleting it frees the trees of
+ * every process at once. Hashed and inverted backends were created one per process and are deleted
+ */
+PageTable::~PageTable()
+{
+    // every process's backend other than the tree itself, the current one too when there is no --asid
+    std::set<TranslationBackend*> backends;
+    for (std::map<unsigned int, TranslationBackend*>::iterator it = processBackends.begin(); it != processBackends.end(); it++) {
+        backends.insert(it->second);
+    }
+    backends.insert(backend);
+    backends.erase(this);
+    for (std::set<TranslationBackend*>::iterator it = backends.begin(); it != backends.end(); it++) {
+        delete *it;
+    }
+    delete arena;
+    delete[] entryCountArr;
+    delete[] maskArr;
+    delete[] shiftArr;
 }
 
 
@@ -157,8 +204,9 @@ unsigned int PageTable::virtualAddressToPageNum(unsigned int virtualAddress, uns
  * Uses recursion to achieve this passing the nextLevel to pageInsert each time.
  * @param lvlPtr - Level* to the current level being worked with.
  * @param virtualAddress - the virtualAddress we are trying to add
+ * @param frameNum - frame to map the page to
  */
-void PageTable::pageInsert(Level* lvlPtr, unsigned int virtualAddress)
+void PageTable::pageInsert(Level* lvlPtr, unsigned int virtualAddress, unsigned int frameNum)
 {
     unsigned int mask = maskArr[lvlPtr->currDepth];
     unsigned int shift = shiftArr[lvlPtr->currDepth];
@@ -168,25 +216,28 @@ void PageTable::pageInsert(Level* lvlPtr, unsigned int virtualAddress)
     if (lvlPtr->currDepth == levelCount - 1) {
         // go here if mapPtr array hasn't been instantiated
         if (lvlPtr->mapPtr == nullptr) {
-            lvlPtr->setMapPtr();    // instantiate mapPtr
-            numBytesSize += sizeof(Map) * entryCountArr[lvlPtr->currDepth];
+            newMaps(lvlPtr);    // instantiate mapPtr
         }
-        lvlPtr->mapPtr[pageNum].setFrameNum(currFrameNum);
+        if (!lvlPtr->mapPtr[pageNum].isValid()) {
+            lvlPtr->validCount++;
+        }
+        lvlPtr->mapPtr[pageNum].setFrameNum(frameNum);
         lvlPtr->mapPtr[pageNum].setValid();
-        currFrameNum++;
     }
     // go here if lvlPtr is interior node
     else {
-        // go here if pageNum at this level has already been set
+        // go here if pageNum at this level has already been set. A level other processes share is
+        // copied before it changes
         if (lvlPtr->nextLevel[pageNum] != nullptr) {
-            pageInsert(lvlPtr->nextLevel[pageNum], virtualAddress);
+            Level* child = sharedLevels.empty() ? lvlPtr->nextLevel[pageNum] : unshareChild(lvlPtr, pageNum);
+            pageInsert(child, virtualAddress, frameNum);
         }
         // go here if nextLevel[pageNum] has not been set yet
         else {
-            Level* newLevel = new Level(lvlPtr->currDepth + 1, this);   // newLevels depth is currDepth + 1
-            lvlPtr->nextLevel[pageNum] = newLevel;
-            numBytesSize += sizeof(Level) * entryCountArr[lvlPtr->currDepth];
-            pageInsert(newLevel, virtualAddress);
+            Level* child = newLevel(lvlPtr->currDepth + 1);     // childs depth is currDepth + 1
+            lvlPtr->nextLevel[pageNum] = child;
+            lvlPtr->validCount++;
+            pageInsert(child, virtualAddress, frameNum);
         }
     }
 }
@@ -222,7 +273,7 @@ Map* PageTable::pageLookup(Level* lvlPtr, unsigned int virtualAddress)
         return nullptr;
     }
 
-    pageLookup(lvlPtr->nextLevel[pageNum], virtualAddress);     // recursion to next level
+    return pageLookup(lvlPtr->nextLevel[pageNum], virtualAddress);     // recursion to next level
 
 }
 
@@ -237,4 +288,597 @@ unsigned int PageTable::appendOffset(unsigned int frameNum, unsigned int virtual
     unsigned int physicalAddr = frameNum << offsetShift;
     physicalAddr = physicalAddr | getOffsetOfAddress(virtualAddress);
     return physicalAddr;
+}
+
+
+/**
+ * @brief - TranslationBackend lookup. Walks the tree for the page holding vpn
+ * @param vpn - virtual page number to look up
+ */
+Map* PageTable::lookup(unsigned int vpn)
+{
+    return pageLookup(rootLevel, vpn << offsetShift);
+}
+
+
+/**
+ * @brief - TranslationBackend insert. Creates any missing levels and maps vpn to frameNum
+ * @param vpn - virtual page number to map
+ * @param frameNum - frame to map it to
+ */
+Map* PageTable::insert(unsigned int vpn, unsigned int frameNum)
+{
+    pageInsert(rootLevel, vpn << offsetShift, frameNum);
+    return lookup(vpn);
+}
+
+
+/**
+ * @brief - TranslationBackend invalidate. Clears the valid bit of the leaf entry for vpn. Levels are
+ * left allocated unless --reclaim frees the ones it empties
+ * @param vpn - virtual page number to unmap
+ */
+bool PageTable::invalidate(unsigned int vpn)
+{
+    return unmapPage(rootLevel, vpn);
+}
+
+
+/**
+ * @brief - bytes a level at depth is counted as in numBytesSize. A root is one Level, any other
+ * level is counted as a Level for every entry of its parent
+ */
+unsigned int PageTable::levelBytes(unsigned int depth)
+{
+    return depth == 0 ? sizeof(Level) : sizeof(Level) * entryCountArr[depth - 1];
+}
+
+
+/**
+ * @brief - a level for depth, from the freelist or the arena
+ */
+Level* PageTable::newLevel(unsigned int depth)
+{
+    Level* level;
+    if (!freeLevels[depth].empty()) {
+        level = freeLevels[depth].back();       // already empty, nothing to reset
+        freeLevels[depth].pop_back();
+        nodesReused++;
+    }
+    else {
+        level = new (arena->allocate(sizeof(Level))) Level(depth, this);
+    }
+    numBytesSize += levelBytes(depth);
+    peakBytes = std::max(peakBytes, numBytesSize);
+    return level;
+}
+
+
+/**
+ * @brief - gives leaf a Map array of invalid entries, from the freelist or the arena
+ */
+void PageTable::newMaps(Level* leaf)
+{
+    unsigned int entries = entryCountArr[leaf->currDepth];
+    if (!freeMaps.empty()) {
+        leaf->mapPtr = freeMaps.back();
+        freeMaps.pop_back();
+        for (unsigned int i = 0; i < entries; i++) {
+            new (&leaf->mapPtr[i]) Map();
+        }
+        nodesReused++;
+    }
+    else {
+        leaf->setMapPtr();
+    }
+    numBytesSize += sizeof(Map) * entries;
+    peakBytes = std::max(peakBytes, numBytesSize);
+}
+
+
+/**
+ * @brief - clears the leaf entry of vpn in the tree under root. With --reclaim, a leaf left without
+ * valid entries gives its Map array back, and every level left without children is unlinked from
+ * its parent, bottom-up. The root stays
+ * @param root - root level of the process the page belongs to
+ * @param vpn - virtual page number to unmap
+ * @return false if vpn wasn't mapped
+ */
+bool PageTable::unmapPage(Level* root, unsigned int vpn)
+{
+    unsigned int virtualAddress = vpn << offsetShift;
+    Level* path[MEMORY_SPACE_SIZE];
+    unsigned int index[MEMORY_SPACE_SIZE];
+    unsigned int leafDepth = levelCount - 1;
+
+    Level* lvlPtr = root;
+    for (unsigned int depth = 0; ; depth++) {
+        path[depth] = lvlPtr;
+        index[depth] = virtualAddressToPageNum(virtualAddress, maskArr[depth], shiftArr[depth]);
+        if (depth == leafDepth) {
+            break;
+        }
+        if ((lvlPtr = lvlPtr->nextLevel[index[depth]]) == nullptr) {
+            return false;
+        }
+    }
+    if (lvlPtr->mapPtr == nullptr || !lvlPtr->mapPtr[index[leafDepth]].isValid()) {
+        return false;
+    }
+    lvlPtr->mapPtr[index[leafDepth]].setInvalid();
+    lvlPtr->validCount--;
+
+    if (!reclaim || lvlPtr->validCount > 0) {
+        return true;
+    }
+    freeMaps.push_back(lvlPtr->mapPtr);
+    lvlPtr->mapPtr = nullptr;
+    numBytesSize -= sizeof(Map) * entryCountArr[leafDepth];
+    bytesFreed += sizeof(Map) * entryCountArr[leafDepth];
+    leafArraysFreed++;
+
+    for (unsigned int depth = leafDepth; depth > 0 && path[depth]->validCount == 0; depth--) {
+        path[depth - 1]->nextLevel[index[depth - 1]] = nullptr;
+        path[depth - 1]->validCount--;
+        freeLevels[depth].push_back(path[depth]);
+        numBytesSize -= levelBytes(depth);
+        bytesFreed += levelBytes(depth);
+        levelsFreed++;
+    }
+    return true;
+}
+
+
+/**
+ * @brief - copies the subtree under from into the arena, each level followed by its array and then
+ * its children in index order
+ */
+Level* PageTable::copyLevel(Level* from)
+{
+    Level* copy = new (arena->allocate(sizeof(Level))) Level(from->currDepth, this);
+    copy->validCount = from->validCount;
+    if (from->mapPtr != nullptr) {
+        copy->setMapPtr();
+        for (unsigned int i = 0; i < entryCountArr[from->currDepth]; i++) {
+            copy->mapPtr[i] = from->mapPtr[i];
+        }
+    }
+    for (unsigned int i = 0; from->nextLevel != nullptr && i < entryCountArr[from->currDepth]; i++) {
+        if (from->nextLevel[i] != nullptr) {
+            copy->nextLevel[i] = copyLevel(from->nextLevel[i]);
+        }
+    }
+    return copy;
+}
+
+
+/**
+ * @brief - gives parent a private copy of its child at index if other levels share it. The copy
+ * points at the same children, or holds a copy of the same Maps for a leaf, and takes one share
+ * from the original
+ * @return the child parent now points at
+ */
+Level* PageTable::unshareChild(Level* parent, unsigned int index)
+{
+    Level* child = parent->nextLevel[index];
+    std::unordered_map<Level*, unsigned int>::iterator shared = sharedLevels.find(child);
+    if (shared == sharedLevels.end()) {
+        return child;
+    }
+    if (--shared->second == 1) {
+        sharedLevels.erase(shared);
+    }
+
+    Level* copy = newLevel(child->currDepth);
+    copy->validCount = child->validCount;
+    unsigned int entries = entryCountArr[child->currDepth];
+    if (child->currDepth == levelCount - 1) {
+        if (child->mapPtr != nullptr) {
+            newMaps(copy);
+            for (unsigned int i = 0; i < entries; i++) {
+                copy->mapPtr[i] = child->mapPtr[i];
+            }
+        }
+    }
+    else {
+        for (unsigned int i = 0; i < entries; i++) {
+            if ((copy->nextLevel[i] = child->nextLevel[i]) != nullptr) {
+                sharedLevels.insert(std::make_pair(copy->nextLevel[i], 1u)).first->second++;
+            }
+        }
+    }
+    parent->nextLevel[index] = copy;
+    levelsCopied++;
+    return copy;
+}
+
+
+/**
+ * @brief - --fork. The child gets a root of its own pointing at the parent's level 1 levels, which
+ * are shared from then on. A single level table has nothing below the root, so its Maps are copied
+ * @param parent - asid of the process forking
+ * @param child - asid of the new process
+ */
+bool PageTable::forkProcess(unsigned int parent, unsigned int child)
+{
+    std::map<unsigned int, Level*>::iterator from = processRoots.find(parent);
+    if (from == processRoots.end() || processRoots.count(child) || backend != this) {
+        return false;
+    }
+    Level* root = newLevel(0);
+    root->validCount = from->second->validCount;
+    if (levelCount == 1) {
+        if (from->second->mapPtr != nullptr) {
+            newMaps(root);
+            for (unsigned int i = 0; i < entryCountArr[0]; i++) {
+                root->mapPtr[i] = from->second->mapPtr[i];
+            }
+        }
+    }
+    else {
+        for (unsigned int i = 0; i < entryCountArr[0]; i++) {
+            if ((root->nextLevel[i] = from->second->nextLevel[i]) != nullptr) {
+                sharedLevels.insert(std::make_pair(root->nextLevel[i], 1u)).first->second++;     // 2 when first shared
+            }
+        }
+    }
+    processRoots[child] = root;
+    processBackends[child] = this;
+    return true;
+}
+
+
+/**
+ * @brief - walks the current process's tree for vpn like pageLookup, copying every shared level
+ * on the way so the Map returned belongs to this process alone
+ */
+Map* PageTable::privateMap(unsigned int vpn)
+{
+    unsigned int virtualAddress = vpn << offsetShift;
+    Level* lvlPtr = rootLevel;
+    for (unsigned int depth = 0; depth < levelCount - 1; depth++) {
+        unsigned int pageNum = virtualAddressToPageNum(virtualAddress, maskArr[depth], shiftArr[depth]);
+        if (lvlPtr->nextLevel[pageNum] == nullptr) {
+            return nullptr;
+        }
+        lvlPtr = unshareChild(lvlPtr, pageNum);
+    }
+    unsigned int pageNum = virtualAddressToPageNum(virtualAddress, maskArr[levelCount - 1], shiftArr[levelCount - 1]);
+    if (lvlPtr->mapPtr == nullptr || !lvlPtr->mapPtr[pageNum].isValid()) {
+        return nullptr;
+    }
+    return &lvlPtr->mapPtr[pageNum];
+}
+
+
+/**
+ * @brief - adds up the levels and Map arrays under root as numBytesSize counts them, shared ones
+ * included every time they are reached
+ */
+unsigned long long PageTable::unsharedBytes(Level* root)
+{
+    unsigned long long bytes = levelBytes(root->currDepth);
+    if (root->mapPtr != nullptr) {
+        bytes += sizeof(Map) * entryCountArr[root->currDepth];
+    }
+    for (unsigned int i = 0; root->nextLevel != nullptr && i < entryCountArr[root->currDepth]; i++) {
+        if (root->nextLevel[i] != nullptr) {
+            bytes += unsharedBytes(root->nextLevel[i]);
+        }
+    }
+    return bytes;
+}
+
+
+/**
+ * @brief - --renumber-every compaction pass. Live nodes move to a fresh arena in vpn order, so a
+ * walk of nearby pages touches nearby memory again, and the holes freed nodes left are released
+ */
+void PageTable::renumberNodes()
+{
+    NodeArena* old = arena;
+    arena = new NodeArena();
+    for (unsigned int depth = 0; depth < levelCount; depth++) {
+        freeLevels[depth].clear();
+    }
+    freeMaps.clear();
+
+    if (processRoots.empty()) {
+        rootLevel = copyLevel(rootLevel);
+    }
+    else {
+        Level* current = rootLevel;
+        for (std::map<unsigned int, Level*>::iterator it = processRoots.begin(); it != processRoots.end(); it++) {
+            Level* copy = copyLevel(it->second);
+            if (it->second == current) {
+                rootLevel = copy;
+            }
+            it->second = copy;
+        }
+    }
+    delete old;
+    renumberPasses++;
+}
+
+
+/**
+ * @brief - switches to the page table of process asid, like loading a new root pointer on a context
+ * switch. The first process takes over the existing root
+ * @param asid - address space id of the process being switched to
+ */
+bool PageTable::switchProcess(unsigned int asid)
+{
+    if (asid == currAsid) {
+        return false;
+    }
+
+    bool switched = currAsid != NO_ASID;
+    if (switched) {
+        contextSwitches++;
+    }
+    currAsid = asid;
+
+    std::map<unsigned int, Level*>::iterator root = processRoots.find(asid);
+    if (root != processRoots.end()) {
+        rootLevel = root->second;
+        backend = processBackends[asid];
+        return switched;
+    }
+
+    if (switched) {
+        if (createBackend != NULL) {
+            backend = createBackend();
+        }
+        else {
+            rootLevel = newLevel(0);
+        }
+    }
+    processRoots[asid] = rootLevel;
+    processBackends[asid] = backend;
+    return switched;
+}
+
+
+/**
+ * @brief - looks vpn up in the structure of process asid without making it current
+ * @param asid - process the page belongs to, NO_ASID for the current structure
+ * @param vpn - virtual page number to look up
+ * @return nullptr if the page isn't mapped or asid has no structure
+ */
+Map* PageTable::lookupIn(unsigned int asid, unsigned int vpn)
+{
+    if (asid == currAsid || asid == NO_ASID) {
+        return backend->lookup(vpn);
+    }
+    std::map<unsigned int, TranslationBackend*>::iterator other = processBackends.find(asid);
+    if (other == processBackends.end()) {
+        return nullptr;
+    }
+    if (other->second != this) {
+        return other->second->lookup(vpn);
+    }
+    return pageLookup(processRoots[asid], vpn << offsetShift);
+}
+
+
+/**
+ * @brief - unmaps vpn in the structure of process asid without making it current
+ * @param asid - process the page belongs to, NO_ASID for the current structure
+ * @param vpn - virtual page number to unmap
+ */
+bool PageTable::invalidateIn(unsigned int asid, unsigned int vpn)
+{
+    if (asid == currAsid || asid == NO_ASID) {
+        return backend->invalidate(vpn);
+    }
+    std::map<unsigned int, TranslationBackend*>::iterator other = processBackends.find(asid);
+    if (other == processBackends.end()) {
+        return false;
+    }
+    if (other->second != this) {
+        return other->second->invalidate(vpn);
+    }
+    return unmapPage(processRoots[asid], vpn);
+}
+
+
+/**
+ * @brief - bytes used by the translation structures of every process seen so far
+ */
+unsigned int PageTable::totalBytesUsed()
+{
+    if (createBackend == NULL || processBackends.empty()) {
+        return backend->bytesUsed();
+    }
+    unsigned int total = 0;
+    for (std::map<unsigned int, TranslationBackend*>::iterator it = processBackends.begin(); it != processBackends.end(); it++) {
+        total += it->second->bytesUsed();
+    }
+    return total;
+}
+
+
+/**
+ * @brief - TranslationBackend bytesUsed. Same value as numBytesSize
+ */
+unsigned int PageTable::bytesUsed()
+{
+    return numBytesSize;
+}
+
+
+/**
+ * @brief - TranslationBackend forEach. Visits every valid mapping in vpn order
+ * @param visit - called with (vpn, map) for each mapping
+ */
+void PageTable::forEach(const std::function<void(unsigned int, Map*)>& visit)
+{
+    forEachInLevel(rootLevel, 0, visit);
+}
+
+
+/**
+ * @brief - recursive helper for forEach. Builds up the vpn one level index at a time
+ * @param lvlPtr - Level* to the current level being worked with.
+ * @param vpnPrefix - page number bits of all the levels above lvlPtr
+ * @param visit - called with (vpn, map) for each mapping
+ */
+void PageTable::forEachInLevel(Level* lvlPtr, unsigned int vpnPrefix, const std::function<void(unsigned int, Map*)>& visit)
+{
+    unsigned int depth = lvlPtr->currDepth;
+    for (unsigned int i = 0; i < entryCountArr[depth]; i++) {
+        unsigned int vpn = (vpnPrefix << bitsInLevel[depth]) | i;
+        // go here if lvlPtr is a leaf node
+        if (depth == levelCount - 1) {
+            if (lvlPtr->mapPtr == nullptr) {
+                return;
+            }
+            if (lvlPtr->mapPtr[i].isValid()) {
+                visit(vpn, &lvlPtr->mapPtr[i]);
+            }
+        }
+        // go here if lvlPtr is interior node
+        else if (lvlPtr->nextLevel[i] != nullptr) {
+            forEachInLevel(lvlPtr->nextLevel[i], vpn, visit);
+        }
+    }
+}
+
+
+/**
+ * @brief - scalar version of (vaddr & mask) >> shift over a block of addresses
+ */
+static void maskAndShift(const uint32_t* vaddrs, size_t n, uint32_t mask, uint32_t shift, uint32_t* out)
+{
+    for (size_t i = 0; i < n; i++) {
+        out[i] = (vaddrs[i] & mask) >> shift;
+    }
+}
+
+#ifdef PAGETABLE_AVX2
+/**
+ * @brief - AVX2 version of maskAndShift, 8 addresses per instruction with a scalar tail
+ */
+__attribute__((target("avx2")))
+static void maskAndShiftAvx2(const uint32_t* vaddrs, size_t n, uint32_t mask, uint32_t shift, uint32_t* out)
+{
+    __m256i maskVec = _mm256_set1_epi32(mask);
+    __m128i shiftVec = _mm_cvtsi32_si128(shift);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i addrs = _mm256_loadu_si256((const __m256i*)(vaddrs + i));
+        addrs = _mm256_srl_epi32(_mm256_and_si256(addrs, maskVec), shiftVec);
+        _mm256_storeu_si256((__m256i*)(out + i), addrs);
+    }
+    maskAndShift(vaddrs + i, n - i, mask, shift, out + i);
+}
+#endif
+
+
+/**
+ * @brief - computes the page number of every level and the offset for a block of addresses.
+ * @param vaddrs - virtual addresses to split
+ * @param n - number of addresses
+ * @param pageNums - levelCount * n entries, pageNums[level * n + i] is the level index of vaddrs[i]
+ * @param offsets - n entries, offsets[i] is the page offset of vaddrs[i]. May be nullptr
+ */
+void PageTable::extractLevelIndices(const uint32_t* vaddrs, size_t n, uint32_t* pageNums, uint32_t* offsets)
+{
+#ifdef PAGETABLE_AVX2
+    static const bool haveAvx2 = __builtin_cpu_supports("avx2");
+    void (*extract)(const uint32_t*, size_t, uint32_t, uint32_t, uint32_t*) = haveAvx2 ? maskAndShiftAvx2 : maskAndShift;
+#else
+    void (*extract)(const uint32_t*, size_t, uint32_t, uint32_t, uint32_t*) = maskAndShift;
+#endif
+
+    for (unsigned int level = 0; level < levelCount; level++) {
+        extract(vaddrs, n, maskArr[level], shiftArr[level], pageNums + level * n);
+    }
+    if (offsets != nullptr) {
+        extract(vaddrs, n, offsetMask, 0, offsets);
+    }
+}
+
+
+/**
+ * @brief - translates a block of virtual addresses, inserting any page that isn't mapped yet just like
+ * processNextAddress does. Level indices are extracted for the whole block up front, then each walk
+ * prefetches the nodes that the address BATCH_PREFETCH_DISTANCE ahead will need. Other backends fall
+ * back to one lookupOrInsert per address.
+ * @param vaddrs - virtual addresses to translate, in trace order
+ * @param n - number of addresses
+ * @param pfns - filled with the frame number of each address
+ * @param hits - hits[i] is true if vaddrs[i] was already mapped (pageTable hit)
+ * @param physAddrs - filled with the physical address of each address. May be nullptr
+ */
+void PageTable::translateBatch(const uint32_t* vaddrs, size_t n, uint32_t* pfns, bool* hits, uint32_t* physAddrs)
+{
+    if (backend != this) {
+        for (size_t i = 0; i < n; i++) {
+            unsigned int vpn = vaddrs[i] >> offsetShift;
+            pfns[i] = backend->lookupOrInsert(vpn, nextFrame(vpn), &hits[i])->getFrameNum();
+            if (!hits[i]) {
+                takeFrame(vpn);
+            }
+            if (physAddrs != nullptr) {
+                physAddrs[i] = appendOffset(pfns[i], vaddrs[i]);
+            }
+        }
+        return;
+    }
+
+    batchPageNums.resize(levelCount * n);
+    batchOffsets.resize(n);
+    uint32_t* pageNums = batchPageNums.data();
+    extractLevelIndices(vaddrs, n, pageNums, physAddrs != nullptr ? batchOffsets.data() : nullptr);
+
+    unsigned int leafDepth = levelCount - 1;
+    for (size_t i = 0; i < n; i++) {
+        // prefetch the root slot far ahead and the level 1 slot half way there, once the root slot is likely cached
+        if (i + BATCH_PREFETCH_DISTANCE < n) {
+            size_t ahead = i + BATCH_PREFETCH_DISTANCE;
+            if (leafDepth == 0) {
+                if (rootLevel->mapPtr != nullptr) __builtin_prefetch(&rootLevel->mapPtr[pageNums[ahead]]);
+            }
+            else {
+                __builtin_prefetch(&rootLevel->nextLevel[pageNums[ahead]]);
+            }
+        }
+        if (leafDepth > 0 && i + BATCH_PREFETCH_DISTANCE / 2 < n) {
+            size_t ahead = i + BATCH_PREFETCH_DISTANCE / 2;
+            Level* child = rootLevel->nextLevel[pageNums[ahead]];
+            if (child != nullptr) {
+                if (leafDepth == 1) {
+                    if (child->mapPtr != nullptr) __builtin_prefetch(&child->mapPtr[pageNums[n + ahead]]);
+                }
+                else {
+                    __builtin_prefetch(&child->nextLevel[pageNums[n + ahead]]);
+                }
+            }
+        }
+
+        // walk using the precomputed indices
+        Level* lvlPtr = rootLevel;
+        for (unsigned int depth = 0; depth < leafDepth && lvlPtr != nullptr; depth++) {
+            lvlPtr = lvlPtr->nextLevel[pageNums[depth * n + i]];
+        }
+        Map* frame = nullptr;
+        if (lvlPtr != nullptr && lvlPtr->mapPtr != nullptr) {
+            frame = &lvlPtr->mapPtr[pageNums[leafDepth * n + i]];
+        }
+
+        hits[i] = (frame != nullptr && frame->isValid());
+        if (hits[i]) {
+            pfns[i] = frame->getFrameNum();
+        }
+        else {
+            unsigned int vpn = vaddrs[i] >> offsetShift;
+            pfns[i] = nextFrame(vpn);
+            pageInsert(rootLevel, vaddrs[i], pfns[i]);
+            takeFrame(vpn);
+        }
+        if (physAddrs != nullptr) {
+            physAddrs[i] = (pfns[i] << offsetShift) | batchOffsets[i];
+        }
+    }
 }
\ No newline at end of file
@@ -4,22 +4,39 @@
 #include "level.h"
 #include "tlb.h"
 #include "tracereader.h"
+#include "translationBackend.h"
+#include "frameTable.h"
+#include "frameAllocator.h"
+#include "faultAround.h"
+#include "nodeArena.h"
+#include <stddef.h>
+#include <vector>
+#include <map>
+#include <unordered_map>
 
 #define MEMORY_SPACE_SIZE 32
+#define TRANSLATE_BATCH_SIZE 256        // addresses per translateBatch call in the summary engine
+#define BATCH_PREFETCH_DISTANCE 8       // how many addresses ahead translateBatch prefetches
+#define NO_ASID 0xFFFFFFFF              // currAsid before the first switchProcess
 
+class Reclaimer;
+class ForkModel;
 
 
-
-
-class PageTable
+class PageTable : public TranslationBackend
 {
 public:
     // constructor
     PageTable(unsigned int, unsigned int*, int);
+    ~PageTable();       // frees every process's tree with the arena, and every other backend
 
     // ptr to root level
     Level* rootLevel;
 
+    // structure used for translation. Defaults to this multi-level tree, but can point at a
+    // HashedPageTable or InvertedPageTable. Geometry and counters always live in PageTable.
+    TranslationBackend* backend;
+
     // bit arrays and entryCountArr
     unsigned int* maskArr;
     unsigned int* shiftArr;
@@ -35,12 +52,52 @@ public:
     unsigned int frameCount;
     unsigned int vpnNumBits;
     unsigned int pageSizeBytes;
-    unsigned int currFrameNum;      // for the pageInsert function to know what frameNum to use
+    unsigned int currFrameNum;      // frames handed out so far, the next frameNum when sequential
+
+    // --frame-alloc policy. NULL hands frames out in order
+    FrameAllocator* allocator;
 
     // hit counts
     unsigned int countPageTableHits;
     unsigned int countTlbHits;
 
+    // --frames physical memory limit. NULL hands out a new frame for every page
+    FrameTable* frames;
+
+    // --fault-around / --readahead, pages mapped ahead on a fault. NULL maps only the faulting page
+    FaultAround* faultAround;
+
+    // node memory. Every Level and array of the tree comes from arena. With --reclaim, unmapping the
+    // last page of a leaf frees its Map array and every level left empty above it onto per depth
+    // freelists, and numBytesSize shrinks by what they were counted as
+    NodeArena* arena;
+    bool reclaim;
+    unsigned int peakBytes;                 // highest numBytesSize so far
+    unsigned long long levelsFreed;
+    unsigned long long leafArraysFreed;
+    unsigned long long bytesFreed;
+    unsigned long long nodesReused;         // levels and leaf arrays taken from the freelists
+    unsigned long long renumberPasses;
+
+    // --unmap, --renumber-every and --footprint-every, run before records. NULL for none
+    Reclaimer* reclaimer;
+
+    // --fork, processes created as copy-on-write copies of others. NULL for none. A forked process
+    // shares every level below its parent's root, and a level reachable from more than one parent
+    // level is in sharedLevels with the number of them. Inserting through a shared level or
+    // privateMap copies it first, so each process only pays for the levels on the paths it changed
+    ForkModel* forks;
+    std::unordered_map<Level*, unsigned int> sharedLevels;
+    unsigned long long levelsCopied;        // shared levels copied on write
+
+    // per-process translation structures for --asid. Each asid gets its own root level, or its own
+    // backend from createBackend when that is set. Frames come from the one physical pool
+    std::map<unsigned int, Level*> processRoots;
+    std::map<unsigned int, TranslationBackend*> processBackends;
+    TranslationBackend* (*createBackend)();     // NULL for the multi-level tree
+    unsigned int currAsid;
+    unsigned int contextSwitches;
+
     // set array, mask and shift methods
     void setMaskArr();
     void shiftMaskArr();      // helper fuction for setMaskArr
@@ -54,10 +111,73 @@ public:
     unsigned int virtualAddressToPageNum(unsigned int virtualAddress, unsigned int mask, unsigned int shift);
     unsigned int appendOffset(unsigned int frameNum, unsigned int virtualAddress);
 
+    // frame allocation. nextFrame is the frame a page fault on vpn by proc would get, takeFrame hands it out
+    unsigned int nextFrame(unsigned int vpn, unsigned int proc = 0)
+    {
+        return allocator == NULL ? currFrameNum : allocator->next(vpn, proc);
+    }
+    void takeFrame(unsigned int vpn, unsigned int proc = 0)
+    {
+        if (allocator != NULL) allocator->take(vpn, proc);
+        currFrameNum++;
+        frameCount++;
+    }
+
     // page walk methods
-    void pageInsert(Level* lvlPtr, unsigned int virtualAddress);
+    void pageInsert(Level* lvlPtr, unsigned int virtualAddress, unsigned int frameNum);
     Map* pageLookup(Level* lvlPtr, unsigned int virtualAddress);
 
+    // node allocation, from the freelists first and the arena otherwise. Both count numBytesSize
+    Level* newLevel(unsigned int depth);
+    void newMaps(Level* leaf);
+    // copies every process's tree depth first into a fresh arena, so nodes are laid out in vpn
+    // order, and drops the old arena with the freelists in it
+    void renumberNodes();
+
+    // makes process child a copy-on-write copy of process parent. false if parent has no page table
+    // yet or child already has one
+    bool forkProcess(unsigned int parent, unsigned int child);
+    // Map of vpn in the current process, with every shared level on the way copied. nullptr if unmapped
+    Map* privateMap(unsigned int vpn);
+    // bytes the tree under root would be counted as without sharing
+    unsigned long long unsharedBytes(Level* root);
+
+    // batch translation. Extracts every level index with AVX2 when the cpu has it, walks the tree
+    // with software prefetch and inserts missing pages. Updates currFrameNum and frameCount but
+    // leaves hit counting to the caller
+    void translateBatch(const uint32_t* vaddrs, size_t n, uint32_t* pfns, bool* hits, uint32_t* physAddrs = nullptr);
+    void extractLevelIndices(const uint32_t* vaddrs, size_t n, uint32_t* pageNums, uint32_t* offsets);
+
+    // makes asid's structure current, creating it on first use. Returns true if this switched away
+    // from another process
+    bool switchProcess(unsigned int asid);
+    unsigned int totalBytesUsed();      // bytes used by every process's structure
+    // lookup and invalidate in process asid's structure without switching to it, for --frames
+    // evictions of another process's page. NO_ASID is the current structure
+    Map* lookupIn(unsigned int asid, unsigned int vpn);
+    bool invalidateIn(unsigned int asid, unsigned int vpn);
+
+    // TranslationBackend methods for the multi-level tree
+    Map* lookup(unsigned int vpn);
+    Map* insert(unsigned int vpn, unsigned int frameNum);
+    bool invalidate(unsigned int vpn);
+    unsigned int bytesUsed();
+    void forEach(const std::function<void(unsigned int, Map*)>& visit);
+
+private:
+    std::vector<uint32_t> batchPageNums;    // scratch for translateBatch, level major
+    std::vector<uint32_t> batchOffsets;
+
+    std::vector<std::vector<Level*> > freeLevels;   // per depth
+    std::vector<Map*> freeMaps;                     // leaf arrays
+
+    unsigned int levelBytes(unsigned int depth);
+    bool unmapPage(Level* root, unsigned int vpn);
+    Level* copyLevel(Level* from);
+    Level* unshareChild(Level* parent, unsigned int index);
+
+    void forEachInLevel(Level* lvlPtr, unsigned int vpnPrefix, const std::function<void(unsigned int, Map*)>& visit);
+
 };
 
 
@@ -0,0 +1,154 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include "reclaim.h"
+#include "pageTable.h"
+
+
+/**
+ * @brief - constructor, nothing is due before the events are loaded but the first samples
+ * @param renumberEvery - records between renumber passes, 0 for none
+ * @param footprintEvery - records between footprint samples, 0 for none
+ */
+Reclaimer::Reclaimer(unsigned long long renumberEvery, unsigned long long footprintEvery)
+{
+    this->nextEvent = 0;
+    this->renumberEvery = renumberEvery;
+    this->footprintEvery = footprintEvery;
+    this->pagesUnmapped = 0;
+    this->arenaBytesReleased = 0;
+    this->nextRenumber = renumberEvery > 0 ? renumberEvery : ~0ULL;
+    this->nextSample = footprintEvery > 0 ? 0 : ~0ULL;
+    this->nextDue = 0;
+}
+
+
+/**
+ * @brief - runs everything due before record and works out when the next thing is. Unmapped pages
+ * leave the -c TLB and the prefetch buffer with their mapping, and fault in again on their next use
+ * @param pTable - pageTable of the run, its current process owns the unmapped pages
+ * @param cache - -c TLB, may be NULL
+ * @param record - simulated records so far
+ */
+void Reclaimer::runDue(PageTable* pTable, tlb* cache, unsigned long long record)
+{
+    while (nextEvent < events.size() && events[nextEvent].record <= record) {
+        Event* event = &events[nextEvent++];
+        for (unsigned long long page = event->vpn; page < (unsigned long long)event->vpn + event->pages; page++) {
+            if (!pTable->backend->invalidate(page)) {
+                continue;
+            }
+            pagesUnmapped++;
+            if (pTable->faultAround != NULL) {
+                pTable->faultAround->evicted(((unsigned long long)pTable->currAsid << ASID_SHIFT) | page);
+            }
+            if (cache != NULL) {
+                cache->invalidate(page);
+                if (cache->prefetcher != NULL) {
+                    cache->prefetcher->invalidate(page);
+                }
+            }
+        }
+    }
+    if (record >= nextRenumber) {
+        size_t reserved = pTable->arena->reservedBytes;
+        pTable->renumberNodes();
+        arenaBytesReleased += reserved - std::min(reserved, pTable->arena->reservedBytes);
+        nextRenumber = record - record % renumberEvery + renumberEvery;
+    }
+    if (record >= nextSample) {
+        samples.push_back(std::make_pair(record, pTable->numBytesSize));
+        nextSample = record - record % footprintEvery + footprintEvery;
+    }
+    nextDue = std::min(nextRenumber, nextSample);
+    if (nextEvent < events.size()) {
+        nextDue = std::min(nextDue, events[nextEvent].record);
+    }
+}
+
+
+/**
+ * @brief - prints the page table's current and peak bytes, what --reclaim freed and reused, the
+ * arena, and the unmaps, renumber passes and footprint samples of the run
+ */
+void Reclaimer::report(PageTable* pTable)
+{
+    printf("Page table footprint: current: %u bytes, peak: %u bytes, arena reserved: %zu bytes, allocated: %zu bytes\n",
+        pTable->numBytesSize, pTable->peakBytes, pTable->arena->reservedBytes, pTable->arena->allocatedBytes);
+    if (!events.empty()) {
+        printf("  Unmap events: %zu, pages unmapped: %llu\n", nextEvent, pagesUnmapped);
+    }
+    if (pTable->reclaim) {
+        printf("  Reclaimed: levels: %llu, leaf arrays: %llu, bytes: %llu, reused from freelists: %llu\n",
+            pTable->levelsFreed, pTable->leafArraysFreed, pTable->bytesFreed, pTable->nodesReused);
+    }
+    if (renumberEvery > 0) {
+        printf("  Renumber passes: %llu, arena bytes released: %llu\n", pTable->renumberPasses, arenaBytesReleased);
+    }
+    for (size_t i = 0; i < samples.size(); i++) {
+        printf("  Records %llu: %u bytes\n", samples[i].first, samples[i].second);
+    }
+    fflush(stdout);
+}
+
+
+/**
+ * @brief - reads an --unmap file of "record vpn [pages]" lines, sorted by record. vpn may be given
+ * in hex with 0x. Blank lines and # comments are skipped
+ * @param numPages - pages in the vpn space, every range must lie within it
+ * @return false after printing why if the file can't be read, a line is malformed or a range is out of the vpn space
+ */
+static bool loadUnmaps(const char* path, unsigned long long numPages, std::vector<Reclaimer::Event>* events)
+{
+    FILE* in = fopen(path, "r");
+    if (in == NULL) {
+        fprintf(stderr, "Unable to open unmap events %s\n", path);
+        return false;
+    }
+    char line[256];
+    unsigned int lineNum = 0;
+    while (fgets(line, sizeof(line), in) != NULL) {
+        lineNum++;
+        char first[2];
+        if (sscanf(line, " %1s", first) != 1 || first[0] == '#') {
+            continue;
+        }
+        Reclaimer::Event event;
+        char vpn[24] = "";
+        int pages = 1;
+        int fields = sscanf(line, "%llu %23s %d", &event.record, vpn, &pages);
+        char* end;
+        unsigned long long start = strtoull(vpn, &end, 0);
+        if (fields < 2 || *end != '\0' || pages < 1) {
+            fprintf(stderr, "%s:%u: expected \"record vpn [pages]\" with at least 1 page\n", path, lineNum);
+            fclose(in);
+            return false;
+        }
+        // vpns past the vpn space would alias onto low pages once shifted into an address
+        if (start >= numPages || (unsigned long long)pages > numPages - start) {
+            fprintf(stderr, "%s:%u: pages past the %llu page vpn space\n", path, lineNum, numPages);
+            fclose(in);
+            return false;
+        }
+        event.vpn = (unsigned int)start;
+        event.pages = pages;
+        events->push_back(event);
+    }
+    fclose(in);
+    std::stable_sort(events->begin(), events->end(),
+        [](const Reclaimer::Event& a, const Reclaimer::Event& b) { return a.record < b.record; });
+    return true;
+}
+
+
+Reclaimer* createReclaimer(const char* unmapPath, unsigned long long numPages, unsigned long long renumberEvery,
+    unsigned long long footprintEvery)
+{
+    Reclaimer* reclaimer = new Reclaimer(renumberEvery, footprintEvery);
+    if (unmapPath != NULL && !loadUnmaps(unmapPath, numPages, &reclaimer->events)) {
+        delete reclaimer;
+        return NULL;
+    }
+    return reclaimer;
+}
@@ -0,0 +1,64 @@
+#ifndef RECLAIM
+#define RECLAIM
+
+#include <vector>
+#include "tlb.h"
+
+class PageTable;
+
+
+/**
+ * @brief - page table memory over a run. --unmap events unmap ranges of pages of the current
+ * process, through the pageTable so --reclaim can free the nodes they empty, and out of the -c TLB.
+ * --renumber-every copies the live tree to a fresh arena every N records, and --footprint-every
+ * samples the page table bytes every N records. All of it runs before simulated records, in
+ * readAddresses, and costs one compare per record when nothing is due.
+ */
+class Reclaimer
+{
+public:
+    Reclaimer(unsigned long long renumberEvery, unsigned long long footprintEvery);
+
+    // runs the unmap events, renumber pass and footprint sample due before simulated record number record
+    void beforeRecord(PageTable* pTable, tlb* cache, unsigned long long record)
+    {
+        if (record >= nextDue) {
+            runDue(pTable, cache, record);
+        }
+    }
+
+    void report(PageTable* pTable);
+
+    struct Event
+    {
+        unsigned long long record;      // simulated records before the event
+        unsigned int vpn;               // first page of the range
+        unsigned int pages;
+    };
+
+    std::vector<Event> events;          // --unmap in record order
+    size_t nextEvent;
+    unsigned long long renumberEvery;   // 0 for never
+    unsigned long long footprintEvery;  // 0 for never
+
+    // statistics
+    unsigned long long pagesUnmapped;               // pages the events found mapped
+    unsigned long long arenaBytesReleased;          // reserved arena bytes renumber passes gave back
+    std::vector<std::pair<unsigned long long, unsigned int> > samples;     // (record, page table bytes)
+
+private:
+    unsigned long long nextDue;         // lowest record anything is due at
+    unsigned long long nextRenumber;
+    unsigned long long nextSample;
+
+    void runDue(PageTable* pTable, tlb* cache, unsigned long long record);
+};
+
+
+// creates a Reclaimer. unmapPath names a file of "record vpn [pages]" lines and may be NULL, every
+// range must lie within the numPages pages of the vpn space. Returns NULL after printing why if the
+// file can't be read or a range doesn't
+Reclaimer* createReclaimer(const char* unmapPath, unsigned long long numPages, unsigned long long renumberEvery,
+    unsigned long long footprintEvery);
+
+#endif
@@ -0,0 +1,316 @@
+#include <string.h>
+#include "replacementPolicy.h"
+
+#define NO_SLOT -1
+
+
+/**
+ * @brief - constructor, every slot starts off the list
+ * @param numSlots - number of slots managed
+ * @param moveOnHit - true for LRU, false for FIFO
+ */
+ListPolicy::ListPolicy(unsigned int numSlots, bool moveOnHit)
+{
+    this->prev.assign(numSlots, NO_SLOT);
+    this->next.assign(numSlots, NO_SLOT);
+    this->head = NO_SLOT;
+    this->tail = NO_SLOT;
+    this->moveOnHit = moveOnHit;
+}
+
+void ListPolicy::unlink(unsigned int slot)
+{
+    if (prev[slot] != NO_SLOT) next[prev[slot]] = next[slot];
+    else head = next[slot];
+    if (next[slot] != NO_SLOT) prev[next[slot]] = prev[slot];
+    else tail = prev[slot];
+    prev[slot] = NO_SLOT;
+    next[slot] = NO_SLOT;
+}
+
+void ListPolicy::pushBack(unsigned int slot)
+{
+    prev[slot] = tail;
+    next[slot] = NO_SLOT;
+    if (tail != NO_SLOT) next[tail] = slot;
+    else head = slot;
+    tail = slot;
+}
+
+void ListPolicy::onInsert(unsigned int slot)
+{
+    pushBack(slot);
+}
+
+void ListPolicy::onHit(unsigned int slot)
+{
+    if (moveOnHit) {
+        unlink(slot);
+        pushBack(slot);
+    }
+}
+
+void ListPolicy::onRemove(unsigned int slot)
+{
+    unlink(slot);
+}
+
+unsigned int ListPolicy::victim()
+{
+    return head;
+}
+
+
+/**
+ * @brief - constructor seeds the generator
+ * @param numSlots - number of slots managed
+ * @param seed - rng seed
+ */
+RandomPolicy::RandomPolicy(unsigned int numSlots, unsigned int seed) : rng(seed)
+{
+    this->numSlots = numSlots;
+}
+
+unsigned int RandomPolicy::victim()
+{
+    return rng() % numSlots;
+}
+
+
+/**
+ * @brief - constructor, hand starts at slot 0
+ * @param numSlots - number of slots managed
+ */
+ClockPolicy::ClockPolicy(unsigned int numSlots)
+{
+    this->referenced.assign(numSlots, false);
+    this->occupied.assign(numSlots, false);
+    this->hand = 0;
+}
+
+void ClockPolicy::onInsert(unsigned int slot)
+{
+    occupied[slot] = true;
+    referenced[slot] = true;
+}
+
+void ClockPolicy::onHit(unsigned int slot)
+{
+    referenced[slot] = true;
+}
+
+void ClockPolicy::onRemove(unsigned int slot)
+{
+    occupied[slot] = false;
+    referenced[slot] = false;
+}
+
+/**
+ * @brief - advances the hand, giving referenced slots a second chance. The hand stops on the
+ * victim, which will be refilled, so the next sweep starts just past it.
+ */
+unsigned int ClockPolicy::victim()
+{
+    while (!occupied[hand] || referenced[hand]) {
+        referenced[hand] = false;
+        hand = (hand + 1) % occupied.size();
+    }
+    unsigned int slot = hand;
+    hand = (hand + 1) % occupied.size();
+    return slot;
+}
+
+
+/**
+ * @brief - constructor, every list starts empty
+ * @param numSlots - number of slots managed
+ * @param bimodal - true for BRRIP, false for SRRIP
+ * @param seed - rng seed for BRRIP's insertion choice
+ */
+RripPolicy::RripPolicy(unsigned int numSlots, bool bimodal, unsigned int seed) : rng(seed)
+{
+    this->prev.assign(numSlots, NO_SLOT);
+    this->next.assign(numSlots, NO_SLOT);
+    this->bucketOf.assign(numSlots, 0);
+    for (int i = 0; i <= RRPV_MAX; i++) {
+        head[i] = NO_SLOT;
+        tail[i] = NO_SLOT;
+    }
+    this->base = 0;
+    this->bimodal = bimodal;
+}
+
+void RripPolicy::unlink(unsigned int slot)
+{
+    int b = bucketOf[slot];
+    if (prev[slot] != NO_SLOT) next[prev[slot]] = next[slot];
+    else head[b] = next[slot];
+    if (next[slot] != NO_SLOT) prev[next[slot]] = prev[slot];
+    else tail[b] = prev[slot];
+    prev[slot] = NO_SLOT;
+    next[slot] = NO_SLOT;
+}
+
+void RripPolicy::pushBack(unsigned int slot, unsigned int rrpv)
+{
+    int b = (rrpv + base) & RRPV_MAX;
+    bucketOf[slot] = b;
+    prev[slot] = tail[b];
+    next[slot] = NO_SLOT;
+    if (tail[b] != NO_SLOT) next[tail[b]] = slot;
+    else head[b] = slot;
+    tail[b] = slot;
+}
+
+void RripPolicy::onInsert(unsigned int slot)
+{
+    bool distant = bimodal && (rng() % BRRIP_LONG_CHANCE) != 0;
+    pushBack(slot, distant ? RRPV_MAX : RRPV_MAX - 1);
+}
+
+void RripPolicy::onHit(unsigned int slot)
+{
+    // already near-immediate: keep its place so repeat hits leave the policy unchanged
+    if (bucketOf[slot] == (int)(base & RRPV_MAX)) {
+        return;
+    }
+    unlink(slot);
+    pushBack(slot, 0);
+}
+
+void RripPolicy::onRemove(unsigned int slot)
+{
+    unlink(slot);
+}
+
+/**
+ * @brief - returns the oldest slot at RRPV_MAX. If there is none every RRPV is incremented by
+ * moving base, which takes at most RRPV_MAX steps since some list is non empty.
+ */
+unsigned int RripPolicy::victim()
+{
+    while (head[(RRPV_MAX + base) & RRPV_MAX] == NO_SLOT) {
+        base = (base - 1) & RRPV_MAX;
+    }
+    return head[(RRPV_MAX + base) & RRPV_MAX];
+}
+
+
+/**
+ * @brief - lower count first, then least recently used, then slot number so keys are unique
+ */
+bool LfuPolicy::Key::operator<(const Key& other) const
+{
+    if (count != other.count) return count < other.count;
+    if (lastUse != other.lastUse) return lastUse < other.lastUse;
+    return slot < other.slot;
+}
+
+
+/**
+ * @brief - constructor
+ * @param numSlots - number of slots managed
+ */
+LfuPolicy::LfuPolicy(unsigned int numSlots)
+{
+    Key empty;
+    empty.count = 0;
+    empty.lastUse = 0;
+    empty.slot = 0;
+    this->keys.assign(numSlots, empty);
+    this->occupied.assign(numSlots, false);
+    this->clock = 0;
+    this->agingPeriod = (unsigned long long)numSlots * LFU_AGING_FACTOR;
+}
+
+/**
+ * @brief - halves every count. Runs once per agingPeriod accesses so its O(n log n) cost is
+ * O(log n) per access
+ */
+void LfuPolicy::age()
+{
+    order.clear();
+    for (unsigned int i = 0; i < keys.size(); i++) {
+        if (!occupied[i]) continue;
+        keys[i].count /= 2;
+        order.insert(keys[i]);
+    }
+}
+
+/**
+ * @brief - re-keys slot after an insert (count restarts at 1) or a hit (count + 1)
+ */
+void LfuPolicy::touch(unsigned int slot, bool hit)
+{
+    clock++;
+    if (occupied[slot]) {
+        order.erase(keys[slot]);
+    }
+    occupied[slot] = true;
+    keys[slot].count = hit ? keys[slot].count + 1 : 1;
+    keys[slot].lastUse = clock;
+    keys[slot].slot = slot;
+    order.insert(keys[slot]);
+
+    if (clock % agingPeriod == 0) {
+        age();
+    }
+}
+
+void LfuPolicy::onInsert(unsigned int slot)
+{
+    touch(slot, false);
+}
+
+void LfuPolicy::onHit(unsigned int slot)
+{
+    touch(slot, true);
+}
+
+void LfuPolicy::onRemove(unsigned int slot)
+{
+    if (occupied[slot]) {
+        order.erase(keys[slot]);
+        occupied[slot] = false;
+    }
+}
+
+unsigned int LfuPolicy::victim()
+{
+    return order.begin()->slot;
+}
+
+
+static const char* policyNames[] = { "lru", "fifo", "random", "clock", "srrip", "brrip", "lfu" };
+
+
+/**
+ * @brief - true if name is a known replacement policy
+ * @param name - policy name from the command line
+ */
+bool isReplacementPolicy(const char* name)
+{
+    for (unsigned int i = 0; i < sizeof(policyNames) / sizeof(policyNames[0]); i++) {
+        if (strcmp(name, policyNames[i]) == 0) return true;
+    }
+    return false;
+}
+
+
+/**
+ * @brief - factory for the replacement policies
+ * @param name - lru, fifo, random, clock, srrip, brrip or lfu
+ * @param numSlots - number of slots the policy manages
+ * @param seed - rng seed for random and brrip
+ */
+ReplacementPolicy* createReplacementPolicy(const char* name, unsigned int numSlots, unsigned int seed)
+{
+    if (strcmp(name, "lru") == 0) return new ListPolicy(numSlots, true);
+    if (strcmp(name, "fifo") == 0) return new ListPolicy(numSlots, false);
+    if (strcmp(name, "random") == 0) return new RandomPolicy(numSlots, seed);
+    if (strcmp(name, "clock") == 0) return new ClockPolicy(numSlots);
+    if (strcmp(name, "srrip") == 0) return new RripPolicy(numSlots, false, seed);
+    if (strcmp(name, "brrip") == 0) return new RripPolicy(numSlots, true, seed);
+    if (strcmp(name, "lfu") == 0) return new LfuPolicy(numSlots);
+    return NULL;
+}
@@ -0,0 +1,165 @@
+#ifndef REPLACEMENTPOLICY
+#define REPLACEMENTPOLICY
+
+#include <vector>
+#include <set>
+#include <random>
+
+#define RRPV_MAX 3                  // 2 bit re-reference prediction values for SRRIP/BRRIP
+#define BRRIP_LONG_CHANCE 32        // BRRIP inserts with a long (not distant) RRPV 1 in this many times
+#define LFU_AGING_FACTOR 8          // LFU halves every count after this many accesses per slot
+
+
+/**
+ * @brief - replacement policy over a fixed number of slots numbered 0..numSlots-1. The owner keeps
+ * the actual entries and tells the policy when a slot is filled, hit or emptied. victim is only
+ * called when every slot is filled, and only to evict: it may age the policy's state on the way,
+ * as CLOCK clears reference bits and advances its hand and RRIP ages every slot, so it is not a
+ * query. The owner follows it with onRemove and onInsert for the slot it reuses. Every policy is
+ * O(1) or O(log n) per call.
+ */
+class ReplacementPolicy
+{
+public:
+    virtual ~ReplacementPolicy() {}
+    virtual void onInsert(unsigned int slot) = 0;
+    virtual void onHit(unsigned int slot) = 0;
+    virtual void onRemove(unsigned int slot) = 0;
+    virtual unsigned int victim() = 0;
+};
+
+
+/**
+ * @brief - LRU and FIFO. Slots are kept on an intrusive doubly linked list from oldest to newest.
+ * LRU moves a slot to the newest end on every hit, FIFO only on insert.
+ */
+class ListPolicy : public ReplacementPolicy
+{
+public:
+    ListPolicy(unsigned int numSlots, bool moveOnHit);
+    void onInsert(unsigned int slot);
+    void onHit(unsigned int slot);
+    void onRemove(unsigned int slot);
+    unsigned int victim();
+
+private:
+    std::vector<int> prev;
+    std::vector<int> next;
+    int head;       // oldest
+    int tail;       // newest
+    bool moveOnHit;
+
+    void unlink(unsigned int slot);
+    void pushBack(unsigned int slot);
+};
+
+
+/**
+ * @brief - evicts a uniformly random slot. Seeded so runs are repeatable
+ */
+class RandomPolicy : public ReplacementPolicy
+{
+public:
+    RandomPolicy(unsigned int numSlots, unsigned int seed);
+    void onInsert(unsigned int) {}
+    void onHit(unsigned int) {}
+    void onRemove(unsigned int) {}
+    unsigned int victim();
+
+private:
+    unsigned int numSlots;
+    std::mt19937 rng;
+};
+
+
+/**
+ * @brief - CLOCK second chance. A hand sweeps the slots, clearing reference bits until it finds a
+ * slot that was not referenced since the last sweep
+ */
+class ClockPolicy : public ReplacementPolicy
+{
+public:
+    ClockPolicy(unsigned int numSlots);
+    void onInsert(unsigned int slot);
+    void onHit(unsigned int slot);
+    void onRemove(unsigned int slot);
+    unsigned int victim();
+
+private:
+    std::vector<bool> referenced;
+    std::vector<bool> occupied;
+    unsigned int hand;
+};
+
+
+/**
+ * @brief - SRRIP and BRRIP (Jaleel et al.). Each slot has a 2 bit RRPV, hits reset it to 0 and the
+ * victim is a slot at RRPV_MAX. SRRIP inserts at RRPV_MAX - 1, BRRIP inserts at RRPV_MAX except
+ * for 1 in BRRIP_LONG_CHANCE inserts. Slots live on one list per RRPV, and aging every slot by one
+ * just rotates which list stands for which RRPV, so nothing is ever scanned.
+ */
+class RripPolicy : public ReplacementPolicy
+{
+public:
+    RripPolicy(unsigned int numSlots, bool bimodal, unsigned int seed);
+    void onInsert(unsigned int slot);
+    void onHit(unsigned int slot);
+    void onRemove(unsigned int slot);
+    unsigned int victim();
+
+private:
+    std::vector<int> prev;
+    std::vector<int> next;
+    std::vector<unsigned char> bucketOf;    // physical list a slot is on
+    int head[RRPV_MAX + 1];                 // one list per physical bucket, oldest first
+    int tail[RRPV_MAX + 1];
+    unsigned int base;                      // rrpv of physical bucket b is (b - base) & RRPV_MAX
+    bool bimodal;
+    std::mt19937 rng;
+
+    void unlink(unsigned int slot);
+    void pushBack(unsigned int slot, unsigned int rrpv);
+};
+
+
+/**
+ * @brief - LFU with aging. Slots are ordered by (count, last use) in a std::set, so the victim is
+ * the least frequently used slot with ties going to the least recently used. Every
+ * LFU_AGING_FACTOR * numSlots accesses all counts are halved so old popularity decays.
+ */
+class LfuPolicy : public ReplacementPolicy
+{
+public:
+    LfuPolicy(unsigned int numSlots);
+    void onInsert(unsigned int slot);
+    void onHit(unsigned int slot);
+    void onRemove(unsigned int slot);
+    unsigned int victim();
+
+private:
+    struct Key
+    {
+        unsigned long long count;
+        unsigned long long lastUse;
+        unsigned int slot;
+        bool operator<(const Key& other) const;
+    };
+
+    std::vector<Key> keys;
+    std::vector<bool> occupied;
+    std::set<Key> order;
+    unsigned long long clock;
+    unsigned long long agingPeriod;
+
+    void touch(unsigned int slot, bool hit);
+    void age();
+};
+
+
+// true if name is one of the policies createReplacementPolicy knows
+bool isReplacementPolicy(const char* name);
+
+// creates the policy called name (lru, fifo, random, clock, srrip, brrip, lfu). NULL if unknown
+ReplacementPolicy* createReplacementPolicy(const char* name, unsigned int numSlots, unsigned int seed);
+
+#endif
@@ -0,0 +1,298 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <utime.h>
+#include <sys/stat.h>
+#include <algorithm>
+#include <vector>
+#include "resultCache.h"
+
+#define HASH_PRIME1 0x9E3779B185EBCA87ULL
+#define HASH_PRIME2 0xC2B2AE3D27D4EB4FULL
+
+
+static inline uint64_t rotl64(uint64_t x, int r)
+{
+    return (x << r) | (x >> (64 - r));
+}
+
+
+/**
+ * @brief - mixes len bytes into seed 8 at a time. A tail shorter than 8 bytes is zero padded, so
+ * only the last piece of a stream may have one
+ * @param data - bytes to hash
+ * @param len - number of bytes
+ * @param seed - 0, a seed, or the return value for the previous piece of the stream
+ */
+uint64_t hash64(const void* data, size_t len, uint64_t seed)
+{
+    const unsigned char* bytes = (const unsigned char*)data;
+    uint64_t hash = seed;
+    size_t i = 0;
+    for (; i + 8 <= len; i += 8) {
+        uint64_t word;
+        memcpy(&word, bytes + i, 8);
+        hash = rotl64(hash ^ (word * HASH_PRIME2), 31) * HASH_PRIME1;
+    }
+    if (i < len) {
+        uint64_t word = 0;
+        memcpy(&word, bytes + i, len - i);
+        hash = rotl64(hash ^ (word * HASH_PRIME2), 31) * HASH_PRIME1;
+    }
+    return hash;
+}
+
+
+/**
+ * @brief - folds the stream length in and avalanches the bits of a hash64 result
+ */
+uint64_t hashFinish(uint64_t hash, uint64_t totalLen)
+{
+    hash ^= totalLen * HASH_PRIME1;
+    hash ^= hash >> 33;
+    hash *= 0xFF51AFD7ED558CCDULL;
+    hash ^= hash >> 33;
+    hash *= 0xC4CEB9FE1A85EC53ULL;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+
+std::string defaultCacheDir()
+{
+    const char* xdg = getenv("XDG_CACHE_HOME");
+    if (xdg != NULL && xdg[0] != '\0') {
+        return std::string(xdg) + "/" RESULT_CACHE_SUBDIR;
+    }
+    const char* home = getenv("HOME");
+    if (home != NULL && home[0] != '\0') {
+        return std::string(home) + "/.cache/" RESULT_CACHE_SUBDIR;
+    }
+    return "";
+}
+
+
+/**
+ * @brief - creates path and any missing parents, like mkdir -p
+ * @return true if path is a directory afterwards
+ */
+static bool makeDirs(const std::string& path)
+{
+    for (size_t slash = path.find('/', 1); ; slash = path.find('/', slash + 1)) {
+        std::string prefix = path.substr(0, slash);
+        if (mkdir(prefix.c_str(), 0755) != 0 && errno != EEXIST) {
+            return false;
+        }
+        if (slash == std::string::npos) {
+            break;
+        }
+    }
+    struct stat info;
+    return stat(path.c_str(), &info) == 0 && S_ISDIR(info.st_mode);
+}
+
+
+/**
+ * @brief - constructor, creates the cache directory
+ * @param dir - directory holding the results and the digests file
+ * @param maxEntries - results kept, at least 1
+ */
+ResultCache::ResultCache(const char* dir, unsigned int maxEntries)
+{
+    this->dir = dir;
+    this->maxEntries = maxEntries;
+    this->usable = !this->dir.empty() && makeDirs(this->dir);
+}
+
+
+std::string ResultCache::resultPath(uint64_t key)
+{
+    char name[32];
+    snprintf(name, sizeof(name), "/%016llx.result", (unsigned long long)key);
+    return dir + name;
+}
+
+
+/**
+ * @brief - content digest of the file at path. A digest already computed for the same device,
+ * inode, size and mtime is read from the digests file, otherwise the file is hashed in
+ * DIGEST_BLOCK_BYTES blocks and the digest is remembered, replacing any older one for the file
+ * @param path - trace file
+ * @param digest - set to the digest
+ */
+bool ResultCache::traceDigest(const char* path, uint64_t* digest)
+{
+    struct stat info;
+    if (stat(path, &info) != 0) {
+        return false;
+    }
+    unsigned long long dev = info.st_dev;
+    unsigned long long ino = info.st_ino;
+    unsigned long long size = info.st_size;
+    long long mtime = (long long)info.st_mtim.tv_sec * 1000000000LL + info.st_mtim.tv_nsec;
+
+    // lines of "dev ino size mtime digest"
+    std::string digestsPath = dir + "/digests";
+    std::vector<std::string> kept;
+    FILE* in = usable ? fopen(digestsPath.c_str(), "r") : NULL;
+    if (in != NULL) {
+        char line[256];
+        while (fgets(line, sizeof(line), in) != NULL) {
+            unsigned long long lineDev, lineIno, lineSize, lineDigest;
+            long long lineMtime;
+            if (sscanf(line, "%llu %llu %llu %lld %llx", &lineDev, &lineIno, &lineSize, &lineMtime, &lineDigest) != 5) {
+                continue;
+            }
+            if (lineDev == dev && lineIno == ino) {
+                if (lineSize == size && lineMtime == mtime) {
+                    *digest = lineDigest;
+                    fclose(in);
+                    return true;
+                }
+                continue;       // stale, the file changed
+            }
+            kept.push_back(line);
+        }
+        fclose(in);
+    }
+
+    FILE* trace = fopen(path, "rb");
+    if (trace == NULL) {
+        return false;
+    }
+    std::vector<unsigned char> block(DIGEST_BLOCK_BYTES);
+    uint64_t hash = 0;
+    uint64_t total = 0;
+    size_t got;
+    while ((got = fread(block.data(), 1, block.size(), trace)) > 0) {
+        hash = hash64(block.data(), got, hash);
+        total += got;
+    }
+    fclose(trace);
+    *digest = hashFinish(hash, total);
+
+    if (usable) {
+        std::string tmpPath = digestsPath + ".tmp." + std::to_string(getpid());
+        FILE* out = fopen(tmpPath.c_str(), "w");
+        if (out != NULL) {
+            for (size_t i = 0; i < kept.size(); i++) {
+                fputs(kept[i].c_str(), out);
+            }
+            fprintf(out, "%llu %llu %llu %lld %016llx\n", dev, ino, size, mtime, (unsigned long long)*digest);
+            fclose(out);
+            rename(tmpPath.c_str(), digestsPath.c_str());
+        }
+    }
+    return true;
+}
+
+
+/**
+ * @brief - reads the result stored under key and marks it recently used
+ * @return false if there is none
+ */
+bool ResultCache::lookup(uint64_t key, SummaryResult* result)
+{
+    if (!usable) {
+        return false;
+    }
+    std::string path = resultPath(key);
+    FILE* in = fopen(path.c_str(), "r");
+    if (in == NULL) {
+        return false;
+    }
+    bool found = fscanf(in, "%u %u %u %u %u %u", &result->pageSize, &result->tlbHits, &result->pageTableHits,
+        &result->addresses, &result->frames, &result->bytes) == 6;
+    fclose(in);
+    if (found) {
+        utime(path.c_str(), NULL);
+    }
+    return found;
+}
+
+
+/**
+ * @brief - stores result under key, written to a temporary file and renamed so concurrent runs
+ * never read half a result, then evicts down to maxEntries
+ * @param description - the trace and configuration, kept in the file for whoever looks at it
+ */
+void ResultCache::store(uint64_t key, const SummaryResult& result, const std::string& description)
+{
+    if (!usable) {
+        return;
+    }
+    std::string path = resultPath(key);
+    std::string tmpPath = path + ".tmp." + std::to_string(getpid());
+    FILE* out = fopen(tmpPath.c_str(), "w");
+    if (out == NULL) {
+        return;
+    }
+    fprintf(out, "%u %u %u %u %u %u\n# %s\n", result.pageSize, result.tlbHits, result.pageTableHits,
+        result.addresses, result.frames, result.bytes, description.c_str());
+    fclose(out);
+    rename(tmpPath.c_str(), path.c_str());
+    evict();
+}
+
+
+/**
+ * @brief - removes the least recently used results beyond maxEntries
+ */
+void ResultCache::evict()
+{
+    DIR* listing = opendir(dir.c_str());
+    if (listing == NULL) {
+        return;
+    }
+    std::vector<std::pair<long long, std::string> > results;       // (mtime, path)
+    struct dirent* entry;
+    while ((entry = readdir(listing)) != NULL) {
+        size_t len = strlen(entry->d_name);
+        if (len < 7 || strcmp(entry->d_name + len - 7, ".result") != 0) {
+            continue;
+        }
+        std::string path = dir + "/" + entry->d_name;
+        struct stat info;
+        if (stat(path.c_str(), &info) == 0) {
+            results.push_back(std::make_pair((long long)info.st_mtim.tv_sec * 1000000000LL + info.st_mtim.tv_nsec, path));
+        }
+    }
+    closedir(listing);
+
+    if (results.size() <= maxEntries) {
+        return;
+    }
+    std::sort(results.begin(), results.end());
+    for (size_t i = 0; i < results.size() - maxEntries; i++) {
+        unlink(results[i].second.c_str());
+    }
+}
+
+
+/**
+ * @brief - --cache-clear, removes every result and the digests file
+ */
+unsigned int ResultCache::clear()
+{
+    unsigned int removed = 0;
+    if (!usable) {
+        return removed;
+    }
+    DIR* listing = opendir(dir.c_str());
+    if (listing == NULL) {
+        return removed;
+    }
+    struct dirent* entry;
+    while ((entry = readdir(listing)) != NULL) {
+        size_t len = strlen(entry->d_name);
+        if (len >= 7 && strcmp(entry->d_name + len - 7, ".result") == 0) {
+            removed += unlink((dir + "/" + entry->d_name).c_str()) == 0;
+        }
+    }
+    closedir(listing);
+    unlink((dir + "/digests").c_str());
+    return removed;
+}
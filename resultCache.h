@@ -0,0 +1,66 @@
+#ifndef RESULTCACHE
+#define RESULTCACHE
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+
+#define RESULT_CACHE_VERSION 1          // bump when a change alters the results of a cached configuration
+#define DEFAULT_CACHE_ENTRIES 1000      // results kept before the least recently used are evicted
+#define RESULT_CACHE_SUBDIR "pagingwithtlb"
+#define DIGEST_BLOCK_BYTES (1 << 20)    // bytes hashed per read
+
+
+/*
+ * the numbers report_summary prints
+ */
+typedef struct {
+    unsigned int pageSize;
+    unsigned int tlbHits;
+    unsigned int pageTableHits;
+    unsigned int addresses;
+    unsigned int frames;
+    unsigned int bytes;
+} SummaryResult;
+
+
+/**
+ * @brief - on-disk cache of summary results, one small text file per result named after its key.
+ * The key hashes the normalized configuration with a digest of the trace file's contents, so a
+ * renamed or copied trace still hits and an edited one misses. Digests are remembered in a
+ * digests file by device, inode, size and mtime, so an unchanged trace isn't read again.
+ * Every hit refreshes the result's mtime, and storing a result evicts the least recently used ones
+ * beyond maxEntries.
+ */
+class ResultCache
+{
+public:
+    // dir is created if it doesn't exist. usable is false if it can't be
+    ResultCache(const char* dir, unsigned int maxEntries);
+
+    // 64 bit content digest of the file at path. Returns false if it can't be read
+    bool traceDigest(const char* path, uint64_t* digest);
+
+    bool lookup(uint64_t key, SummaryResult* result);
+    void store(uint64_t key, const SummaryResult& result, const std::string& description);
+    unsigned int clear();       // removes every result and digest, returns the results removed
+
+    std::string dir;
+    unsigned int maxEntries;
+    bool usable;
+
+private:
+    std::string resultPath(uint64_t key);
+    void evict();
+};
+
+
+// streaming 64 bit hash. Feed hash64 the previous return value as seed to hash in pieces of any
+// multiple of 8 bytes, then pass the total length to hashFinish
+uint64_t hash64(const void* data, size_t len, uint64_t seed);
+uint64_t hashFinish(uint64_t hash, uint64_t totalLen);
+
+// $XDG_CACHE_HOME/pagingwithtlb or ~/.cache/pagingwithtlb. Empty if neither is set
+std::string defaultCacheDir();
+
+#endif
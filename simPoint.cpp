@@ -0,0 +1,363 @@
+#include <stdio.h>
+#include <math.h>
+#include <algorithm>
+#include "simPoint.h"
+
+
+/**
+ * @brief - projection of page onto dimension, a fixed pseudo random value in [-1, 1)
+ */
+static inline double projection(unsigned long long page, unsigned int dimension)
+{
+    unsigned long long x = page * SIMPOINT_DIMENSIONS + dimension + 1;
+    x ^= x >> 33;
+    x *= 0xFF51AFD7ED558CCDULL;
+    x ^= x >> 33;
+    x *= 0xC4CEB9FE1A85EC53ULL;
+    x ^= x >> 33;
+    return (double)(x >> 11) * (2.0 / 9007199254740992.0) - 1.0;
+}
+
+
+/**
+ * @brief - hit rate of one metric over a simulated interval
+ */
+static double rateOf(const SimPoint::Interval& interval, int metric)
+{
+    double records = (double)interval.length;
+    if (metric == SIMPOINT_TLB_HITS) {
+        return interval.tlbHits / records;
+    }
+    if (metric == SIMPOINT_PAGE_TABLE_HITS) {
+        return interval.pageTableHits / records;
+    }
+    return (records - interval.tlbHits - interval.pageTableHits) / records;
+}
+
+
+/**
+ * @brief - constructor
+ * @param intervalLength - records per interval
+ * @param clusters - k for k-means
+ * @param samplesPerCluster - intervals simulated in every cluster, the representative included
+ * @param seed - seed for k-means++ and the extra samples
+ */
+SimPoint::SimPoint(unsigned long long intervalLength, unsigned int clusters, unsigned int samplesPerCluster, unsigned int seed)
+    : rng(seed)
+{
+    this->intervalLength = intervalLength;
+    this->clusters = clusters;
+    this->samplesPerCluster = samplesPerCluster;
+    this->iterations = 0;
+    this->runPage = 0;
+    this->runLength = 0;
+    this->inInterval = 0;
+}
+
+
+/**
+ * @brief - counts the pages of records into the open interval, closing it every intervalLength
+ * records. Runs of the same page are counted once per run, so only page changes touch the hash map
+ */
+void SimPoint::profile(const p2AddrTr* records, size_t count, unsigned int offsetShift, bool byProc)
+{
+    for (size_t i = 0; i < count; i++) {
+        unsigned long long page = records[i].addr >> offsetShift;
+        if (byProc) {
+            page |= (unsigned long long)records[i].proc << 32;
+        }
+        if (page != runPage || runLength == 0) {
+            if (runLength > 0) {
+                pageCounts[runPage] += runLength;
+            }
+            runPage = page;
+            runLength = 0;
+        }
+        runLength++;
+        if (++inInterval == intervalLength) {
+            closeInterval();
+        }
+    }
+}
+
+
+void SimPoint::finishProfile()
+{
+    if (inInterval > 0) {
+        closeInterval();
+    }
+}
+
+
+/**
+ * @brief - projects the page frequencies of the open interval into its signature
+ */
+void SimPoint::closeInterval()
+{
+    if (runLength > 0) {
+        pageCounts[runPage] += runLength;
+        runLength = 0;
+    }
+    double signature[SIMPOINT_DIMENSIONS] = { 0 };
+    for (std::unordered_map<unsigned long long, unsigned int>::iterator it = pageCounts.begin(); it != pageCounts.end(); it++) {
+        if (seen.insert(it->first).second) {
+            firstTouched.push_back(it->first);
+        }
+        double frequency = (double)it->second / inInterval;
+        for (unsigned int d = 0; d < SIMPOINT_DIMENSIONS; d++) {
+            signature[d] += frequency * projection(it->first, d);
+        }
+    }
+    signatures.insert(signatures.end(), signature, signature + SIMPOINT_DIMENSIONS);
+
+    Interval interval = { intervals.empty() ? 0 : intervals.back().start + intervals.back().length, inInterval, 0, false, 0, 0,
+        firstTouched.size() };
+    intervals.push_back(interval);
+    pageCounts.clear();
+    inInterval = 0;
+}
+
+
+/**
+ * @brief - squared distance between an interval's signature and a centroid
+ */
+double SimPoint::distance(size_t interval, size_t cluster)
+{
+    double sum = 0.0;
+    for (unsigned int d = 0; d < SIMPOINT_DIMENSIONS; d++) {
+        double diff = signatures[interval * SIMPOINT_DIMENSIONS + d] - centroids[cluster * SIMPOINT_DIMENSIONS + d];
+        sum += diff * diff;
+    }
+    return sum;
+}
+
+
+/**
+ * @brief - k-means with k-means++ seeding over the signatures. A cluster left empty takes the
+ * interval furthest from its centroid. Then every cluster picks its interval closest to the
+ * centroid and samplesPerCluster - 1 random others
+ */
+void SimPoint::cluster()
+{
+    size_t n = intervals.size();
+    clusters = std::min((size_t)clusters, n);
+    if (clusters == 0) {
+        return;
+    }
+
+    // k-means++, each next centroid an interval picked with probability growing with its distance
+    std::vector<double> nearest(n, INFINITY);
+    size_t first = rng() % n;
+    centroids.assign(signatures.begin() + first * SIMPOINT_DIMENSIONS, signatures.begin() + (first + 1) * SIMPOINT_DIMENSIONS);
+    for (unsigned int c = 1; c < clusters; c++) {
+        double total = 0.0;
+        for (size_t i = 0; i < n; i++) {
+            nearest[i] = std::min(nearest[i], distance(i, c - 1));
+            total += nearest[i];
+        }
+        size_t next = 0;
+        double target = std::uniform_real_distribution<double>(0.0, total)(rng);
+        for (double sum = 0.0; next < n - 1 && (sum += nearest[next]) <= target; next++) {
+        }
+        centroids.insert(centroids.end(), signatures.begin() + next * SIMPOINT_DIMENSIONS,
+            signatures.begin() + (next + 1) * SIMPOINT_DIMENSIONS);
+    }
+
+    // Lloyd rounds
+    bool moved = true;
+    for (iterations = 0; moved && iterations < SIMPOINT_MAX_ITERATIONS; iterations++) {
+        moved = false;
+        for (size_t i = 0; i < n; i++) {
+            unsigned int best = 0;
+            double bestDistance = INFINITY;
+            for (unsigned int c = 0; c < clusters; c++) {
+                double d = distance(i, c);
+                if (d < bestDistance) {
+                    bestDistance = d;
+                    best = c;
+                }
+            }
+            moved |= iterations == 0 || intervals[i].cluster != best;
+            intervals[i].cluster = best;
+        }
+
+        std::vector<double> sums(clusters * SIMPOINT_DIMENSIONS, 0.0);
+        std::vector<size_t> sizes(clusters, 0);
+        for (size_t i = 0; i < n; i++) {
+            sizes[intervals[i].cluster]++;
+            for (unsigned int d = 0; d < SIMPOINT_DIMENSIONS; d++) {
+                sums[intervals[i].cluster * SIMPOINT_DIMENSIONS + d] += signatures[i * SIMPOINT_DIMENSIONS + d];
+            }
+        }
+        for (unsigned int c = 0; c < clusters; c++) {
+            if (sizes[c] == 0) {
+                size_t furthest = 0;
+                for (size_t i = 1; i < n; i++) {
+                    if (distance(i, intervals[i].cluster) > distance(furthest, intervals[furthest].cluster)) {
+                        furthest = i;
+                    }
+                }
+                std::copy(signatures.begin() + furthest * SIMPOINT_DIMENSIONS, signatures.begin() + (furthest + 1) * SIMPOINT_DIMENSIONS,
+                    centroids.begin() + c * SIMPOINT_DIMENSIONS);
+                moved = true;
+                continue;
+            }
+            for (unsigned int d = 0; d < SIMPOINT_DIMENSIONS; d++) {
+                centroids[c * SIMPOINT_DIMENSIONS + d] = sums[c * SIMPOINT_DIMENSIONS + d] / sizes[c];
+            }
+        }
+    }
+
+    // the representative of every cluster and random others
+    for (unsigned int c = 0; c < clusters; c++) {
+        std::vector<size_t> members;
+        for (size_t i = 0; i < n; i++) {
+            if (intervals[i].cluster == c) {
+                members.push_back(i);
+            }
+        }
+        if (members.empty()) {
+            continue;
+        }
+        size_t closest = 0;
+        for (size_t m = 1; m < members.size(); m++) {
+            if (distance(members[m], c) < distance(members[closest], c)) {
+                closest = m;
+            }
+        }
+        std::swap(members[0], members[closest]);
+        std::shuffle(members.begin() + 1, members.end(), rng);
+        for (size_t m = 0; m < members.size() && m < samplesPerCluster; m++) {
+            picked.push_back(members[m]);
+        }
+    }
+    std::sort(picked.begin(), picked.end());
+}
+
+
+void SimPoint::simulated(size_t interval, unsigned long long tlbHits, unsigned long long pageTableHits)
+{
+    intervals[interval].simulated = true;
+    intervals[interval].tlbHits = tlbHits;
+    intervals[interval].pageTableHits = pageTableHits;
+}
+
+
+/**
+ * @param record - records after the start of the profiled window
+ */
+size_t SimPoint::touchedBefore(unsigned long long record)
+{
+    size_t ended = std::min((size_t)(record / intervalLength), intervals.size());
+    return ended == 0 ? 0 : intervals[ended - 1].touchedEnd;
+}
+
+
+/**
+ * @brief - stratified estimate of a metric over the whole window. Every cluster's sample mean is
+ * weighted by the share of records in its intervals. The variance adds each cluster's sample
+ * variance, scaled by its squared weight over its samples and corrected for sampling without
+ * replacement. Clusters with one sample use the variance pooled over the clusters with more
+ * @param rate - set to the estimate
+ * @param halfWidth - set to the half width of the 95% confidence interval, negative if no cluster
+ *      has two samples to estimate a spread from
+ */
+void SimPoint::estimate(int metric, double* rate, double* halfWidth)
+{
+    std::vector<double> sums(clusters, 0.0);
+    std::vector<double> squares(clusters, 0.0);
+    std::vector<unsigned int> samples(clusters, 0);
+    std::vector<unsigned int> sizes(clusters, 0);
+    std::vector<double> weights(clusters, 0.0);
+    double total = 0.0;
+    for (size_t i = 0; i < intervals.size(); i++) {
+        unsigned int c = intervals[i].cluster;
+        sizes[c]++;
+        weights[c] += intervals[i].length;
+        total += intervals[i].length;
+        if (intervals[i].simulated) {
+            double r = rateOf(intervals[i], metric);
+            sums[c] += r;
+            squares[c] += r * r;
+            samples[c]++;
+        }
+    }
+
+    double pooled = 0.0;
+    unsigned int freedom = 0;
+    for (unsigned int c = 0; c < clusters; c++) {
+        if (samples[c] >= 2) {
+            pooled += squares[c] - sums[c] * sums[c] / samples[c];
+            freedom += samples[c] - 1;
+        }
+    }
+    pooled = freedom > 0 ? pooled / freedom : 0.0;
+
+    *rate = 0.0;
+    double variance = 0.0;
+    for (unsigned int c = 0; c < clusters; c++) {
+        if (samples[c] == 0) {
+            continue;
+        }
+        double weight = weights[c] / total;
+        double mean = sums[c] / samples[c];
+        double spread = samples[c] >= 2 ? (squares[c] - sums[c] * mean) / (samples[c] - 1) : pooled;
+        *rate += weight * mean;
+        variance += weight * weight * (1.0 - (double)samples[c] / sizes[c]) * std::max(spread, 0.0) / samples[c];
+    }
+    *halfWidth = freedom > 0 ? 1.96 * sqrt(variance) : -1.0;
+}
+
+
+/**
+ * @brief - prints the clustering, the records simulated and the weighted estimates of the TLB
+ * hit, page table hit and miss rates over the whole window with their 95% confidence intervals
+ * @param warmup - records simulated before every picked interval
+ */
+void SimPoint::report(unsigned long long warmup)
+{
+    unsigned long long total = 0;
+    unsigned long long simulatedRecords = 0;
+    for (size_t i = 0; i < intervals.size(); i++) {
+        total += intervals[i].length;
+        simulatedRecords += intervals[i].simulated ? intervals[i].length : 0;
+    }
+    printf("SimPoint: intervals: %lu of %llu records, clusters: %u (k-means rounds: %u)\n",
+        (unsigned long)intervals.size(), intervalLength, clusters, iterations);
+    printf("  Simulated: %lu intervals, %llu of %llu records (%.2f%%), warm-up: %llu records each\n",
+        (unsigned long)picked.size(), simulatedRecords, total, total ? (double)simulatedRecords / total * 100.0 : 0.0, warmup);
+    if (total == 0) {
+        fflush(stdout);
+        return;
+    }
+
+    const char* names[3] = { "TLB hit rate", "Page table hit rate", "Miss rate" };
+    double rates[3];
+    for (int metric = 0; metric < 3; metric++) {
+        double halfWidth;
+        estimate(metric, &rates[metric], &halfWidth);
+        if (halfWidth >= 0.0) {
+            printf("  Estimated %s: %.2f%% +/- %.2f%%\n", names[metric], rates[metric] * 100.0, halfWidth * 100.0);
+        }
+        else {
+            printf("  Estimated %s: %.2f%% (one sample per cluster, no error bars)\n", names[metric], rates[metric] * 100.0);
+        }
+    }
+    printf("  Estimated TLB hits: %.0f, page table hits: %.0f, misses: %.0f\n",
+        rates[SIMPOINT_TLB_HITS] * total, rates[SIMPOINT_PAGE_TABLE_HITS] * total, rates[SIMPOINT_MISSES] * total);
+
+    for (unsigned int c = 0; c < clusters; c++) {
+        unsigned long long records = 0;
+        unsigned int members = 0;
+        unsigned int sampled = 0;
+        for (size_t i = 0; i < intervals.size(); i++) {
+            if (intervals[i].cluster == c) {
+                records += intervals[i].length;
+                members++;
+                sampled += intervals[i].simulated;
+            }
+        }
+        printf("  Cluster %u: intervals: %u, weight: %.2f%%, simulated: %u\n", c, members, (double)records / total * 100.0, sampled);
+    }
+    fflush(stdout);
+}
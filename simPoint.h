@@ -0,0 +1,91 @@
+#ifndef SIMPOINT
+#define SIMPOINT
+
+#include <stddef.h>
+#include <random>
+#include <vector>
+#include <unordered_map>
+#include <unordered_set>
+#include "tracereader.h"
+
+#define SIMPOINT_DIMENSIONS 15          // random projections of an interval's page frequencies
+#define DEFAULT_SIMPOINT_CLUSTERS 10
+#define DEFAULT_SIMPOINT_SAMPLES 2      // intervals simulated per cluster, 2 or more give error bars
+#define SIMPOINT_MAX_ITERATIONS 100     // k-means rounds before giving up on convergence
+#define SIMPOINT_SEED 5489
+
+// estimated rates
+#define SIMPOINT_TLB_HITS 0
+#define SIMPOINT_PAGE_TABLE_HITS 1
+#define SIMPOINT_MISSES 2
+
+
+/**
+ * @brief - --simpoint, representative interval sampling. Phase one reads the trace once without
+ * simulating and describes every interval of intervalLength records by a signature, the page
+ * frequencies of the interval randomly projected to SIMPOINT_DIMENSIONS numbers. k-means groups
+ * intervals with similar signatures into phases, and in every cluster the interval closest to
+ * the centroid plus samplesPerCluster - 1 random others are picked. Phase two (readSimPoints in
+ * main) seeks to each picked interval in trace order, warms the TLB and page table up on the
+ * records before it and simulates it. Every cluster stands for the share of records in its
+ * intervals, which weights its sampled hit rates into whole trace estimates. Their error bars come
+ * from the spread of the samples within each cluster.
+ *
+ * A few thousand warm-up records refill the TLB, but the page table holds every page touched since
+ * the start. Phase one also lists the pages in the order of the interval they were first touched
+ * in, so phase two can map the pages of the skipped intervals without reading them.
+ */
+class SimPoint
+{
+public:
+    SimPoint(unsigned long long intervalLength, unsigned int clusters, unsigned int samplesPerCluster, unsigned int seed);
+
+    // phase one, records in trace order. byProc keeps the pages of different procs apart
+    void profile(const p2AddrTr* records, size_t count, unsigned int offsetShift, bool byProc);
+    void finishProfile();       // closes the last, possibly short, interval
+    void cluster();             // k-means, then picks the intervals to simulate
+
+    // phase two results of a picked interval
+    void simulated(size_t interval, unsigned long long tlbHits, unsigned long long pageTableHits);
+    // pages in firstTouched first touched in the intervals that end at or before record
+    size_t touchedBefore(unsigned long long record);
+
+    void report(unsigned long long warmup);
+
+    struct Interval
+    {
+        unsigned long long start;       // records after the start of the profiled window
+        unsigned long long length;
+        unsigned int cluster;
+        bool simulated;
+        unsigned long long tlbHits;
+        unsigned long long pageTableHits;
+        size_t touchedEnd;              // firstTouched entries up to the end of the interval
+    };
+
+    unsigned long long intervalLength;
+    unsigned int clusters;              // k, at most the number of intervals
+    unsigned int samplesPerCluster;
+    std::vector<Interval> intervals;
+    std::vector<size_t> picked;         // intervals to simulate, in trace order
+    unsigned int iterations;            // k-means rounds until nothing moved
+    std::vector<unsigned long long> firstTouched;   // pages, with the proc above bit 32 if byProc
+
+private:
+    std::mt19937 rng;
+    std::vector<double> signatures;     // SIMPOINT_DIMENSIONS per interval
+    std::vector<double> centroids;      // SIMPOINT_DIMENSIONS per cluster
+
+    // pages of the open interval
+    std::unordered_map<unsigned long long, unsigned int> pageCounts;
+    std::unordered_set<unsigned long long> seen;        // pages of the closed intervals
+    unsigned long long runPage;         // last page, counted in runLength before going into pageCounts
+    unsigned int runLength;
+    unsigned long long inInterval;      // records in the open interval
+
+    void closeInterval();
+    double distance(size_t interval, size_t cluster);
+    void estimate(int metric, double* rate, double* halfWidth);
+};
+
+#endif
@@ -0,0 +1,240 @@
+#include "simulator.h"
+
+
+/**
+ * @brief - key of vpn in address space asid for the memory tiers and fault-around, so processes
+ * never share a page
+ */
+static unsigned long long pageKey(unsigned int asid, unsigned int vpn)
+{
+    return ((unsigned long long)asid << ASID_SHIFT) | vpn;
+}
+
+
+/**
+ * @brief - maps vpn, which isn't mapped, to the next frame, or with --frames once every frame is in
+ * use to the frame of the enhanced second chance victim. The victim's page is unmapped and shot down
+ * from the TLBs, and with memory tiers goes to zswap or swap before the fault is served. Under --asid
+ * the victim may belong to another process, whose entry only the tagged -c TLB can still hold.
+ * @return Map* of vpn
+ */
+static Map* mapPage(PageTable* pTable, tlb* cache, TlbHierarchy* tlbs, MultiCore* cores, unsigned int vpn, unsigned int proc)
+{
+    FrameTable* frames = pTable->frames;
+    Map* frame;
+
+    // go here if memory is full, the victim's frame is reused
+    if (frames != NULL && frames->full(pTable->currFrameNum)) {
+        unsigned int frameNum = frames->victim(pTable);
+        unsigned int victimVpn = frames->vpnIn(frameNum);
+        unsigned int victimAsid = frames->asidIn(frameNum);
+        if (frames->tiers != NULL) {
+            frames->tiers->evict(pageKey(victimAsid, victimVpn), pTable->lookupIn(victimAsid, victimVpn)->isDirty(),
+                pTable->addressCount);
+        }
+        if (pTable->faultAround != NULL) {
+            pTable->faultAround->evicted(pageKey(victimAsid, victimVpn));
+        }
+        pTable->invalidateIn(victimAsid, victimVpn);
+        if (victimAsid != pTable->currAsid) {
+            if (cache != NULL) {
+                cache->invalidate(victimVpn, victimAsid);
+            }
+        }
+        else {
+            if (cache != NULL) {
+                cache->invalidate(victimVpn);
+                if (cache->prefetcher != NULL) {
+                    cache->prefetcher->invalidate(victimVpn);
+                }
+            }
+            if (tlbs != NULL) {
+                tlbs->invalidate(victimVpn);
+            }
+            if (cores != NULL) {
+                cores->shootdown(victimVpn, cores->coreOf(proc));
+                cores->evictionShootdowns++;
+            }
+        }
+        if (frames->tiers != NULL) {
+            frames->tiers->fault(pageKey(pTable->currAsid, vpn), pTable->addressCount);
+        }
+        frame = pTable->backend->insert(vpn, frameNum);
+        frames->assign(frameNum, vpn, pTable->currAsid);
+        pTable->frameCount++;
+        return frame;
+    }
+
+    if (frames != NULL && frames->tiers != NULL) {
+        frames->tiers->fault(pageKey(pTable->currAsid, vpn), pTable->addressCount);
+    }
+    unsigned int frameNum = pTable->nextFrame(vpn, proc);
+    frame = pTable->backend->insert(vpn, frameNum);
+    if (frames != NULL) {
+        frames->assign(frameNum, vpn, pTable->currAsid);
+    }
+    pTable->takeFrame(vpn, proc);
+    return frame;
+}
+
+
+/**
+ * @brief - --fault-around and --readahead. Maps the pages the policies pick for a fault on vpn that
+ * aren't mapped yet, each like a fault of its own
+ */
+static void mapAhead(PageTable* pTable, tlb* cache, TlbHierarchy* tlbs, MultiCore* cores, unsigned int vpn, unsigned int proc)
+{
+    FaultAround* faultAround = pTable->faultAround;
+    faultAround->plan(pTable->currAsid, vpn, 1u << pTable->bitsInLevel[pTable->levelCount - 1], 1u << pTable->vpnNumBits);
+    for (size_t i = 0; i < faultAround->candidates.size(); i++) {
+        unsigned int page = faultAround->candidates[i].vpn;
+        if (pTable->backend->lookup(page) != nullptr) {
+            continue;
+        }
+        mapPage(pTable, cache, tlbs, cores, page, proc);
+        faultAround->mapped(pageKey(pTable->currAsid, page), faultAround->candidates[i].readahead);
+    }
+}
+
+
+/**
+ * @brief - walks the pageTable for vpn after a TLB miss, mapping it with mapPage if it isn't mapped
+ * yet. Pages fault-around and readahead pick are mapped first, so mapping them can't evict vpn's page
+ * @param pTable - pointer to pageTable obj to walk
+ * @param cache - tlb* to shoot evicted pages down from, or NULL
+ * @param tlbs - TlbHierarchy* to shoot evicted pages down from, or NULL
+ * @param cores - MultiCore* whose TLBs evicted pages are shot down from, or NULL
+ * @param vpn - page number to translate
+ * @param proc - trace proc of the access, for the frame allocator
+ * @param pageTableHit - set to true if vpn was already mapped
+ * @return Map* of vpn
+ */
+Map* pageWalk(PageTable* pTable, tlb* cache, TlbHierarchy* tlbs, MultiCore* cores, unsigned int vpn, unsigned int proc,
+    bool* pageTableHit)
+{
+    Map* frame;
+
+    if (pTable->faultAround != NULL) {
+        if (pTable->backend->lookup(vpn) == nullptr) {
+            mapAhead(pTable, cache, tlbs, cores, vpn, proc);
+        }
+        else {
+            pTable->faultAround->walked(pageKey(pTable->currAsid, vpn));
+        }
+    }
+
+    if (pTable->frames == NULL) {
+        frame = pTable->backend->lookupOrInsert(vpn, pTable->nextFrame(vpn, proc), pageTableHit);
+        if (!*pageTableHit) {
+            // go here if PageTable MISS
+            pTable->takeFrame(vpn, proc);
+        }
+    }
+    else if ((frame = pTable->backend->lookup(vpn)) != nullptr) {
+        *pageTableHit = true;
+    }
+    else {
+        *pageTableHit = false;
+        frame = mapPage(pTable, cache, tlbs, cores, vpn, proc);
+    }
+    return frame;
+}
+
+
+/**
+ * @brief - sets the referenced bit of vpn's page, and the dirty bit for writes. Only needed in
+ * --frames mode, where the bits steer eviction
+ * @param pTable - pointer to pageTable obj holding the mapping
+ * @param vpn - page number that was accessed
+ * @param reqtype - trace record reqtype. MEMWRITE and IOWRITE dirty the page
+ */
+void markAccess(PageTable* pTable, unsigned int vpn, unsigned char reqtype)
+{
+    Map* frame = pTable->backend->lookup(vpn);
+    frame->setReferenced();
+    if (reqtype == MEMWRITE || reqtype == IOWRITE) {
+        frame->setDirty();
+    }
+}
+
+
+/**
+ * @brief - trains the tlb's prefetcher on a miss and prefetches the translations it asks for. Pages
+ * outside the vpn range, already in the TLB or prefetch buffer, or not mapped yet are skipped, so
+ * prefetching never allocates frames. Every lookup counts as a prefetch page walk.
+ * @param pTable - pointer to pageTable obj to walk
+ * @param cache - tlb* holding the prefetcher
+ * @param vpn - page that missed the TLB
+ */
+void prefetchTranslations(PageTable* pTable, tlb* cache, unsigned int vpn)
+{
+    TlbPrefetcher* prefetcher = cache->prefetcher;
+    prefetcher->candidates.clear();
+    prefetcher->train(vpn, &prefetcher->candidates);
+
+    for (unsigned int i = 0; i < prefetcher->candidates.size(); i++) {
+        unsigned int candidate = prefetcher->candidates[i];
+        if ((candidate >> pTable->vpnNumBits) != 0 || cache->hasMapping(candidate) || prefetcher->inBuffer(candidate)) {
+            continue;
+        }
+        prefetcher->walks++;
+        Map* frame = pTable->backend->lookup(candidate);
+        if (frame == nullptr) {
+            continue;
+        }
+        prefetcher->issued++;
+        if (prefetcher->bufferEntries > 0) {
+            prefetcher->fillBuffer(candidate, frame->getFrameNum());
+        }
+        else {
+            cache->insertMapping(candidate, frame->getFrameNum());
+            prefetcher->notePrefetched(candidate);
+        }
+    }
+}
+
+
+/**
+ * @brief - switches the pageTable and tlb to the address space of the record's proc if it differs
+ * from the current one
+ * @param trace - p2AddrTr* about to be processed
+ * @param pTable - pointer to pageTable obj. Holds the per-process roots
+ * @param cache - tlb* switched to the new asid
+ * @param flush - true to flush the tlb on a switch (--asid=flush), false to keep it tagged
+ */
+void switchContext(const p2AddrTr* trace, PageTable* pTable, tlb* cache, bool flush)
+{
+    if (trace->proc == pTable->currAsid) {
+        return;
+    }
+    bool switched = pTable->switchProcess(trace->proc);
+    cache->switchAsid(trace->proc, switched && flush);
+}
+
+
+/**
+ * @brief - moves traceFile forward so the next record it returns is record target. Uses the source's
+ * own seek when it has one, otherwise reads and throws away records.
+ * @param traceFile - TraceSource* for traceFile
+ * @param trace - p2AddrTr* used as scratch space when reading forward
+ * @param recordPos - record traceFile will return next. Updated to target on success
+ * @param target - record to move to
+ * @return false if the trace ends before target
+ */
+bool moveToRecord(TraceSource* traceFile, p2AddrTr* trace, unsigned long long* recordPos, unsigned long long target)
+{
+    if (target == *recordPos) {
+        return true;
+    }
+    if (traceFile->seekRecord(target)) {
+        *recordPos = target;
+        return true;
+    }
+    while (*recordPos < target) {
+        if (!traceFile->next(trace)) {
+            return false;
+        }
+        (*recordPos)++;
+    }
+    return *recordPos == target;
+}
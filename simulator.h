@@ -0,0 +1,459 @@
+#ifndef SIMULATOR
+#define SIMULATOR
+
+#include <algorithm>
+#include "pageTable.h"
+#include "tlb.h"
+#include "tlbHierarchy.h"
+#include "dataCache.h"
+#include "multiCore.h"
+#include "traceSource.h"
+#include "traceCompactor.h"
+#include "output_mode_helpers.h"
+
+/*
+ * Translation engine, linkable on its own as libpagingsim.a. A Simulator is built from two policies
+ * picked at compile time, so the per-record loop has no branches on the output mode or TLB type:
+ *
+ *      OutputPolicy - what is printed per record. Has a static const bool perRecord and
+ *          static void record(PageTable*, virtAddr, physAddr, frameNum, tlbHit, pageTableHit)
+ *      TlbPolicy - what sits in front of the pageTable. Has
+ *          bool translate(PageTable*, const p2AddrTr*, vpn, frameNum*, pageTableHit*)
+ *              returns true on a TLB hit, otherwise walks the pageTable with pageWalk
+ *          void repeat(PageTable*, const p2AddrTr*, vpn, times)
+ *              accounts for times more accesses to the page just translated
+ *          void replayBatch(PageTable*, const p2AddrTr*, const uint32_t* pfns, const bool* hits, count)
+ *              replays records the pageTable already translated with translateBatch
+ *
+ * Setting caches feeds the physical address of every access to the L1/L2/LLC data caches.
+ *
+ * Embedding:
+ *      PageTable pTable(numLevels, bitsInLevel, vpnNumBits);
+ *      tlb cache(vpnNumBits, 64);
+ *      Simulator<SummaryOutput, FlatTlb> sim(&pTable, FlatTlb(&cache));
+ *      sim.runBatched(openTraceSource("trace.tr"), ULLONG_MAX);
+ *      // pTable.countTlbHits, countPageTableHits, frameCount, addressCount hold the results
+ */
+
+
+// shared by every instantiation, see simulator.cpp
+Map* pageWalk(PageTable* pTable, tlb* cache, TlbHierarchy* tlbs, MultiCore* cores, unsigned int vpn, unsigned int proc,
+    bool* pageTableHit);
+void markAccess(PageTable* pTable, unsigned int vpn, unsigned char reqtype);
+void prefetchTranslations(PageTable* pTable, tlb* cache, unsigned int vpn);
+void switchContext(const p2AddrTr* trace, PageTable* pTable, tlb* cache, bool flush);
+bool moveToRecord(TraceSource* traceFile, p2AddrTr* trace, unsigned long long* recordPos, unsigned long long target);
+
+
+/**
+ * @brief - summary mode, nothing is printed per record
+ */
+struct SummaryOutput
+{
+    static const bool perRecord = false;
+    static void record(PageTable* pTable, unsigned int virtAddr, unsigned int physAddr, unsigned int frameNum,
+        bool tlbHit, bool pageTableHit) {}
+};
+
+/**
+ * @brief - virtual2physical mode
+ */
+struct Virtual2PhysicalOutput
+{
+    static const bool perRecord = true;
+    static void record(PageTable* pTable, unsigned int virtAddr, unsigned int physAddr, unsigned int frameNum,
+        bool tlbHit, bool pageTableHit)
+    {
+        report_virtual2physical(virtAddr, physAddr);
+    }
+};
+
+/**
+ * @brief - v2p_tlb_pt mode, the translation plus whether the TLB and pageTable hit
+ */
+struct V2PTlbPtOutput
+{
+    static const bool perRecord = true;
+    static void record(PageTable* pTable, unsigned int virtAddr, unsigned int physAddr, unsigned int frameNum,
+        bool tlbHit, bool pageTableHit)
+    {
+        report_v2pUsingTLB_PTwalk(virtAddr, physAddr, tlbHit, pageTableHit);
+    }
+};
+
+/**
+ * @brief - vpn2pfn mode, the page number of every level and the frame
+ */
+struct Vpn2PfnOutput
+{
+    static const bool perRecord = true;
+    static void record(PageTable* pTable, unsigned int virtAddr, unsigned int physAddr, unsigned int frameNum,
+        bool tlbHit, bool pageTableHit)
+    {
+        unsigned int pages[pTable->levelCount];
+        for (int i = 0; i < pTable->levelCount; i++) {
+            pages[i] = pTable->virtualAddressToPageNum(virtAddr, pTable->maskArr[i], pTable->shiftArr[i]);
+        }
+        report_pagemap(pTable->levelCount, pages, frameNum);
+    }
+};
+
+/**
+ * @brief - offset mode, the page offset of every address
+ */
+struct OffsetOutput
+{
+    static const bool perRecord = true;
+    static void record(PageTable* pTable, unsigned int virtAddr, unsigned int physAddr, unsigned int frameNum,
+        bool tlbHit, bool pageTableHit)
+    {
+        hexnum(pTable->getOffsetOfAddress(virtAddr));
+    }
+};
+
+
+/**
+ * @brief - no TLB, every access walks the pageTable
+ */
+class NoTlb
+{
+public:
+    bool translate(PageTable* pTable, const p2AddrTr* trace, unsigned int vpn, unsigned int* frameNum, bool* pageTableHit)
+    {
+        *frameNum = pageWalk(pTable, NULL, NULL, NULL, vpn, trace->proc, pageTableHit)->getFrameNum();
+        return false;
+    }
+
+    void repeat(PageTable* pTable, const p2AddrTr* trace, unsigned int vpn, unsigned int times)
+    {
+        pTable->countPageTableHits += times;
+    }
+
+    void replayBatch(PageTable* pTable, const p2AddrTr* records, const uint32_t* pfns, const bool* hits, size_t count)
+    {
+        for (size_t i = 0; i < count; i++) {
+            pTable->countPageTableHits += hits[i];
+        }
+    }
+};
+
+/**
+ * @brief - the flat -c tlb, with its prefetcher if it has one
+ */
+class FlatTlb
+{
+public:
+    FlatTlb(tlb* cache) : cache(cache) {}
+    tlb* cache;
+
+    bool translate(PageTable* pTable, const p2AddrTr* trace, unsigned int vpn, unsigned int* frameNum, bool* pageTableHit)
+    {
+        // go here if TLB hit
+        if (cache->hasMapping(vpn)) {
+            *frameNum = cache->getMapping(vpn);
+            cache->touch(vpn);    // update most recently used
+            if (cache->prefetcher != NULL) {
+                cache->prefetcher->usePrefetched(vpn);
+            }
+            return true;
+        }
+        // go here if TLB MISS that the prefetch buffer covers
+        if (cache->prefetcher != NULL && cache->prefetcher->takeFromBuffer(vpn, frameNum)) {
+            cache->insertMapping(vpn, *frameNum);
+            prefetchTranslations(pTable, cache, vpn);
+            return true;
+        }
+        // go here if TLB MISS
+        *frameNum = pageWalk(pTable, cache, NULL, NULL, vpn, trace->proc, pageTableHit)->getFrameNum();
+        cache->insertMapping(vpn, *frameNum);    // update cache and most recently used
+        if (cache->prefetcher != NULL) {
+            cache->prefetcher->demandWalks++;
+            cache->prefetcher->forget(vpn);
+            prefetchTranslations(pTable, cache, vpn);
+        }
+        return false;
+    }
+
+    // the first repeat promotes the page (e.g. srrip inserts at a long re-reference interval),
+    // further repeats leave every policy but lfu unchanged
+    void repeat(PageTable* pTable, const p2AddrTr* trace, unsigned int vpn, unsigned int times)
+    {
+        if (times > 0) {
+            cache->touch(vpn);
+        }
+        pTable->countTlbHits += times;
+    }
+
+    void replayBatch(PageTable* pTable, const p2AddrTr* records, const uint32_t* pfns, const bool* hits, size_t count)
+    {
+        for (size_t i = 0; i < count; i++) {
+            unsigned int vpn = records[i].addr >> pTable->offsetShift;
+            if (cache->hasMapping(vpn)) {
+                pTable->countTlbHits++;
+                cache->touch(vpn);      // update most recently used
+            }
+            else {
+                cache->insertMapping(vpn, pfns[i]);
+                pTable->countPageTableHits += hits[i];
+            }
+        }
+    }
+};
+
+/**
+ * @brief - split iTLB/dTLB backed by the STLB. The record's reqtype picks the L1
+ */
+class HierarchyTlb
+{
+public:
+    HierarchyTlb(TlbHierarchy* tlbs) : tlbs(tlbs) {}
+    TlbHierarchy* tlbs;
+
+    bool translate(PageTable* pTable, const p2AddrTr* trace, unsigned int vpn, unsigned int* frameNum, bool* pageTableHit)
+    {
+        // go here if hit at any TLB level
+        if (tlbs->lookup(vpn, trace->reqtype, frameNum)) {
+            return true;
+        }
+        // go here if every level missed
+        *frameNum = pageWalk(pTable, NULL, tlbs, NULL, vpn, trace->proc, pageTableHit)->getFrameNum();
+        tlbs->fill(vpn, trace->reqtype, *frameNum);
+        return false;
+    }
+
+    // same-page repeats may switch L1s, so each one is looked up
+    void repeat(PageTable* pTable, const p2AddrTr* trace, unsigned int vpn, unsigned int times)
+    {
+        for (unsigned int i = 0; i < times; i++) {
+            unsigned int frameNum;
+            bool pageTableHit = true;
+            if (translate(pTable, trace, vpn, &frameNum, &pageTableHit)) {
+                pTable->countTlbHits++;
+            }
+            else if (pageTableHit) {
+                pTable->countPageTableHits++;
+            }
+        }
+    }
+
+    void replayBatch(PageTable* pTable, const p2AddrTr* records, const uint32_t* pfns, const bool* hits, size_t count)
+    {
+        for (size_t i = 0; i < count; i++) {
+            unsigned int vpn = records[i].addr >> pTable->offsetShift;
+            unsigned int frameNum;
+            if (tlbs->lookup(vpn, records[i].reqtype, &frameNum)) {
+                pTable->countTlbHits++;
+            }
+            else {
+                tlbs->fill(vpn, records[i].reqtype, pfns[i]);
+                pTable->countPageTableHits += hits[i];
+            }
+        }
+    }
+};
+
+/**
+ * @brief - --cores, a -c TLB per core over the shared pageTable. The record's proc picks the core.
+ * --core-events due before the record are applied first
+ */
+class MultiCoreTlb
+{
+public:
+    MultiCoreTlb(MultiCore* cores) : cores(cores) {}
+    MultiCore* cores;
+
+    bool translate(PageTable* pTable, const p2AddrTr* trace, unsigned int vpn, unsigned int* frameNum, bool* pageTableHit)
+    {
+        unsigned int core = cores->coreOf(trace->proc);
+        if (cores->nextEvent < cores->events.size()) {
+            cores->applyEvents(pTable, pTable->addressCount, core);
+        }
+        tlb* cache = cores->tlbs[core];
+        // go here if TLB hit on the record's core
+        if (cache->hasMapping(vpn)) {
+            *frameNum = cache->getMapping(vpn);
+            cache->touch(vpn);
+            cores->hits[core]++;
+            return true;
+        }
+        // go here if TLB MISS, other cores' entries are shot down if a page is evicted
+        *frameNum = pageWalk(pTable, NULL, NULL, cores, vpn, trace->proc, pageTableHit)->getFrameNum();
+        cache->insertMapping(vpn, *frameNum);
+        cores->filled(vpn, core);
+        cores->misses[core]++;
+        return false;
+    }
+
+    void repeat(PageTable* pTable, const p2AddrTr* trace, unsigned int vpn, unsigned int times)
+    {
+        unsigned int core = cores->coreOf(trace->proc);
+        if (times > 0) {
+            cores->tlbs[core]->touch(vpn);
+        }
+        cores->hits[core] += times;
+        pTable->countTlbHits += times;
+    }
+
+    void replayBatch(PageTable* pTable, const p2AddrTr* records, const uint32_t* pfns, const bool* hits, size_t count)
+    {
+        for (size_t i = 0; i < count; i++) {
+            unsigned int vpn = records[i].addr >> pTable->offsetShift;
+            unsigned int core = cores->coreOf(records[i].proc);
+            tlb* cache = cores->tlbs[core];
+            if (cache->hasMapping(vpn)) {
+                pTable->countTlbHits++;
+                cache->touch(vpn);
+                cores->hits[core]++;
+            }
+            else {
+                cache->insertMapping(vpn, pfns[i]);
+                cores->filled(vpn, core);
+                cores->misses[core]++;
+                pTable->countPageTableHits += hits[i];
+            }
+        }
+    }
+};
+
+
+/**
+ * @brief - translates trace records through TlbPolicy and the pageTable and reports them through
+ * OutputPolicy. Results accumulate in the pageTable's counters.
+ */
+template <class OutputPolicy, class TlbPolicy>
+class Simulator
+{
+public:
+    Simulator(PageTable* pTable, const TlbPolicy& tlbPolicy, DataCaches* caches = NULL)
+        : pTable(pTable), tlbPolicy(tlbPolicy), caches(caches) {}
+
+    PageTable* pTable;
+    TlbPolicy tlbPolicy;
+    DataCaches* caches;     // NULL when data caches aren't simulated
+
+    /**
+     * @brief - translates one record, updates the hit counts and reports it
+     * @param trace - record to translate
+     */
+    void process(const p2AddrTr* trace)
+    {
+        unsigned int virtAddr = trace->addr;
+        unsigned int vpn = virtAddr >> pTable->offsetShift;
+        unsigned int frameNum = 0;
+        bool pageTableHit = true;   // default true, conditional check if not
+
+        bool tlbHit = tlbPolicy.translate(pTable, trace, vpn, &frameNum, &pageTableHit);
+        if (tlbHit) {
+            pTable->countTlbHits++;
+        }
+        else if (pageTableHit) {
+            pTable->countPageTableHits++;
+        }
+        if (pTable->frames != NULL) {
+            markAccess(pTable, vpn, trace->reqtype);
+        }
+        if (pTable->allocator != NULL && pTable->allocator->countsAccesses) {
+            pTable->allocator->access(frameNum, trace->proc);
+        }
+        if (caches != NULL) {
+            caches->access(pTable->appendOffset(frameNum, virtAddr), trace->reqtype);
+        }
+        pTable->addressCount++;
+
+        if (OutputPolicy::perRecord) {
+            OutputPolicy::record(pTable, virtAddr, pTable->appendOffset(frameNum, virtAddr), frameNum, tlbHit, pageTableHit);
+        }
+    }
+
+    /**
+     * @brief - processes records one at a time until source ends or maxRecords are done
+     * @return records processed
+     */
+    unsigned long long run(TraceSource* source, unsigned long long maxRecords)
+    {
+        p2AddrTr trace;
+        unsigned long long done = 0;
+        while (done < maxRecords && source->next(&trace)) {
+            process(&trace);
+            done++;
+        }
+        return done;
+    }
+
+    /**
+     * @brief - reads source through a TraceCompactor. The first access of each same-page run is
+     * processed, the rest are guaranteed TLB hits (pageTable hits without a TLB) counted in bulk.
+     * Counts match run exactly for every TLB policy but lfu. Needs no data caches, the repeats may
+     * touch other lines
+     * @return records consumed
+     */
+    unsigned long long runCompacted(TraceSource* source, unsigned long long maxRecords)
+    {
+        static_assert(!OutputPolicy::perRecord, "compacted runs can't report every record");
+        TraceCompactor compactor(source, pTable->offsetShift);
+        pageRun run;
+        unsigned long long done = 0;
+
+        while (compactor.nextRun(&run, std::min(maxRecords - done, (unsigned long long)UINT32_MAX))) {
+            process(&run.first);
+            tlbPolicy.repeat(pTable, &run.first, run.first.addr >> pTable->offsetShift, run.count - 1);
+            pTable->addressCount += run.count - 1;
+            done += run.count;
+        }
+        return done;
+    }
+
+    /**
+     * @brief - translates up to TRANSLATE_BATCH_SIZE records with PageTable::translateBatch, then
+     * replays them through the TLB. A page is inserted into the pageTable on its first access
+     * whether or not there is a TLB, so the pageTable results of a block don't depend on the TLB and
+     * the counts match process exactly. Needs a single address space, no prefetcher and no frame
+     * limit. Output policies that report every record process the block one record at a time.
+     * The data caches see the block after the TLB, in trace order
+     * @param records - records to translate
+     * @param count - number of records, at most TRANSLATE_BATCH_SIZE
+     */
+    void processBatch(const p2AddrTr* records, size_t count)
+    {
+        if (OutputPolicy::perRecord) {
+            for (size_t i = 0; i < count; i++) {
+                process(&records[i]);
+            }
+            return;
+        }
+        uint32_t vaddrs[TRANSLATE_BATCH_SIZE];
+        uint32_t pfns[TRANSLATE_BATCH_SIZE];
+        uint32_t physAddrs[TRANSLATE_BATCH_SIZE];
+        bool hits[TRANSLATE_BATCH_SIZE];
+        for (size_t i = 0; i < count; i++) {
+            vaddrs[i] = records[i].addr;
+        }
+        pTable->translateBatch(vaddrs, count, pfns, hits, caches != NULL ? physAddrs : nullptr);
+        tlbPolicy.replayBatch(pTable, records, pfns, hits, count);
+        if (caches != NULL) {
+            caches->accessBatch(physAddrs, records, count);
+        }
+        pTable->addressCount += count;
+    }
+
+    /**
+     * @brief - reads TRANSLATE_BATCH_SIZE records at a time and translates them with processBatch
+     * @return records consumed
+     */
+    unsigned long long runBatched(TraceSource* source, unsigned long long maxRecords)
+    {
+        static_assert(!OutputPolicy::perRecord, "batched runs can't report every record");
+        p2AddrTr records[TRANSLATE_BATCH_SIZE];
+        unsigned long long done = 0;
+        size_t count;
+
+        while (done < maxRecords
+            && (count = source->nextBatch(records, std::min(maxRecords - done, (unsigned long long)TRANSLATE_BATCH_SIZE))) > 0) {
+            processBatch(records, count);
+            done += count;
+        }
+        return done;
+    }
+};
+
+#endif
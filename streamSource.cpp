@@ -0,0 +1,169 @@
+#include "streamSource.h"
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#include <stdio.h>
+#include <algorithm>
+
+
+/**
+ * @brief - constructor makes fd non-blocking and, for pipes on Linux, asks for a larger pipe
+ * @param fd - open file descriptor to read, owned by the source from now on
+ * @param format - STREAM_BYU or STREAM_ADDR32
+ */
+StreamSource::StreamSource(int fd, int format)
+{
+    this->fd = fd;
+    this->format = format;
+    this->ended = false;
+    this->bytesRead = 0;
+    this->buffer.resize(STREAM_BUFFER_BYTES);
+    this->readPos = 0;
+    this->writePos = 0;
+    this->recordBytes = (format == STREAM_ADDR32) ? 4 : sizeof(p2AddrTr);
+
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+#ifdef F_SETPIPE_SZ
+    fcntl(fd, F_SETPIPE_SZ, STREAM_PIPE_BYTES);    // fails harmlessly on anything but a pipe
+#endif
+}
+
+
+StreamSource::~StreamSource()
+{
+    close(fd);
+}
+
+
+/**
+ * @brief - moves the unread bytes to the front of the buffer, then reads until the producer has
+ * nothing more, the buffer is full or the stream ends
+ * @return bytes read
+ */
+size_t StreamSource::fill()
+{
+    if (readPos > 0) {
+        memmove(&buffer[0], &buffer[readPos], writePos - readPos);
+        writePos -= readPos;
+        readPos = 0;
+    }
+
+    size_t total = 0;
+    while (!ended && writePos < buffer.size()) {
+        ssize_t n = read(fd, &buffer[writePos], buffer.size() - writePos);
+        if (n > 0) {
+            writePos += n;
+            total += n;
+        }
+        else if (n == 0) {
+            ended = true;
+        }
+        else if (errno == EINTR) {
+            continue;
+        }
+        else {
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                perror("Reading the trace stream");
+                ended = true;
+            }
+            break;
+        }
+    }
+    bytesRead += total;
+
+    if (ended && (writePos - readPos) % recordBytes != 0) {
+        fprintf(stderr, "Trace stream ended inside a record, %lu trailing bytes ignored\n",
+            (unsigned long)((writePos - readPos) % recordBytes));
+    }
+    return total;
+}
+
+
+/**
+ * @brief - number of whole records read but not handed out yet
+ */
+size_t StreamSource::buffered()
+{
+    return (writePos - readPos) / recordBytes;
+}
+
+
+/**
+ * @brief - decodes up to max buffered records. Multi-byte fields are little endian on the wire
+ * @param records - array of at least max records to fill
+ * @param max - most records to decode
+ * @return records decoded, 0 if none are buffered
+ */
+size_t StreamSource::takeBuffered(p2AddrTr* records, size_t max)
+{
+    size_t count = std::min(max, buffered());
+    const unsigned char* in = &buffer[readPos];
+    for (size_t i = 0; i < count; i++, in += recordBytes) {
+        records[i].addr = in[0] | (in[1] << 8) | (in[2] << 16) | ((uint32_t)in[3] << 24);
+        if (format == STREAM_ADDR32) {
+            records[i].reqtype = MEMREAD;
+            records[i].size = 4;
+            records[i].attr = 0;
+            records[i].proc = 0;
+            records[i].time = 0;
+        }
+        else {
+            records[i].reqtype = in[4];
+            records[i].size = in[5];
+            records[i].attr = in[6];
+            records[i].proc = in[7];
+            records[i].time = in[8] | (in[9] << 8) | (in[10] << 16) | ((uint32_t)in[11] << 24);
+        }
+    }
+    readPos += count * recordBytes;
+    return count;
+}
+
+
+/**
+ * @brief - waits in poll until a whole record is buffered
+ * @return false once the stream ended without another whole record
+ */
+bool StreamSource::waitForData()
+{
+    while (buffered() == 0) {
+        if (ended) {
+            return false;
+        }
+        struct pollfd pfd;
+        pfd.fd = fd;
+        pfd.events = POLLIN;
+        if (poll(&pfd, 1, -1) < 0 && errno != EINTR) {
+            perror("Waiting for the trace stream");
+            return false;
+        }
+        fill();
+    }
+    return true;
+}
+
+
+/**
+ * @brief - next record, waiting for the producer if none is buffered
+ * @param record - filled with the next record
+ */
+bool StreamSource::next(p2AddrTr* record)
+{
+    return waitForData() && takeBuffered(record, 1) == 1;
+}
+
+
+/**
+ * @brief - the records already buffered, up to max. Only waits when none are
+ * @param records - array of at least max records to fill
+ * @param max - most records to return
+ */
+size_t StreamSource::nextBatch(p2AddrTr* records, size_t max)
+{
+    if (!waitForData()) {
+        return 0;
+    }
+    return takeBuffered(records, max);
+}
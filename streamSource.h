@@ -0,0 +1,51 @@
+#ifndef STREAMSOURCE
+#define STREAMSOURCE
+
+#include <vector>
+#include "traceSource.h"
+
+// --stream-format values
+#define STREAM_BYU 0        // p2AddrTr records, 12 bytes each, little endian like the trace files
+#define STREAM_ADDR32 1     // bare 32 bit little endian virtual addresses, read as MEMREAD by proc 0
+
+#define STREAM_BUFFER_BYTES (4 << 20)   // read buffer, drained in as few read calls as possible
+#define STREAM_PIPE_BYTES (1 << 20)     // pipe capacity asked for so a fast producer rarely blocks
+
+
+/**
+ * @brief - trace records arriving on a pipe, stdin or a socket while they are produced. The file
+ * descriptor is non-blocking: fill reads everything the producer has written so far in large
+ * chunks and the decoded records are handed out by next and nextBatch. Used as a plain TraceSource
+ * (next and nextBatch wait for data when nothing is buffered) or driven by a poll loop with
+ * fill and buffered.
+ */
+class StreamSource : public TraceSource
+{
+public:
+    StreamSource(int fd, int format);
+    ~StreamSource();    // closes fd
+
+    bool next(p2AddrTr* record);
+    size_t nextBatch(p2AddrTr* records, size_t max);
+
+    // reads without blocking until the producer has nothing more to give or the buffer is full.
+    // Returns the bytes read, sets ended once the producer closes its end
+    size_t fill();
+    size_t buffered();      // complete records waiting in the buffer
+    size_t takeBuffered(p2AddrTr* records, size_t max);     // never waits
+
+    int fd;
+    int format;
+    bool ended;
+    unsigned long long bytesRead;
+
+private:
+    std::vector<unsigned char> buffer;
+    size_t readPos;     // first byte not handed out yet
+    size_t writePos;    // end of the bytes read so far
+    size_t recordBytes;
+
+    bool waitForData();     // blocks in poll, false once the stream ended with no whole record left
+};
+
+#endif
@@ -10,6 +10,28 @@
 tlb::tlb(int vpnNumBits, int capacity)
 {
     this->capacity = capacity;
+    this->policy = NULL;
+    this->prefetcher = NULL;
+    this->asid = 0;
+    this->switchMisses = 0;
+    setVpnMask(vpnNumBits);
+}
+
+
+/**
+ * @brief - constructor for a TLB that evicts with a ReplacementPolicy instead of the recent pages queue
+ * @param vpnNumBits - number of bits in vpn
+ * @param capacity - capacity of the cache given by cFlag
+ * @param policyName - lru, fifo, random, clock, srrip, brrip or lfu
+ * @param seed - rng seed for the random and brrip policies
+ */
+tlb::tlb(int vpnNumBits, int capacity, const char* policyName, unsigned int seed)
+{
+    this->capacity = capacity;
+    this->policy = createReplacementPolicy(policyName, capacity, seed);
+    this->prefetcher = NULL;
+    this->asid = 0;
+    this->switchMisses = 0;
     setVpnMask(vpnNumBits);
 }
 
@@ -42,7 +64,7 @@ void tlb::setVpnMask(int vpnNumBits)
  */
 bool tlb::hasMapping(unsigned int vpn)
 {
-    if (vpn2pfn.find(vpn) != vpn2pfn.end()) {
+    if (vpn2pfn.find(key(vpn)) != vpn2pfn.end()) {
         return true;
     }
     return false;
@@ -50,27 +72,179 @@ bool tlb::hasMapping(unsigned int vpn)
 
 
 /**
- * @brief - inserts mapping of this vpn to the given pfn. Handles if cache is
- * AT CAPACITY
+ * @brief - returns the pfn cached for vpn in the current address space
+ * @param vpn - vpn hasMapping returned true for
+ */
+unsigned int tlb::getMapping(unsigned int vpn)
+{
+    return vpn2pfn[key(vpn)];
+}
+
+
+/**
+ * @brief - map key of vpn in the current address space
+ * @param vpn - vpn to build the key for
+ */
+unsigned long long tlb::key(unsigned int vpn)
+{
+    return ((unsigned long long)asid << ASID_SHIFT) | vpn;
+}
+
+
+/**
+ * @brief - notes a key leaving the tlb through replacement. It only counts as a context switch
+ * loss when another address space pushed it out
+ * @param victim - key being evicted
+ */
+void tlb::evicted(unsigned long long victim)
+{
+    if ((victim >> ASID_SHIFT) != asid) {
+        lostToSwitch.insert(victim);
+    }
+}
+
+
+/**
+ * @brief - inserts mapping of this vpn to the given pfn and marks it most recently used.
+ * Handles if cache is AT CAPACITY
  * @param vpn - vpn to map
  * @param frameNum - pfn to map vpn to
  */
 void tlb::insertMapping(unsigned int vpn, unsigned int frameNum)
 {
+    unsigned long long k = key(vpn);
+    if (!lostToSwitch.empty() && lostToSwitch.erase(k) > 0) {
+        switchMisses++;
+    }
+
+    if (policy != NULL) {
+        // flushed slots are reused first, then slots are handed out in order until the tlb is
+        // full, then the policy picks a victim
+        unsigned int slot;
+        if (!freeSlots.empty()) {
+            slot = freeSlots.back();
+            freeSlots.pop_back();
+            slotVpn[slot] = k;
+        }
+        else if (slotVpn.size() < (unsigned int)capacity) {
+            slot = slotVpn.size();
+            slotVpn.push_back(k);
+        }
+        else {
+            slot = policy->victim();
+            policy->onRemove(slot);
+            evicted(slotVpn[slot]);
+            vpn2pfn.erase(slotVpn[slot]);
+            vpn2slot.erase(slotVpn[slot]);
+            slotVpn[slot] = k;
+        }
+        vpn2slot[k] = slot;
+        vpn2pfn[k] = frameNum;
+        policy->onInsert(slot);
+        return;
+    }
+
     // if tlb at capacity need to erase the least recent used address
     if (vpn2pfn.size() >= capacity) {
+        evicted(recentPagesQueue.front());
         vpn2pfn.erase(recentPagesQueue.front());     // erase least recently used
         recentPagesQueue.pop_front();       // erase this from queue as well
     }
 
-    vpn2pfn[vpn] = frameNum;
+    vpn2pfn[k] = frameNum;
+    updateQueue(k);
+}
+
+
+/**
+ * @brief - removes vpn from the tlb if it's there. Its policy slot is freed for the next insert
+ * @param vpn - vpn in the current address space that is no longer mapped
+ */
+void tlb::invalidate(unsigned int vpn)
+{
+    invalidateKey(key(vpn));
+}
+
+
+/**
+ * @brief - removes vpn of another address space from the tlb if it's there, e.g. when a process
+ * that isn't running loses its page to a --frames eviction
+ * @param vpn - vpn that is no longer mapped
+ * @param asid - address space vpn belongs to
+ */
+void tlb::invalidate(unsigned int vpn, unsigned int asid)
+{
+    invalidateKey(((unsigned long long)asid << ASID_SHIFT) | vpn);
+}
+
+
+/**
+ * @brief - drops the entry of key k. Its policy slot is freed for the next insert
+ */
+void tlb::invalidateKey(unsigned long long k)
+{
+    if (vpn2pfn.erase(k) == 0) {
+        return;
+    }
+    if (policy != NULL) {
+        unsigned int slot = vpn2slot[k];
+        policy->onRemove(slot);
+        freeSlots.push_back(slot);
+        vpn2slot.erase(k);
+    }
+    else {
+        eraseVpnFromQueue(k);
+    }
+}
+
+
+/**
+ * @brief - makes asid the current address space. With flush every entry is dropped and
+ * remembered as lost to the switch
+ * @param asid - address space of the process being switched to
+ * @param flush - true to model a TLB without ASID tags
+ */
+void tlb::switchAsid(unsigned int asid, bool flush)
+{
+    this->asid = asid;
+    if (!flush) {
+        return;
+    }
+
+    for (std::map<unsigned long long, unsigned int>::iterator it = vpn2pfn.begin(); it != vpn2pfn.end(); it++) {
+        lostToSwitch.insert(it->first);
+    }
+    if (policy != NULL) {
+        for (std::unordered_map<unsigned long long, unsigned int>::iterator it = vpn2slot.begin(); it != vpn2slot.end(); it++) {
+            policy->onRemove(it->second);
+            freeSlots.push_back(it->second);
+        }
+        vpn2slot.clear();
+    }
+    vpn2pfn.clear();
+    recentPagesQueue.clear();
+}
+
+
+/**
+ * @brief - records a hit on vpn with whichever replacement scheme is in use
+ * @param vpn - vpn that was found in the tlb
+ */
+void tlb::touch(unsigned int vpn)
+{
+    if (policy != NULL) {
+        policy->onHit(vpn2slot[key(vpn)]);
+    }
+    else {
+        updateQueue(key(vpn));
+    }
 }
 
 /**
  * @brief - checks if the recentPages Queue contains the given vpn
  * @param vpn - pageNumber to check for
  */
-bool tlb::queueContains(unsigned int vpn)
+bool tlb::queueContains(unsigned long long vpn)
 {
     for (int i = 0; i < recentPagesQueue.size(); i++) {
         if (recentPagesQueue[i] == vpn) return true;
@@ -83,7 +257,7 @@ bool tlb::queueContains(unsigned int vpn)
  * @brief - find vpn in queue and erase it from the queue
  * @param vpn - vpn to erase
  */
-void tlb::eraseVpnFromQueue(unsigned int vpn)
+void tlb::eraseVpnFromQueue(unsigned long long vpn)
 {
     for (int i = 0; i < recentPagesQueue.size(); i++) {
         if (recentPagesQueue[i] == vpn) {
@@ -98,7 +272,7 @@ void tlb::eraseVpnFromQueue(unsigned int vpn)
  * Also handles if queue is at max size of 10
  * @param recentVpn - vpn to add to recentQueue
  */
-void tlb::updateQueue(unsigned int recentVpn)
+void tlb::updateQueue(unsigned long long recentVpn)
 {
     if (queueContains(recentVpn)) {     // if queue contains vpn update vpn to most recent
         eraseVpnFromQueue(recentVpn);
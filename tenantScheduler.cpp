@@ -0,0 +1,192 @@
+#include <stdio.h>
+#include "tenantScheduler.h"
+#include "pageTable.h"
+
+
+/**
+ * @brief - constructor, no tenants yet
+ * @param pTable - shared pageTable whose counters are charged to the tenants
+ * @param cache - shared tlb for the context switch misses, or NULL
+ * @param quantum - records per slice for a tenant of weight 1
+ */
+TenantScheduler::TenantScheduler(PageTable* pTable, tlb* cache, unsigned long long quantum)
+{
+    this->pTable = pTable;
+    this->cache = cache;
+    this->quantum = quantum;
+    this->current = 0;
+    this->sliceLeft = 0;
+    this->active = 0;
+    this->lastRecords = 0;
+    this->lastTlbHits = 0;
+    this->lastPageTableHits = 0;
+    this->lastSwitchMisses = 0;
+    this->lastEvictions = 0;
+}
+
+
+TenantScheduler::~TenantScheduler()
+{
+    for (size_t i = 0; i < tenants.size(); i++) {
+        delete tenants[i].source;
+    }
+}
+
+
+/**
+ * @brief - adds the next tenant. The first one added runs first
+ * @param name - trace file name, for the report
+ * @param source - the tenant's trace, owned by the scheduler from now on
+ * @param weight - slices are quantum * weight records long
+ */
+void TenantScheduler::addTenant(const char* name, TraceSource* source, unsigned int weight)
+{
+    Tenant tenant;
+    tenant.name = name;
+    tenant.source = source;
+    tenant.weight = weight;
+    tenant.pos = 0;
+    tenant.ended = false;
+    tenant.slices = 0;
+    tenant.records = 0;
+    tenant.tlbHits = 0;
+    tenant.pageTableHits = 0;
+    tenant.switchMisses = 0;
+    tenant.evictions = 0;
+    tenant.soloRun = false;
+    tenant.soloTlbHits = 0;
+    tenant.soloPageTableHits = 0;
+    tenant.soloEvictions = 0;
+    tenants.push_back(tenant);
+    active++;
+
+    if (tenants.size() == 1) {
+        sliceLeft = quantum * weight;
+        tenants[0].slices++;
+    }
+}
+
+
+/**
+ * @brief - makes sure tenant has a record to hand out, reading the next TENANT_READAHEAD records of
+ * its trace when its buffer is used up
+ */
+bool TenantScheduler::refill(Tenant* tenant)
+{
+    if (tenant->pos < tenant->buffer.size()) {
+        return true;
+    }
+    if (tenant->ended) {
+        return false;
+    }
+    tenant->buffer.resize(TENANT_READAHEAD);
+    tenant->buffer.resize(tenant->source->nextBatch(tenant->buffer.data(), TENANT_READAHEAD));
+    tenant->pos = 0;
+    if (tenant->buffer.empty()) {
+        tenant->ended = true;
+        active--;
+        return false;
+    }
+    return true;
+}
+
+
+/**
+ * @brief - --frames evictions so far
+ */
+unsigned long long TenantScheduler::evictions()
+{
+    return pTable->frames != NULL ? pTable->frames->cleanEvictions + pTable->frames->dirtyEvictions : 0;
+}
+
+
+/**
+ * @brief - charges the counters since the last switch to the running tenant
+ */
+void TenantScheduler::settle()
+{
+    Tenant* tenant = &tenants[current];
+    tenant->records += pTable->addressCount - lastRecords;
+    tenant->tlbHits += pTable->countTlbHits - lastTlbHits;
+    tenant->pageTableHits += pTable->countPageTableHits - lastPageTableHits;
+    tenant->evictions += evictions() - lastEvictions;
+    lastRecords = pTable->addressCount;
+    lastTlbHits = pTable->countTlbHits;
+    lastPageTableHits = pTable->countPageTableHits;
+    lastEvictions = evictions();
+    if (cache != NULL) {
+        tenant->switchMisses += cache->switchMisses - lastSwitchMisses;
+        lastSwitchMisses = cache->switchMisses;
+    }
+}
+
+
+/**
+ * @brief - ends the running slice and starts one for the next tenant whose trace hasn't ended
+ */
+void TenantScheduler::switchTenant()
+{
+    settle();
+    do {
+        current = (current + 1) % tenants.size();
+    } while (tenants[current].ended && active > 0);
+    sliceLeft = quantum * tenants[current].weight;
+    tenants[current].slices++;
+}
+
+
+/**
+ * @brief - hands out the next record of the running tenant with proc set to the tenant's number,
+ * switching tenants when its slice is used up or its trace ends
+ * @param record - filled with the next record
+ * @return false once every tenant's trace has ended
+ */
+bool TenantScheduler::next(p2AddrTr* record)
+{
+    while (active > 0) {
+        Tenant* tenant = &tenants[current];
+        if (sliceLeft > 0 && refill(tenant)) {
+            *record = tenant->buffer[tenant->pos++];
+            record->proc = current;
+            sliceLeft--;
+            return true;
+        }
+        if (active > 0) {
+            switchTenant();
+        }
+    }
+    return false;
+}
+
+
+/**
+ * @brief - prints every tenant's slices, hits and faults in the shared run, and with a solo run the
+ * extra TLB misses and faults that sharing the machine cost it
+ */
+void TenantScheduler::report()
+{
+    settle();
+    printf("Tenants: %lu, quantum: %llu records\n", (unsigned long)tenants.size(), quantum);
+    for (size_t i = 0; i < tenants.size(); i++) {
+        Tenant* tenant = &tenants[i];
+        unsigned long long misses = tenant->records - tenant->tlbHits;
+        unsigned long long faults = misses - tenant->pageTableHits;
+        printf("  Tenant %lu (%s): weight: %u, slices: %llu, records: %llu\n",
+            (unsigned long)i, tenant->name.c_str(), tenant->weight, tenant->slices, tenant->records);
+        printf("    Shared: TLB hits: %llu (%.2f%%), page table hits: %llu, faults: %llu, evictions: %llu, TLB misses lost to other tenants: %llu\n",
+            tenant->tlbHits, tenant->records ? (double)tenant->tlbHits / tenant->records * 100.0 : 0.0,
+            tenant->pageTableHits, faults, tenant->evictions, tenant->switchMisses);
+        if (!tenant->soloRun) {
+            continue;
+        }
+        unsigned long long soloMisses = tenant->records - tenant->soloTlbHits;
+        unsigned long long soloFaults = soloMisses - tenant->soloPageTableHits;
+        printf("    Solo:   TLB hits: %llu (%.2f%%), page table hits: %llu, faults: %llu, evictions: %llu\n",
+            tenant->soloTlbHits, tenant->records ? (double)tenant->soloTlbHits / tenant->records * 100.0 : 0.0,
+            tenant->soloPageTableHits, soloFaults, tenant->soloEvictions);
+        printf("    Interference: TLB misses: %+lld (%.2fx solo), faults: %+lld (%.2fx solo)\n",
+            (long long)(misses - soloMisses), soloMisses ? (double)misses / soloMisses : 0.0,
+            (long long)(faults - soloFaults), soloFaults ? (double)faults / soloFaults : 0.0);
+    }
+    fflush(stdout);
+}
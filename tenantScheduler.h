@@ -0,0 +1,86 @@
+#ifndef TENANTSCHEDULER
+#define TENANTSCHEDULER
+
+#include <string>
+#include <vector>
+#include "traceSource.h"
+#include "tlb.h"
+
+class PageTable;
+
+#define DEFAULT_QUANTUM 10000           // records a tenant runs before the next one is scheduled
+#define TENANT_READAHEAD 65536          // records read ahead from each tenant's trace at a time
+
+
+/**
+ * @brief - --tenant, several trace files consolidated on one machine. Every trace is a tenant with
+ * its own address space (its records get proc = tenant number, so --asid gives it its own page
+ * table) and the tenants take turns in round robin slices of quantum * weight records, sharing the
+ * TLB and the --frames pool. A tenant whose trace ends drops out of the rotation.
+ *
+ * Each trace is read ahead TENANT_READAHEAD records at a time, so switching tenants every few
+ * thousand records doesn't turn into small reads spread over every file.
+ *
+ * Slices are handed out as records are asked for, after the previous record was simulated, so the
+ * counter changes between two switches belong to the tenant whose slice just ended.
+ */
+class TenantScheduler : public TraceSource
+{
+public:
+    // pTable and cache supply the counters charged to each slice, cache may be NULL
+    TenantScheduler(PageTable* pTable, tlb* cache, unsigned long long quantum);
+    ~TenantScheduler();     // deletes the tenants' sources
+
+    void addTenant(const char* name, TraceSource* source, unsigned int weight);
+    bool next(p2AddrTr* record);
+
+    void settle();          // charges the counters since the last switch to the running tenant
+    void report();          // per tenant results next to their solo runs
+
+    struct Tenant
+    {
+        std::string name;
+        TraceSource* source;
+        unsigned int weight;
+        std::vector<p2AddrTr> buffer;   // read ahead records
+        size_t pos;                     // next record of buffer to hand out
+        bool ended;
+
+        // shared run, charged at every switch
+        unsigned long long slices;
+        unsigned long long records;
+        unsigned long long tlbHits;
+        unsigned long long pageTableHits;
+        unsigned long long switchMisses;    // TLB misses on entries lost to another tenant
+        unsigned long long evictions;       // --frames evictions caused by the tenant's faults
+
+        // the same records run alone on the machine, filled in by the caller before report
+        bool soloRun;
+        unsigned long long soloTlbHits;
+        unsigned long long soloPageTableHits;
+        unsigned long long soloEvictions;
+    };
+
+    std::vector<Tenant> tenants;
+    unsigned long long quantum;
+
+private:
+    PageTable* pTable;
+    tlb* cache;
+    size_t current;                     // tenant running now
+    unsigned long long sliceLeft;       // records left in its slice
+    size_t active;                      // tenants whose trace hasn't ended
+
+    // counters at the last switch
+    unsigned long long lastRecords;
+    unsigned long long lastTlbHits;
+    unsigned long long lastPageTableHits;
+    unsigned long long lastSwitchMisses;
+    unsigned long long lastEvictions;
+
+    bool refill(Tenant* tenant);        // false once tenant's trace is exhausted
+    void switchTenant();
+    unsigned long long evictions();
+};
+
+#endif
@@ -0,0 +1,424 @@
+#include <string.h>
+#include <unistd.h>
+#include <algorithm>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "textTrace.h"
+
+// the newline scan compares 16 bytes at once with SSE2 where it is always available, and falls back
+// to two 8 byte words elsewhere
+#if defined(__GNUC__) && defined(__SSE2__)
+#define TEXTTRACE_SSE2 1
+#include <emmintrin.h>
+#endif
+
+#define BYTES(x) (0x0101010101010101ULL * (x))     // x in every byte of a word
+
+static const uint64_t powersOf10[9] = { 1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000 };
+
+
+/**
+ * @brief - 8 bytes from p as a word with p[0] in the lowest byte
+ */
+static inline uint64_t loadWord(const char* p)
+{
+    uint64_t word;
+    memcpy(&word, p, 8);
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    word = __builtin_bswap64(word);
+#endif
+    return word;
+}
+
+
+/**
+ * @brief - bit i is set if p[i] is a newline, for the 16 bytes from p
+ */
+static inline unsigned int newlineMask(const char* p)
+{
+#ifdef TEXTTRACE_SSE2
+    __m128i chunk = _mm_loadu_si128((const __m128i*)p);
+    return (unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, _mm_set1_epi8('\n')));
+#else
+    unsigned int mask = 0;
+    for (int half = 0; half < 2; half++) {
+        uint64_t word = loadWord(p + 8 * half) ^ BYTES('\n');
+        uint64_t zero = ~(((word & BYTES(0x7F)) + BYTES(0x7F)) | word) & BYTES(0x80);
+        mask |= (unsigned int)(((zero >> 7) * 0x0102040810204080ULL) >> 56) << (8 * half);
+    }
+    return mask;
+#endif
+}
+
+
+/**
+ * @brief - high bit of every byte of word that isn't an ASCII decimal digit
+ */
+static inline uint64_t nonDigits(uint64_t word)
+{
+    uint64_t digit = word ^ BYTES('0');     // '0'..'9' -> 0..9
+    return (((digit & BYTES(0x7F)) + BYTES(0x76)) | digit) & BYTES(0x80);
+}
+
+
+/**
+ * @brief - high bit of every byte of word that isn't an ASCII hex digit of either case
+ */
+static inline uint64_t nonHexDigits(uint64_t word)
+{
+    uint64_t digit = word ^ BYTES('0');
+    uint64_t letter = (word | BYTES(0x20)) ^ BYTES(0x60);      // 'a'..'f' and 'A'..'F' -> 1..6
+    uint64_t notDigit = (((digit & BYTES(0x7F)) + BYTES(0x76)) | digit) & BYTES(0x80);
+    uint64_t above6 = (((letter & BYTES(0x7F)) + BYTES(0x79)) | letter) & BYTES(0x80);
+    uint64_t zero = ~(((letter & BYTES(0x7F)) + BYTES(0x7F)) | letter) & BYTES(0x80);
+    return notDigit & (above6 | zero);
+}
+
+
+/**
+ * @brief - leading digits of a word given its non digit mask, 8 if every byte is a digit
+ */
+static inline unsigned int digitCount(uint64_t nonDigitMask)
+{
+    return nonDigitMask != 0 ? __builtin_ctzll(nonDigitMask) >> 3 : 8;
+}
+
+
+/**
+ * @brief - moves the first count bytes of word to its top, zeroing the rest. Zero bytes read as
+ * leading zeros in eightDigits and eightHexDigits
+ */
+static inline uint64_t alignDigits(uint64_t word, unsigned int count)
+{
+    return (word << ((64 - 8 * count) & 63)) & (0 - (uint64_t)(count > 0));
+}
+
+
+/**
+ * @brief - value of 8 decimal digit bytes, the most significant in the lowest byte
+ */
+static inline uint64_t eightDigits(uint64_t word)
+{
+    word = ((word & BYTES(0x0F)) * (10 * 256 + 1)) >> 8;
+    word = ((word & 0x00FF00FF00FF00FFULL) * (100 * 65536 + 1)) >> 16;
+    return ((word & 0x0000FFFF0000FFFFULL) * (10000ULL * 4294967296ULL + 1)) >> 32;
+}
+
+
+/**
+ * @brief - value of 8 hex digit bytes, the most significant in the lowest byte
+ */
+static inline uint64_t eightHexDigits(uint64_t word)
+{
+    word = (word & BYTES(0x0F)) + ((word >> 6) & BYTES(0x01)) * 9;     // letters have 0x40 set
+    word = ((word << 4) & 0x00F000F000F000F0ULL) | ((word >> 8) & 0x000F000F000F000FULL);
+    word = ((word << 8) & 0x0000FF000000FF00ULL) | ((word >> 16) & 0x000000FF000000FFULL);
+    return ((word << 16) & 0x00000000FFFF0000ULL) | ((word >> 32) & 0x000000000000FFFFULL);
+}
+
+
+/**
+ * @brief - parses up to 16 decimal digits from p with two word loads and no per digit branches
+ * @param count - set to the number of digits, 16 if there may be more
+ */
+static inline uint64_t parseDecimal(const char* p, unsigned int* count)
+{
+    uint64_t first = loadWord(p);
+    uint64_t second = loadWord(p + 8);
+    unsigned int firstCount = digitCount(nonDigits(first));
+    unsigned int secondCount = firstCount == 8 ? digitCount(nonDigits(second)) : 0;
+    *count = firstCount + secondCount;
+    return eightDigits(alignDigits(first, firstCount)) * powersOf10[secondCount]
+        + eightDigits(alignDigits(second, secondCount));
+}
+
+
+/**
+ * @brief - parseDecimal for hex digits
+ */
+static inline uint64_t parseHex(const char* p, unsigned int* count)
+{
+    uint64_t first = loadWord(p);
+    uint64_t second = loadWord(p + 8);
+    unsigned int firstCount = digitCount(nonHexDigits(first));
+    unsigned int secondCount = firstCount == 8 ? digitCount(nonHexDigits(second)) : 0;
+    *count = firstCount + secondCount;
+    return (eightHexDigits(alignDigits(first, firstCount)) << (4 * secondCount))
+        | eightHexDigits(alignDigits(second, secondCount));
+}
+
+
+/**
+ * @brief - parses the line at p into record. Reads at most 16 bytes past the newline ending it
+ * @return false if the line isn't an address, including blank and comment lines
+ */
+static inline bool parseLine(const char* p, p2AddrTr* record)
+{
+    while (*p == ' ' || *p == '\t') {
+        p++;
+    }
+    bool hex = p[0] == '0' && (p[1] | 0x20) == 'x';
+    p += hex ? 2 : 0;
+    unsigned int count;
+    uint64_t value = hex ? parseHex(p, &count) : parseDecimal(p, &count);
+
+    const char* column = p + count;
+    bool ended = *column == ' ' || *column == '\t' || *column == ',' || *column == '\r' || *column == '\n';
+    while (*column == ' ' || *column == '\t' || *column == ',') {
+        column++;
+    }
+    record->addr = (uint32_t)value;
+    record->reqtype = (*column | 0x20) == 'w' ? MEMWRITE : MEMREAD;
+    record->size = 4;
+    record->attr = 0;
+    record->proc = 0;
+    record->time = 0;
+    return count > 0 && ended && (value >> 32) == 0;
+}
+
+
+/**
+ * @brief - constructor maps the whole file, or reads it if it can't be mapped
+ * @param traceFile - FILE* opened with fopen in "rb" mode
+ */
+TextTraceSource::TextTraceSource(FILE* traceFile)
+{
+    this->traceFile = traceFile;
+    this->data = NULL;
+    this->size = 0;
+    this->mapped = false;
+    this->lineNum = 0;
+    this->skippedLines = 0;
+    this->buf = NULL;
+    this->scanEnd = 0;
+    this->chunk = 0;
+    this->newlines = 0;
+    this->lineStart = 0;
+    this->inTail = false;
+    this->tailBase = 0;
+    this->recordNum = 0;
+    this->linesSeen = 0;
+
+    struct stat info;
+    if (fstat(fileno(traceFile), &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0) {
+        void* map = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fileno(traceFile), 0);
+        if (map != MAP_FAILED) {
+            madvise(map, info.st_size, MADV_SEQUENTIAL);
+            this->data = (const char*)map;
+            this->size = info.st_size;
+            this->mapped = true;
+        }
+    }
+
+    if (mapped) {
+        buf = data;
+        scanEnd = size;
+    }
+    else {
+        // the whole file goes into the padded tail buffer
+        char block[1 << 16];
+        size_t got;
+        rewind(traceFile);
+        while ((got = fread(block, 1, sizeof(block), traceFile)) > 0) {
+            tail.insert(tail.end(), block, block + got);
+        }
+        startTail();
+    }
+}
+
+
+TextTraceSource::~TextTraceSource()
+{
+    if (skippedLines > TEXT_MAX_WARNINGS) {
+        fprintf(stderr, "%llu malformed text trace lines skipped\n", skippedLines);
+    }
+    if (mapped) {
+        munmap((void*)data, size);
+    }
+    fclose(traceFile);
+}
+
+
+bool TextTraceSource::isValid()
+{
+    return mapped || !ferror(traceFile);
+}
+
+
+/**
+ * @brief - continues the scan in the tail buffer with the lines from lineStart on, ended by a
+ * newline even if the file's last line isn't, and padded so the scan and the parser can read
+ * past the last line
+ */
+void TextTraceSource::startTail()
+{
+    if (mapped) {
+        tail.assign(data + lineStart, data + size);
+        tailBase = lineStart;
+    }
+    if (!tail.empty() && tail.back() != '\n') {
+        tail.push_back('\n');
+    }
+    scanEnd = tail.size();
+    tail.resize(scanEnd + 16 + TEXT_TAIL_PADDING, '\0');
+    buf = tail.data();
+    chunk = 0;
+    newlines = 0;
+    lineStart = 0;
+    inTail = true;
+}
+
+
+/**
+ * @brief - finds the newline ending the line at lineStart
+ * @param lineEnd - set to the offset of the newline in buf
+ * @return false at end of trace
+ */
+bool TextTraceSource::nextLine(size_t* lineEnd)
+{
+    while (newlines == 0) {
+        // a line found in a chunk is only parsed in place if TEXT_TAIL_PADDING bytes follow the chunk
+        if (inTail ? chunk >= scanEnd : chunk + 16 + TEXT_TAIL_PADDING > scanEnd) {
+            if (inTail) {
+                return false;
+            }
+            startTail();
+            continue;
+        }
+        newlines = newlineMask(buf + chunk);
+        chunk += 16;
+    }
+    *lineEnd = chunk - 16 + __builtin_ctz(newlines);
+    newlines &= newlines - 1;
+    return true;
+}
+
+
+/**
+ * @brief - reports a malformed line on stderr, unless it is blank or a comment
+ */
+void TextTraceSource::malformed(const char* line)
+{
+    const char* p = line;
+    while (*p == ' ' || *p == '\t') {
+        p++;
+    }
+    if (*p == '\n' || *p == '\r' || *p == '#' || lineNum <= linesSeen) {
+        return;
+    }
+    skippedLines++;
+    if (skippedLines <= TEXT_MAX_WARNINGS) {
+        int len = (int)(strchr(line, '\n') - line);
+        fprintf(stderr, "Text trace line %llu is not an address, skipped: %.*s\n", lineNum, len, line);
+    }
+}
+
+
+/**
+ * @brief - reads the next record
+ * @param record - filled with the next record
+ */
+bool TextTraceSource::next(p2AddrTr* record)
+{
+    return nextBatch(record, 1) == 1;
+}
+
+
+/**
+ * @brief - parses lines until max records are read or the trace ends
+ * @param records - array of at least max records to fill
+ * @param max - maximum number of records to read
+ */
+size_t TextTraceSource::nextBatch(p2AddrTr* records, size_t max)
+{
+    size_t count = 0;
+    size_t lineEnd;
+    while (count < max && nextLine(&lineEnd)) {
+        const char* line = buf + lineStart;
+        size_t offset = (inTail ? tailBase : 0) + lineStart;
+        lineStart = lineEnd + 1;
+        lineNum++;
+        if (parseLine(line, &records[count])) {
+            if (recordNum % TEXT_INDEX_RECORDS == 0 && recordNum / TEXT_INDEX_RECORDS == index.size()) {
+                IndexEntry entry = { offset, lineNum - 1 };
+                index.push_back(entry);
+            }
+            recordNum++;
+            count++;
+        }
+        else {
+            malformed(line);
+        }
+        linesSeen = std::max(linesSeen, lineNum);
+    }
+    return count;
+}
+
+
+/**
+ * @brief - restarts the scan at the line starting at file offset. A mapped file is scanned in place
+ * again until its last lines, which startTail copies again. A file that was read is all in tail
+ */
+void TextTraceSource::jumpTo(size_t offset)
+{
+    if (mapped) {
+        buf = data;
+        scanEnd = size;
+        inTail = false;
+    }
+    lineStart = offset;
+    chunk = offset & ~(size_t)15;
+    newlines = 0;
+    if (!inTail && chunk + 16 + TEXT_TAIL_PADDING > scanEnd) {
+        startTail();
+        return;
+    }
+    if (chunk < scanEnd) {
+        newlines = newlineMask(buf + chunk) & (~0u << (offset & 15));
+        chunk += 16;
+    }
+}
+
+
+/**
+ * @brief - continues from the nearest indexed record at or before recordNum, or from the current
+ * record if that is nearer, parsing forward to it
+ * @param recordNum - zero based record to seek to
+ * @return false if the trace has fewer records
+ */
+bool TextTraceSource::seekRecord(unsigned long long recordNum)
+{
+    // index[0] exists as soon as a record was read, before that there is nothing to go back to
+    if (!index.empty()) {
+        size_t slot = std::min((size_t)(recordNum / TEXT_INDEX_RECORDS), index.size() - 1);
+        unsigned long long indexed = (unsigned long long)slot * TEXT_INDEX_RECORDS;
+        if (recordNum < this->recordNum || indexed > this->recordNum) {
+            jumpTo(index[slot].offset);
+            lineNum = index[slot].lineNum;
+            this->recordNum = indexed;
+        }
+    }
+
+    p2AddrTr skipped[64];
+    while (this->recordNum < recordNum) {
+        if (nextBatch(skipped, std::min((unsigned long long)64, recordNum - this->recordNum)) == 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+/**
+ * @brief - checks the first bytes of a trace file for text
+ * @param bytes - the first len bytes of the file
+ */
+bool isTextTrace(const unsigned char* bytes, size_t len)
+{
+    for (size_t i = 0; i < len; i++) {
+        if ((bytes[i] < 0x20 || bytes[i] > 0x7E) && bytes[i] != '\n' && bytes[i] != '\r' && bytes[i] != '\t') {
+            return false;
+        }
+    }
+    return len > 0;
+}
@@ -0,0 +1,81 @@
+#ifndef TEXTTRACE
+#define TEXTTRACE
+
+#include <stdio.h>
+#include <vector>
+#include "traceSource.h"
+
+#define TEXT_SNIFF_BYTES 4096           // bytes checked for printable text when a trace is opened
+#define TEXT_TAIL_PADDING 32            // readable bytes the parser needs past the newline of a line
+#define TEXT_MAX_WARNINGS 10            // malformed lines reported before the rest are only counted
+#define TEXT_INDEX_RECORDS 65536        // records between seek index entries
+
+
+/**
+ * @brief - text trace, one address per line, decimal or 0x prefixed hex, optionally followed by a
+ * R or W column separated by spaces, tabs or a comma. W lines are MEMWRITE, everything else is
+ * MEMREAD by proc 0. Blank lines and lines starting with # are skipped, malformed lines are reported
+ * on stderr and skipped.
+ *
+ * The file is mapped whole and read front to back. nextBatch finds the newlines 16 bytes at a time
+ * and parses every address with whole-word digit classification and conversion, so only blank,
+ * comment and malformed lines branch off the straight path. The last few lines, where the parser's
+ * loads would run past the mapping, are copied to a zero padded buffer first.
+ *
+ * Text lines have no fixed size, so the file offset of every TEXT_INDEX_RECORDS-th record is noted
+ * as it is read. seekRecord jumps to the nearest noted record at or before the target and only
+ * parses the lines from there, at most TEXT_INDEX_RECORDS of them once the trace has been read.
+ */
+class TextTraceSource : public TraceSource
+{
+public:
+    // takes ownership of an already opened trace file
+    TextTraceSource(FILE* traceFile);
+    ~TextTraceSource();
+
+    bool isValid();     // false if the file couldn't be mapped or read
+    bool next(p2AddrTr* record);
+    size_t nextBatch(p2AddrTr* records, size_t max);
+    bool seekRecord(unsigned long long recordNum);
+
+    unsigned long long lineNum;         // lines consumed so far
+    unsigned long long skippedLines;    // malformed lines
+
+private:
+    FILE* traceFile;
+    const char* data;       // the mapped file. NULL if it couldn't be mapped and was read into tail instead
+    size_t size;
+    bool mapped;
+
+    // scan state. Newlines are found in 16 byte chunks of buf, newlines holds the ones in the chunk
+    // at chunk that haven't been handed to the parser yet
+    const char* buf;
+    size_t scanEnd;         // chunks at or past scanEnd aren't scanned in buf
+    size_t chunk;
+    unsigned int newlines;
+    size_t lineStart;
+    bool inTail;
+    std::vector<char> tail;     // the last lines with a newline and TEXT_TAIL_PADDING zero bytes after them
+    size_t tailBase;            // file offset of tail[0]
+
+    // seek index. index[i] is where record i * TEXT_INDEX_RECORDS starts
+    struct IndexEntry
+    {
+        size_t offset;                  // file offset of the line
+        unsigned long long lineNum;     // lines before it
+    };
+    std::vector<IndexEntry> index;
+    unsigned long long recordNum;       // records returned so far
+    unsigned long long linesSeen;       // furthest line read, so lines read again aren't reported twice
+
+    bool nextLine(size_t* lineEnd);
+    void startTail();
+    void jumpTo(size_t offset);
+    void malformed(const char* line);
+};
+
+
+// true if the first bytes of a trace file are all printable ASCII or whitespace
+bool isTextTrace(const unsigned char* bytes, size_t len);
+
+#endif
@@ -3,9 +3,15 @@
 
 #include <map>
 #include <deque>
+#include <vector>
+#include <unordered_map>
+#include <unordered_set>
+#include "replacementPolicy.h"
+#include "tlbPrefetcher.h"
 #include "math.h"
 #define MEMORY_SPACE_SIZE 32
 #define MAX_QUEUE_SIZE 10
+#define ASID_SHIFT 32       // entries are keyed on (asid << ASID_SHIFT) | vpn
 
 
 class tlb
@@ -13,12 +19,30 @@ class tlb
 public:
     // constructor
     tlb(int vpnNumBits, int capacity);
+    tlb(int vpnNumBits, int capacity, const char* policyName, unsigned int seed);
 
-    // cache mapping of vpn 2 pfn
-    std::map<unsigned int /*vpn*/, unsigned int /*pfn*/> vpn2pfn;
+    // cache mapping of vpn 2 pfn. Keys carry the asid of the entry above ASID_SHIFT
+    std::map<unsigned long long /*asid, vpn*/, unsigned int /*pfn*/> vpn2pfn;
 
     // queue of most recently accessed pages. Used to determine which mapping to remove from cache
-    std::deque<unsigned int> recentPagesQueue;    // always be size 10
+    std::deque<unsigned long long> recentPagesQueue;    // always be size 10
+
+    // --tlb-policy replacement. NULL keeps the recent pages queue above
+    ReplacementPolicy* policy;
+    std::vector<unsigned long long> slotVpn;            // key held by each policy slot
+    std::vector<unsigned int> freeSlots;                // slots emptied by flush
+    std::unordered_map<unsigned long long, unsigned int> vpn2slot;
+
+    // --prefetch, NULL for demand fills only. processNextAddress drives it on every miss
+    TlbPrefetcher* prefetcher;
+
+    // address space lookups and inserts are made in. Stays 0 unless --asid is given
+    unsigned int asid;
+
+    // context switch accounting. Keys removed by a flush or evicted by another address space are
+    // remembered, and a miss on one of them is counted as caused by a context switch
+    std::unordered_set<unsigned long long> lostToSwitch;
+    unsigned int switchMisses;
 
     // cache information
     int capacity;   // capacity of cache
@@ -30,12 +54,24 @@ public:
     // cache methods
     bool usingTlb();
     bool hasMapping(unsigned int vpn);
-    void insertMapping(unsigned int vpn, unsigned int frameNum);
+    unsigned int getMapping(unsigned int vpn);      // pfn of a vpn hasMapping found
+    void insertMapping(unsigned int vpn, unsigned int frameNum);     // also marks vpn most recently used
+    void touch(unsigned int vpn);       // records a hit on vpn
+    void invalidate(unsigned int vpn);  // drops vpn's entry, e.g. when its page is evicted
+    void invalidate(unsigned int vpn, unsigned int asid);   // same for a page of address space asid
+
+    // context switch to address space asid. flush drops every entry, as on a TLB without ASIDs
+    void switchAsid(unsigned int asid, bool flush);
 
     // queue methods
-    void updateQueue(unsigned int recentVpn);
-    bool queueContains(unsigned int vpn);
-    void eraseVpnFromQueue(unsigned int vpn);
+    void updateQueue(unsigned long long recentVpn);
+    bool queueContains(unsigned long long vpn);
+    void eraseVpnFromQueue(unsigned long long vpn);
+
+private:
+    unsigned long long key(unsigned int vpn);
+    void invalidateKey(unsigned long long k);
+    void evicted(unsigned long long victim);
 
 
 
@@ -0,0 +1,275 @@
+#include <stdio.h>
+#include <string.h>
+#include "tlbHierarchy.h"
+
+
+/**
+ * @brief - constructor allocates entries invalid slots split into entries / ways sets
+ * @param name - label used by report
+ * @param entries - total number of translations the level holds
+ * @param ways - associativity. ways == entries makes the level fully associative
+ * @param policy - replacement policy name, see createReplacementPolicy
+ * @param seed - rng seed for the random and brrip policies
+ */
+TlbLevel::TlbLevel(const char* name, unsigned int entries, unsigned int ways, const char* policy, unsigned int seed)
+{
+    this->name = name;
+    this->entries = entries;
+    this->ways = ways;
+    this->numSets = entries / ways;
+    strncpy(this->policy, policy, TLB_POLICY_NAME_LEN - 1);
+    this->policy[TLB_POLICY_NAME_LEN - 1] = '\0';
+    this->hits = 0;
+    this->misses = 0;
+    this->evictions = 0;
+
+    Entry empty;
+    empty.vpn = 0;
+    empty.frameNum = 0;
+    empty.valid = false;
+    slots.assign(entries, empty);
+    for (unsigned int set = 0; set < numSets; set++) {
+        policies.push_back(createReplacementPolicy(policy, ways, seed + set));
+    }
+}
+
+
+/**
+ * @brief - returns the way of vpn's set holding vpn, or -1
+ * @param vpn - page number to search the set for
+ */
+int TlbLevel::find(unsigned int vpn)
+{
+    Entry* set = &slots[(vpn % numSets) * ways];
+    for (unsigned int i = 0; i < ways; i++) {
+        if (set[i].valid && set[i].vpn == vpn) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+
+/**
+ * @brief - looks vpn up and counts the hit or miss
+ * @param vpn - page number to translate
+ * @param frameNum - set to the cached frame on a hit
+ */
+bool TlbLevel::lookup(unsigned int vpn, unsigned int* frameNum)
+{
+    int way = find(vpn);
+    if (way < 0) {
+        misses++;
+        return false;
+    }
+    hits++;
+    unsigned int set = vpn % numSets;
+    *frameNum = slots[set * ways + way].frameNum;
+    policies[set]->onHit(way);
+    return true;
+}
+
+
+/**
+ * @brief - inserts vpn into its set, using an invalid way if there is one, otherwise the way the
+ * set's replacement policy picks
+ * @param vpn - page number to insert
+ * @param frameNum - frame it maps to
+ * @param evictedVpn - set to the replaced vpn if a valid entry was replaced
+ * @param evictedFrame - set to the replaced frame if a valid entry was replaced
+ */
+bool TlbLevel::insert(unsigned int vpn, unsigned int frameNum, unsigned int* evictedVpn, unsigned int* evictedFrame)
+{
+    unsigned int set = vpn % numSets;
+    Entry* setSlots = &slots[set * ways];
+    int way = find(vpn);
+    bool evicted = false;
+
+    if (way >= 0) {
+        setSlots[way].frameNum = frameNum;
+        policies[set]->onHit(way);
+        return false;
+    }
+
+    for (unsigned int i = 0; i < ways && way < 0; i++) {
+        if (!setSlots[i].valid) {
+            way = i;
+        }
+    }
+    if (way < 0) {
+        way = policies[set]->victim();
+        policies[set]->onRemove(way);
+        evicted = true;
+        evictions++;
+        *evictedVpn = setSlots[way].vpn;
+        *evictedFrame = setSlots[way].frameNum;
+    }
+
+    setSlots[way].vpn = vpn;
+    setSlots[way].frameNum = frameNum;
+    setSlots[way].valid = true;
+    policies[set]->onInsert(way);
+    return evicted;
+}
+
+
+/**
+ * @brief - drops vpn from the level if present
+ * @param vpn - page number to remove
+ */
+bool TlbLevel::invalidate(unsigned int vpn)
+{
+    int way = find(vpn);
+    if (way < 0) {
+        return false;
+    }
+    unsigned int set = vpn % numSets;
+    slots[set * ways + way].valid = false;
+    policies[set]->onRemove(way);
+    return true;
+}
+
+
+/**
+ * @brief - constructor. Levels that are not simulated are passed as NULL
+ */
+TlbHierarchy::TlbHierarchy(TlbLevel* itlb, TlbLevel* dtlb, TlbLevel* stlb, bool exclusive)
+{
+    this->itlb = itlb;
+    this->dtlb = dtlb;
+    this->stlb = stlb;
+    this->exclusive = exclusive;
+    this->walks = 0;
+}
+
+
+/**
+ * @brief - instruction fetches go to the iTLB, every other request type to the dTLB
+ */
+TlbLevel* TlbHierarchy::l1For(unsigned char reqtype)
+{
+    return (reqtype == FETCH) ? itlb : dtlb;
+}
+
+
+/**
+ * @brief - puts vpn into l1. In exclusive mode the L1 victim moves down into the STLB
+ */
+void TlbHierarchy::fillL1(TlbLevel* l1, unsigned int vpn, unsigned int frameNum)
+{
+    unsigned int victimVpn, victimFrame;
+    if (l1 == nullptr) {
+        return;
+    }
+    if (l1->insert(vpn, frameNum, &victimVpn, &victimFrame) && exclusive && stlb != nullptr) {
+        unsigned int ignoredVpn, ignoredFrame;
+        stlb->insert(victimVpn, victimFrame, &ignoredVpn, &ignoredFrame);
+    }
+}
+
+
+/**
+ * @brief - probes the L1 picked by reqtype then the STLB. An STLB hit is copied (inclusive) or
+ * moved (exclusive) up into L1. Counts a walk when every level misses.
+ * @param vpn - page number to translate
+ * @param reqtype - trace record reqtype, routes the access to the iTLB or dTLB
+ * @param frameNum - set to the cached frame on a hit
+ */
+bool TlbHierarchy::lookup(unsigned int vpn, unsigned char reqtype, unsigned int* frameNum)
+{
+    TlbLevel* l1 = l1For(reqtype);
+    if (l1 != nullptr && l1->lookup(vpn, frameNum)) {
+        return true;
+    }
+    if (stlb != nullptr && stlb->lookup(vpn, frameNum)) {
+        if (exclusive && l1 != nullptr) {
+            stlb->invalidate(vpn);
+        }
+        fillL1(l1, vpn, *frameNum);
+        return true;
+    }
+    walks++;
+    return false;
+}
+
+
+/**
+ * @brief - installs the result of a page walk. Inclusive fills every level on the path and keeps
+ * L1 a subset of the STLB by back invalidating STLB victims. Exclusive fills only L1, unless
+ * there is no L1 for this request type.
+ * @param vpn - page number that was walked
+ * @param reqtype - trace record reqtype
+ * @param frameNum - frame returned by the walk
+ */
+void TlbHierarchy::fill(unsigned int vpn, unsigned char reqtype, unsigned int frameNum)
+{
+    TlbLevel* l1 = l1For(reqtype);
+    unsigned int victimVpn, victimFrame;
+
+    if (stlb != nullptr && (!exclusive || l1 == nullptr)) {
+        if (stlb->insert(vpn, frameNum, &victimVpn, &victimFrame) && !exclusive) {
+            if (itlb != nullptr) itlb->invalidate(victimVpn);
+            if (dtlb != nullptr) dtlb->invalidate(victimVpn);
+        }
+    }
+    fillL1(l1, vpn, frameNum);
+}
+
+
+/**
+ * @brief - shoots vpn down from every level
+ * @param vpn - page number that is no longer mapped
+ */
+void TlbHierarchy::invalidate(unsigned int vpn)
+{
+    TlbLevel* levels[] = { itlb, dtlb, stlb };
+    for (int i = 0; i < 3; i++) {
+        if (levels[i] != nullptr) {
+            levels[i]->invalidate(vpn);
+        }
+    }
+}
+
+
+/**
+ * @brief - prints hits and misses of each level and the remaining page walks
+ */
+void TlbHierarchy::report()
+{
+    TlbLevel* levels[] = { itlb, dtlb, stlb };
+    printf("TLB hierarchy (%s)\n", exclusive ? "exclusive" : "inclusive");
+    for (int i = 0; i < 3; i++) {
+        TlbLevel* level = levels[i];
+        if (level == nullptr) continue;
+        unsigned long long accesses = level->hits + level->misses;
+        printf("  %s: %u entries, %u ways, %s, hits: %llu, misses: %llu, hit percentage: %.2f%%\n",
+            level->name, level->entries, level->ways, level->policy, level->hits, level->misses,
+            accesses ? (double)level->hits / accesses * 100.0 : 0.0);
+    }
+    printf("  Page walks: %llu\n", walks);
+    fflush(stdout);
+}
+
+
+/**
+ * @brief - parses a level spec of the form entries:ways[:policy]
+ * @param name - label of the level
+ * @param spec - e.g. "64:4" or "1536:12:srrip"
+ * @param defaultPolicy - policy used when the spec doesn't name one
+ * @param seed - rng seed for the random and brrip policies
+ */
+TlbLevel* parseTlbLevel(const char* name, const char* spec, const char* defaultPolicy, unsigned int seed)
+{
+    unsigned int entries, ways;
+    char policy[TLB_POLICY_NAME_LEN];
+    strncpy(policy, defaultPolicy, TLB_POLICY_NAME_LEN - 1);
+    policy[TLB_POLICY_NAME_LEN - 1] = '\0';
+    int fields = sscanf(spec, "%u:%u:%15s", &entries, &ways, policy);
+    if (fields < 2 || entries == 0 || ways == 0 || entries % ways != 0) {
+        return NULL;
+    }
+    if (!isReplacementPolicy(policy)) {
+        return NULL;
+    }
+    return new TlbLevel(name, entries, ways, policy, seed);
+}
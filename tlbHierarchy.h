@@ -0,0 +1,88 @@
+#ifndef TLBHIERARCHY
+#define TLBHIERARCHY
+
+#include <vector>
+#include "tracereader.h"
+#include "replacementPolicy.h"
+
+#define TLB_POLICY_NAME_LEN 16
+
+
+/**
+ * @brief - one set-associative TLB level. vpns map to set (vpn % numSets) and any of its ways.
+ * Each set has its own ReplacementPolicy over its ways.
+ */
+class TlbLevel
+{
+public:
+    // constructor. entries must be a multiple of ways
+    TlbLevel(const char* name, unsigned int entries, unsigned int ways, const char* policy, unsigned int seed);
+
+    bool lookup(unsigned int vpn, unsigned int* frameNum);      // updates replacement state on hit
+    // inserts vpn. Returns true and fills evictedVpn/evictedFrame if a valid entry had to be replaced
+    bool insert(unsigned int vpn, unsigned int frameNum, unsigned int* evictedVpn, unsigned int* evictedFrame);
+    bool invalidate(unsigned int vpn);
+
+    const char* name;
+    unsigned int entries;
+    unsigned int ways;
+    unsigned int numSets;
+    char policy[TLB_POLICY_NAME_LEN];
+
+    // statistics
+    unsigned long long hits;
+    unsigned long long misses;
+    unsigned long long evictions;
+
+private:
+    struct Entry
+    {
+        unsigned int vpn;
+        unsigned int frameNum;
+        bool valid;
+    };
+
+    std::vector<Entry> slots;                   // numSets * ways, set major
+    std::vector<ReplacementPolicy*> policies;   // one per set
+
+    int find(unsigned int vpn);     // way holding vpn in its set, or -1
+};
+
+
+/**
+ * @brief - split L1 instruction/data TLBs backed by a unified second level STLB. Accesses are routed
+ * to the iTLB when the record's reqtype is FETCH and to the dTLB otherwise. Any level may be absent.
+ * Inclusive: a walk fills L1 and the STLB, and STLB evictions are invalidated in both L1s.
+ * Exclusive: a walk fills only L1, L1 victims move down into the STLB and STLB hits move up into L1.
+ */
+class TlbHierarchy
+{
+public:
+    TlbHierarchy(TlbLevel* itlb, TlbLevel* dtlb, TlbLevel* stlb, bool exclusive);
+
+    // returns true on a hit at any level and sets frameNum
+    bool lookup(unsigned int vpn, unsigned char reqtype, unsigned int* frameNum);
+    // installs a translation returned by a page walk
+    void fill(unsigned int vpn, unsigned char reqtype, unsigned int frameNum);
+    // drops vpn from every level, e.g. when its page is evicted
+    void invalidate(unsigned int vpn);
+
+    void report();      // prints per level hits and the walks left over
+
+    TlbLevel* itlb;
+    TlbLevel* dtlb;
+    TlbLevel* stlb;
+    bool exclusive;
+    unsigned long long walks;       // accesses that missed every level
+
+private:
+    TlbLevel* l1For(unsigned char reqtype);
+    void fillL1(TlbLevel* l1, unsigned int vpn, unsigned int frameNum);
+};
+
+
+// parses "entries:ways[:policy]" into a new TlbLevel, using defaultPolicy when the spec has none.
+// Returns NULL if the spec is malformed
+TlbLevel* parseTlbLevel(const char* name, const char* spec, const char* defaultPolicy, unsigned int seed);
+
+#endif
@@ -0,0 +1,323 @@
+#include "tlbPrefetcher.h"
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+
+
+/**
+ * @brief - constructor zeroes the counters
+ * @param name - label used by report
+ * @param degree - most vpns prefetched per miss
+ * @param bufferEntries - prefetch buffer size. 0 prefetches straight into the TLB
+ */
+TlbPrefetcher::TlbPrefetcher(const char* name, unsigned int degree, unsigned int bufferEntries)
+{
+    strncpy(this->name, name, PREFETCH_NAME_LEN - 1);
+    this->name[PREFETCH_NAME_LEN - 1] = '\0';
+    this->degree = degree;
+    this->bufferEntries = bufferEntries;
+    this->issued = 0;
+    this->useful = 0;
+    this->walks = 0;
+    this->demandWalks = 0;
+}
+
+
+/**
+ * @brief - looks vpn up in the prefetch buffer. A hit moves the translation out of the buffer
+ * (the caller puts it in the TLB) and counts the prefetch as useful
+ * @param vpn - page that missed the TLB
+ * @param frameNum - set to the prefetched frame on a hit
+ */
+bool TlbPrefetcher::takeFromBuffer(unsigned int vpn, unsigned int* frameNum)
+{
+    for (unsigned int i = 0; i < buffer.size(); i++) {
+        if (buffer[i].vpn == vpn) {
+            *frameNum = buffer[i].frameNum;
+            buffer.erase(buffer.begin() + i);
+            useful++;
+            return true;
+        }
+    }
+    return false;
+}
+
+
+/**
+ * @brief - returns true if vpn is waiting in the prefetch buffer
+ * @param vpn - page to search for
+ */
+bool TlbPrefetcher::inBuffer(unsigned int vpn)
+{
+    for (unsigned int i = 0; i < buffer.size(); i++) {
+        if (buffer[i].vpn == vpn) return true;
+    }
+    return false;
+}
+
+
+/**
+ * @brief - adds a prefetched translation, dropping the oldest one when the buffer is full
+ * @param vpn - prefetched page
+ * @param frameNum - frame it maps to
+ */
+void TlbPrefetcher::fillBuffer(unsigned int vpn, unsigned int frameNum)
+{
+    if (buffer.size() >= bufferEntries) {
+        buffer.erase(buffer.begin());
+    }
+    BufferEntry entry;
+    entry.vpn = vpn;
+    entry.frameNum = frameNum;
+    buffer.push_back(entry);
+}
+
+
+/**
+ * @brief - removes vpn from the prefetch buffer and the unused prefetches
+ * @param vpn - page that was unmapped
+ */
+void TlbPrefetcher::invalidate(unsigned int vpn)
+{
+    for (unsigned int i = 0; i < buffer.size(); i++) {
+        if (buffer[i].vpn == vpn) {
+            buffer.erase(buffer.begin() + i);
+            break;
+        }
+    }
+    forget(vpn);
+}
+
+
+/**
+ * @brief - remembers that vpn was prefetched straight into the TLB
+ * @param vpn - prefetched page
+ */
+void TlbPrefetcher::notePrefetched(unsigned int vpn)
+{
+    unused.insert(vpn);
+}
+
+
+/**
+ * @brief - called on every TLB hit when prefetching into the TLB. The first hit on a prefetched
+ * entry makes it useful
+ * @param vpn - page that hit
+ */
+void TlbPrefetcher::usePrefetched(unsigned int vpn)
+{
+    if (!unused.empty() && unused.erase(vpn) > 0) {
+        useful++;
+    }
+}
+
+
+/**
+ * @brief - drops vpn from the unused prefetches after it missed the TLB
+ * @param vpn - page that missed
+ */
+void TlbPrefetcher::forget(unsigned int vpn)
+{
+    if (!unused.empty()) {
+        unused.erase(vpn);
+    }
+}
+
+
+/**
+ * @brief - prints accuracy (useful / issued), coverage (useful / misses without prefetching) and
+ * the walks prefetching added
+ */
+void TlbPrefetcher::report()
+{
+    unsigned long long misses = useful + demandWalks;
+    printf("TLB prefetcher (%s, degree %u, ", name, degree);
+    if (bufferEntries > 0) {
+        printf("%u entry prefetch buffer)\n", bufferEntries);
+    }
+    else {
+        printf("into the TLB)\n");
+    }
+    printf("  Prefetches: %llu, useful: %llu, accuracy: %.2f%%, coverage: %.2f%%, extra page walks: %llu\n",
+        issued, useful, issued ? (double)useful / issued * 100.0 : 0.0,
+        misses ? (double)useful / misses * 100.0 : 0.0, walks);
+    fflush(stdout);
+}
+
+
+/**
+ * @brief - constructor
+ * @param degree - pages prefetched after each miss
+ * @param bufferEntries - prefetch buffer size, 0 for the TLB
+ */
+NextPagePrefetcher::NextPagePrefetcher(unsigned int degree, unsigned int bufferEntries)
+    : TlbPrefetcher("next", degree, bufferEntries)
+{
+}
+
+void NextPagePrefetcher::train(unsigned int vpn, std::vector<unsigned int>* candidates)
+{
+    for (unsigned int i = 1; i <= degree; i++) {
+        candidates->push_back(vpn + i);
+    }
+}
+
+
+/**
+ * @brief - constructor starts with no streams
+ * @param degree - strides prefetched ahead once a stream is confirmed
+ * @param bufferEntries - prefetch buffer size, 0 for the TLB
+ */
+StridePrefetcher::StridePrefetcher(unsigned int degree, unsigned int bufferEntries)
+    : TlbPrefetcher("stride", degree, bufferEntries)
+{
+    for (int i = 0; i < STRIDE_STREAMS; i++) {
+        streams[i].valid = false;
+        streams[i].lastUse = 0;
+    }
+    this->clock = 0;
+}
+
+/**
+ * @brief - continues the closest stream within STRIDE_WINDOW pages, or starts a new one in place of
+ * the least recently used. A stride seen twice in a row is prefetched along
+ */
+void StridePrefetcher::train(unsigned int vpn, std::vector<unsigned int>* candidates)
+{
+    clock++;
+    Stream* closest = nullptr;
+    Stream* oldest = &streams[0];
+    unsigned int closestGap = STRIDE_WINDOW + 1;
+    for (int i = 0; i < STRIDE_STREAMS; i++) {
+        Stream* stream = &streams[i];
+        if (!stream->valid) {
+            if (oldest->valid) oldest = stream;
+            continue;
+        }
+        unsigned int gap = (unsigned int)abs((int)(vpn - stream->lastVpn));
+        if (gap < closestGap) {
+            closestGap = gap;
+            closest = stream;
+        }
+        if (oldest->valid && stream->lastUse < oldest->lastUse) {
+            oldest = stream;
+        }
+    }
+
+    if (closest == nullptr) {
+        oldest->valid = true;
+        oldest->lastVpn = vpn;
+        oldest->stride = 0;
+        oldest->confidence = 0;
+        oldest->lastUse = clock;
+        return;
+    }
+
+    int stride = (int)(vpn - closest->lastVpn);
+    if (stride == closest->stride) {
+        closest->confidence++;
+    }
+    else {
+        closest->stride = stride;
+        closest->confidence = 0;
+    }
+    closest->lastVpn = vpn;
+    closest->lastUse = clock;
+
+    if (closest->confidence > 0 && stride != 0) {
+        for (unsigned int i = 1; i <= degree; i++) {
+            candidates->push_back(vpn + (unsigned int)(stride * (int)i));
+        }
+    }
+}
+
+
+/**
+ * @brief - constructor starts with an empty distance table
+ * @param degree - most predicted distances prefetched, capped at DISTANCE_PREDICTIONS
+ * @param bufferEntries - prefetch buffer size, 0 for the TLB
+ */
+DistancePrefetcher::DistancePrefetcher(unsigned int degree, unsigned int bufferEntries)
+    : TlbPrefetcher("distance", degree, bufferEntries)
+{
+    for (int i = 0; i < DISTANCE_TABLE_SIZE; i++) {
+        table[i].valid = false;
+        table[i].numNext = 0;
+    }
+    this->lastVpn = 0;
+    this->lastDistance = 0;
+    this->missesSeen = 0;
+}
+
+/**
+ * @brief - row of distance if the table holds it, otherwise the row it would replace
+ */
+DistancePrefetcher::Row* DistancePrefetcher::row(int distance)
+{
+    return &table[(unsigned int)distance % DISTANCE_TABLE_SIZE];
+}
+
+/**
+ * @brief - records the current distance as following the previous one, then prefetches the
+ * distances that followed the current one before
+ */
+void DistancePrefetcher::train(unsigned int vpn, std::vector<unsigned int>* candidates)
+{
+    missesSeen++;
+    if (missesSeen == 1) {
+        lastVpn = vpn;
+        return;
+    }
+    int distance = (int)(vpn - lastVpn);
+
+    // learn lastDistance -> distance
+    if (missesSeen > 2) {
+        Row* prev = row(lastDistance);
+        if (!prev->valid || prev->distance != lastDistance) {
+            prev->valid = true;
+            prev->distance = lastDistance;
+            prev->numNext = 0;
+        }
+        unsigned int i = 0;
+        while (i < prev->numNext && prev->next[i] != distance) i++;
+        if (i == prev->numNext && prev->numNext < DISTANCE_PREDICTIONS) prev->numNext++;
+        if (i == DISTANCE_PREDICTIONS) i--;
+        for (; i > 0; i--) prev->next[i] = prev->next[i - 1];
+        prev->next[0] = distance;
+    }
+
+    // predict
+    Row* cur = row(distance);
+    if (cur->valid && cur->distance == distance) {
+        for (unsigned int i = 0; i < cur->numNext && i < degree; i++) {
+            candidates->push_back(vpn + (unsigned int)cur->next[i]);
+        }
+    }
+
+    lastVpn = vpn;
+    lastDistance = distance;
+}
+
+
+/**
+ * @brief - returns true if name is next, stride or distance
+ */
+bool isTlbPrefetcher(const char* name)
+{
+    return strcmp(name, "next") == 0 || strcmp(name, "stride") == 0 || strcmp(name, "distance") == 0;
+}
+
+
+/**
+ * @brief - factory for --prefetch
+ * @param name - next, stride or distance
+ * @param degree - most vpns prefetched per miss
+ * @param bufferEntries - prefetch buffer size, 0 for the TLB
+ */
+TlbPrefetcher* createTlbPrefetcher(const char* name, unsigned int degree, unsigned int bufferEntries)
+{
+    if (strcmp(name, "next") == 0) return new NextPagePrefetcher(degree, bufferEntries);
+    if (strcmp(name, "stride") == 0) return new StridePrefetcher(degree, bufferEntries);
+    if (strcmp(name, "distance") == 0) return new DistancePrefetcher(degree, bufferEntries);
+    return NULL;
+}
@@ -0,0 +1,134 @@
+#ifndef TLBPREFETCHER
+#define TLBPREFETCHER
+
+#include <vector>
+#include <unordered_set>
+
+#define PREFETCH_NAME_LEN 16
+#define STRIDE_STREAMS 16           // streams the stride prefetcher tracks at once
+#define STRIDE_WINDOW 64            // a miss within this many pages of a stream continues it
+#define DISTANCE_TABLE_SIZE 256     // direct mapped distance table entries
+#define DISTANCE_PREDICTIONS 2      // next distances remembered per distance
+
+
+/**
+ * @brief - base of the TLB prefetchers. train is called with every vpn that misses the TLB and
+ * returns the vpns worth prefetching. Prefetched translations go into a small FIFO prefetch
+ * buffer, or straight into the TLB when the buffer has no entries. The base also keeps the
+ * accuracy / coverage counters.
+ */
+class TlbPrefetcher
+{
+public:
+    TlbPrefetcher(const char* name, unsigned int degree, unsigned int bufferEntries);
+    virtual ~TlbPrefetcher() {}
+
+    // appends the vpns to prefetch after a miss on vpn
+    virtual void train(unsigned int vpn, std::vector<unsigned int>* candidates) = 0;
+
+    char name[PREFETCH_NAME_LEN];
+    unsigned int degree;            // most vpns prefetched per miss
+    unsigned int bufferEntries;     // 0 prefetches into the TLB itself
+
+    // prefetch buffer
+    bool takeFromBuffer(unsigned int vpn, unsigned int* frameNum);  // removes vpn on a hit
+    bool inBuffer(unsigned int vpn);
+    void fillBuffer(unsigned int vpn, unsigned int frameNum);
+    void invalidate(unsigned int vpn);      // drops a translation that is no longer mapped
+
+    // prefetches made straight into the TLB. usePrefetched counts the first hit on one as useful
+    void notePrefetched(unsigned int vpn);
+    void usePrefetched(unsigned int vpn);
+    void forget(unsigned int vpn);     // vpn missed, so any earlier prefetch of it was evicted unused
+
+    std::vector<unsigned int> candidates;   // scratch for train
+
+    unsigned long long issued;          // translations prefetched
+    unsigned long long useful;          // prefetched translations later used by a demand access
+    unsigned long long walks;           // page walks made for prefetching, including unmapped pages
+    unsigned long long demandWalks;     // misses the prefetcher didn't cover
+
+    void report();
+
+private:
+    struct BufferEntry
+    {
+        unsigned int vpn;
+        unsigned int frameNum;
+    };
+    std::vector<BufferEntry> buffer;            // oldest first
+    std::unordered_set<unsigned int> unused;    // prefetched into the TLB and not hit yet
+};
+
+
+/**
+ * @brief - prefetches the degree pages after every miss
+ */
+class NextPagePrefetcher : public TlbPrefetcher
+{
+public:
+    NextPagePrefetcher(unsigned int degree, unsigned int bufferEntries);
+    void train(unsigned int vpn, std::vector<unsigned int>* candidates);
+};
+
+
+/**
+ * @brief - PC-less stride prefetcher. Misses are grouped into streams by closeness to each
+ * stream's last miss, and once a stream repeats the same stride the next degree pages along
+ * it are prefetched
+ */
+class StridePrefetcher : public TlbPrefetcher
+{
+public:
+    StridePrefetcher(unsigned int degree, unsigned int bufferEntries);
+    void train(unsigned int vpn, std::vector<unsigned int>* candidates);
+
+private:
+    struct Stream
+    {
+        unsigned int lastVpn;
+        int stride;
+        unsigned int confidence;
+        unsigned long long lastUse;
+        bool valid;
+    };
+    Stream streams[STRIDE_STREAMS];
+    unsigned long long clock;
+};
+
+
+/**
+ * @brief - distance prefetcher (Kandiraju and Sivasubramaniam). The distance between consecutive
+ * misses indexes a table of the distances that followed it last time, and the pages at those
+ * distances from the current miss are prefetched
+ */
+class DistancePrefetcher : public TlbPrefetcher
+{
+public:
+    DistancePrefetcher(unsigned int degree, unsigned int bufferEntries);
+    void train(unsigned int vpn, std::vector<unsigned int>* candidates);
+
+private:
+    struct Row
+    {
+        int distance;                               // tag
+        int next[DISTANCE_PREDICTIONS];             // most recent first
+        unsigned int numNext;
+        bool valid;
+    };
+    Row table[DISTANCE_TABLE_SIZE];
+    unsigned int lastVpn;
+    int lastDistance;
+    unsigned int missesSeen;
+
+    Row* row(int distance);
+};
+
+
+// true if name is a prefetcher createTlbPrefetcher knows
+bool isTlbPrefetcher(const char* name);
+
+// returns a new next, stride or distance prefetcher, or NULL for an unknown name
+TlbPrefetcher* createTlbPrefetcher(const char* name, unsigned int degree, unsigned int bufferEntries);
+
+#endif
@@ -0,0 +1,93 @@
+#include <iostream>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "unistd.h"
+#include "ctrace.h"
+
+/**
+ * @brief - converts a field list like "reqtype,proc" or "all" into CTRACE_FIELD_* bits.
+ * Exits if an unknown field is given.
+ * @param list - comma separated field names
+ */
+unsigned int parseFieldList(char* list)
+{
+    unsigned int fields = 0;
+    for (char* name = strtok(list, ","); name != NULL; name = strtok(NULL, ",")) {
+        if (strcmp(name, "all") == 0) fields |= CTRACE_FIELD_ALL;
+        else if (strcmp(name, "none") == 0) fields |= 0;
+        else if (strcmp(name, "reqtype") == 0) fields |= CTRACE_FIELD_REQTYPE;
+        else if (strcmp(name, "size") == 0) fields |= CTRACE_FIELD_SIZE;
+        else if (strcmp(name, "attr") == 0) fields |= CTRACE_FIELD_ATTR;
+        else if (strcmp(name, "proc") == 0) fields |= CTRACE_FIELD_PROC;
+        else if (strcmp(name, "time") == 0) fields |= CTRACE_FIELD_TIME;
+        else {
+            std::cerr << "Unknown field <<" << name << ">>. Use reqtype, size, attr, proc, time, all or none" << std::endl;
+            exit(EXIT_FAILURE);
+        }
+    }
+    return fields;
+}
+
+
+/**
+ * @brief - trace2ctrace [-b recordsPerBlock] [-f fields] input_trace_file output_ctrace_file
+ * Reads a raw BYU trace and writes it in the ctrace format. Addresses are always kept,
+ * -f picks which of the other fields are kept (default reqtype,proc).
+ */
+int main(int argc, char** argv)
+{
+    unsigned int blockRecords = CTRACE_DEFAULT_BLOCK_RECORDS;
+    unsigned int fields = CTRACE_DEFAULT_FIELDS;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "b:f:")) != -1)
+    {
+        switch (opt)
+        {
+        case 'b':
+            if (atoi(optarg) < 1) {
+                std::cerr << "Records per block must be at least 1" << std::endl;
+                exit(EXIT_FAILURE);
+            }
+            blockRecords = atoi(optarg);
+            break;
+        case 'f':
+            fields = parseFieldList(optarg);
+            break;
+        default:
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    if (optind + 2 != argc) {
+        std::cerr << "usage: " << argv[0] << " [-b recordsPerBlock] [-f fields] input_trace_file output_ctrace_file" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    TraceSource* source = openTraceSource(argv[optind]);
+    if (source == NULL) {
+        std::cerr << "Unable to open <<" << argv[optind] << ">>" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    FILE* out = fopen(argv[optind + 1], "wb");
+    if (out == NULL) {
+        std::cerr << "Unable to open <<" << argv[optind + 1] << ">>" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    CTraceWriter writer(out, fields, blockRecords);
+    p2AddrTr trace;
+    while (source->next(&trace)) {
+        writer.append(&trace);
+    }
+    writer.close();
+    delete source;
+    fclose(out);
+
+    unsigned long long rawBytes = writer.recordsWritten * sizeof(p2AddrTr);
+    printf("Records: %llu\n", writer.recordsWritten);
+    printf("Raw bytes: %llu, compressed bytes: %llu, ratio: %.2fx\n", rawBytes, writer.bytesWritten,
+        writer.bytesWritten ? (double)rawBytes / writer.bytesWritten : 0.0);
+    return 0;
+}
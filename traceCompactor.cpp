@@ -0,0 +1,65 @@
+#include "traceCompactor.h"
+
+
+/**
+ * @brief - constructor stores the trace handle and page geometry
+ * @param source - TraceSource* to read records from, already opened
+ * @param offsetShift - number of bits in the page offset. vpn = addr >> offsetShift
+ */
+TraceCompactor::TraceCompactor(TraceSource* source, unsigned int offsetShift)
+{
+    this->source = source;
+    this->offsetShift = offsetShift;
+    this->offsetMask = (1u << offsetShift) - 1;
+    this->haveLookahead = false;
+    this->recordsRead = 0;
+    this->runsEmitted = 0;
+}
+
+
+/**
+ * @brief - reads the next record from the trace. Returns false once the trace is exhausted
+ * @param record - filled with the next record
+ */
+bool TraceCompactor::readRecord(p2AddrTr* record)
+{
+    if (source->next(record)) {
+        recordsRead++;
+        return true;
+    }
+    return false;
+}
+
+
+/**
+ * @brief - collapses the next stretch of same-vpn records into run. The record that ends the
+ * run is kept as lookahead and starts the following run.
+ * @param run - filled with the vpn, count, first offset and first record of the run
+ * @param maxCount - upper bound on run->count, used to honour -n
+ */
+bool TraceCompactor::nextRun(pageRun* run, unsigned int maxCount)
+{
+    if (maxCount == 0) {
+        return false;
+    }
+    if (!haveLookahead && !readRecord(&lookahead)) {
+        return false;
+    }
+
+    run->first = lookahead;
+    run->vpn = lookahead.addr >> offsetShift;
+    run->firstOffset = lookahead.addr & offsetMask;
+    run->count = 1;
+    haveLookahead = false;
+
+    while (run->count < maxCount && readRecord(&lookahead)) {
+        if ((lookahead.addr >> offsetShift) != run->vpn) {
+            haveLookahead = true;
+            break;
+        }
+        run->count++;
+    }
+
+    runsEmitted++;
+    return true;
+}
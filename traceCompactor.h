@@ -0,0 +1,47 @@
+#ifndef TRACECOMPACTOR
+#define TRACECOMPACTOR
+
+#include "traceSource.h"
+
+
+/*
+ * one run of consecutive accesses to the same virtual page
+ */
+typedef struct
+{
+    uint32_t vpn;           // page every access in the run touches
+    uint32_t count;         // number of accesses in the run (>= 1)
+    uint32_t firstOffset;   // page offset of the first access
+    p2AddrTr first;         // full record of the first access
+} pageRun;
+
+
+/**
+ * @brief - streaming run-length compaction of a trace. Collapses consecutive records that touch
+ * the same vpn into one pageRun so the simulator can simulate the first access and account for
+ * the rest in bulk. Only holds one record of lookahead.
+ */
+class TraceCompactor
+{
+public:
+    // constructor
+    TraceCompactor(TraceSource* source, unsigned int offsetShift);
+
+    // fills run with the next run of at most maxCount accesses. Returns false at end of trace
+    bool nextRun(pageRun* run, unsigned int maxCount);
+
+    // compaction statistics
+    unsigned long long recordsRead;
+    unsigned long long runsEmitted;
+
+private:
+    TraceSource* source;
+    unsigned int offsetShift;   // bits in the page offset
+    unsigned int offsetMask;
+    p2AddrTr lookahead;         // first record of the next run
+    bool haveLookahead;
+
+    bool readRecord(p2AddrTr* record);
+};
+
+#endif
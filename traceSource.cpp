@@ -0,0 +1,124 @@
+#include <string.h>
+#include "traceSource.h"
+#include "ctrace.h"
+#include "textTrace.h"
+
+
+/**
+ * @brief - default batch read, calls next until max records are read or the trace ends
+ * @param records - array of at least max records to fill
+ * @param max - maximum number of records to read
+ */
+size_t TraceSource::nextBatch(p2AddrTr* records, size_t max)
+{
+    size_t count = 0;
+    while (count < max && next(&records[count])) {
+        count++;
+    }
+    return count;
+}
+
+
+/**
+ * @brief - default seek for sources that can only be read front to back
+ * @param recordNum - record to seek to
+ */
+bool TraceSource::seekRecord(unsigned long long recordNum)
+{
+    return false;
+}
+
+
+/**
+ * @brief - constructor takes ownership of an already opened trace file
+ * @param traceFile - FILE* opened with fopen in "rb" mode
+ */
+ByuTraceSource::ByuTraceSource(FILE* traceFile)
+{
+    this->traceFile = traceFile;
+}
+
+
+ByuTraceSource::~ByuTraceSource()
+{
+    fclose(traceFile);
+}
+
+
+/**
+ * @brief - reads the next record with NextAddress. Returns false once the file is exhausted
+ * @param record - filled with the next record
+ */
+bool ByuTraceSource::next(p2AddrTr* record)
+{
+    while (!feof(traceFile)) {
+        if (NextAddress(traceFile, record)) {     // traceFile: File handle from fOpen
+            return true;
+        }
+    }
+    return false;
+}
+
+
+/**
+ * @brief - reads up to max records with one fread. Big endian machines convert every record in
+ * NextAddress instead
+ * @param records - array of at least max records to fill
+ * @param max - maximum number of records to read
+ */
+size_t ByuTraceSource::nextBatch(p2AddrTr* records, size_t max)
+{
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    return fread(records, sizeof(p2AddrTr), max, traceFile);
+#else
+    return TraceSource::nextBatch(records, max);
+#endif
+}
+
+
+/**
+ * @brief - BYU records are all sizeof(p2AddrTr) bytes, so the offset of any record is computed
+ * directly and no index is needed
+ * @param recordNum - zero based record to seek to
+ */
+bool ByuTraceSource::seekRecord(unsigned long long recordNum)
+{
+    clearerr(traceFile);
+    return fseeko(traceFile, (off_t)(recordNum * sizeof(p2AddrTr)), SEEK_SET) == 0;
+}
+
+
+/**
+ * @brief - opens fname and checks for the ctrace magic, then for a text trace by its first
+ * TEXT_SNIFF_BYTES bytes being printable. Anything else is read as a raw BYU trace.
+ * @param fname - path of the trace file
+ */
+TraceSource* openTraceSource(const char* fname)
+{
+    FILE* traceFile = fopen(fname, "rb");
+    if (traceFile == NULL) {
+        return NULL;
+    }
+
+    unsigned char magic[TEXT_SNIFF_BYTES];
+    size_t readN = fread(magic, 1, TEXT_SNIFF_BYTES, traceFile);
+    rewind(traceFile);
+
+    if (readN >= CTRACE_MAGIC_LEN && memcmp(magic, CTRACE_MAGIC, CTRACE_MAGIC_LEN) == 0) {
+        CTraceReader* reader = new CTraceReader(traceFile);
+        if (!reader->isValid()) {
+            delete reader;
+            return NULL;
+        }
+        return reader;
+    }
+    if (isTextTrace(magic, readN)) {
+        TextTraceSource* reader = new TextTraceSource(traceFile);
+        if (!reader->isValid()) {
+            delete reader;
+            return NULL;
+        }
+        return reader;
+    }
+    return new ByuTraceSource(traceFile);
+}
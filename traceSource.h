@@ -0,0 +1,50 @@
+#ifndef TRACESOURCE
+#define TRACESOURCE
+
+#include <stdio.h>
+#include <stddef.h>
+#include "tracereader.h"
+
+
+/**
+ * @brief - a stream of trace records. Lets the simulator read raw BYU traces and the compressed
+ * ctrace format through the same calls.
+ */
+class TraceSource
+{
+public:
+    virtual ~TraceSource() {}
+
+    // reads the next record into record. Returns false at end of trace
+    virtual bool next(p2AddrTr* record) = 0;
+
+    // reads up to max records into records. Returns how many were read, 0 at end of trace
+    virtual size_t nextBatch(p2AddrTr* records, size_t max);
+
+    // positions the source so next returns record recordNum (zero based). Returns false if the
+    // source can't seek, in which case callers have to read forward instead
+    virtual bool seekRecord(unsigned long long recordNum);
+};
+
+
+/**
+ * @brief - raw BYU trace read one record at a time with NextAddress, or many at once with one fread
+ * on little endian machines, where the records need no conversion
+ */
+class ByuTraceSource : public TraceSource
+{
+public:
+    ByuTraceSource(FILE* traceFile);
+    ~ByuTraceSource();
+    bool next(p2AddrTr* record);
+    size_t nextBatch(p2AddrTr* records, size_t max);
+    bool seekRecord(unsigned long long recordNum);
+
+    FILE* traceFile;
+};
+
+
+// opens fname as a raw BYU trace or a ctrace depending on its header. Returns NULL if it can't be opened
+TraceSource* openTraceSource(const char* fname);
+
+#endif
@@ -1,3 +1,5 @@
+#ifndef TRACEREADER_H
+#define TRACEREADER_H
 
 /* C and C++ define some of their types in different places.
  * Check and see if we are using C or C++ and include appropriately
@@ -51,4 +53,4 @@ int NextAddress(FILE* trace_file, p2AddrTr* addr_ptr);
 #define STOPCLKACK 0x36 // acknowledge stop clock
 #define SMIACK 0x37 // acknowledge SMI mode
 
-
+#endif
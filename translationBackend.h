@@ -0,0 +1,52 @@
+#ifndef TRANSLATIONBACKEND
+#define TRANSLATIONBACKEND
+
+#include <functional>
+#include "Map.h"
+
+
+/**
+ * @brief - common interface for every structure that can translate a vpn to a frame.
+ * The multi-level PageTable, HashedPageTable and InvertedPageTable all implement this so
+ * processNextAddress and the output modes do not care which one is being simulated.
+ * Map* returned by lookup/insert are only guaranteed valid until the next insert.
+ */
+class TranslationBackend
+{
+public:
+    virtual ~TranslationBackend() {}
+
+    // returns the Map for vpn or nullptr if vpn is not mapped
+    virtual Map* lookup(unsigned int vpn) = 0;
+
+    // maps vpn to frameNum and returns the new Map
+    virtual Map* insert(unsigned int vpn, unsigned int frameNum) = 0;
+
+    // clears the mapping for vpn. Returns false if vpn was not mapped
+    virtual bool invalidate(unsigned int vpn) = 0;
+
+    // total number of bytes used by the translation structure
+    virtual unsigned int bytesUsed() = 0;
+
+    // calls visit(vpn, map) for every valid mapping
+    virtual void forEach(const std::function<void(unsigned int, Map*)>& visit) = 0;
+
+    /**
+     * @brief - returns the Map for vpn, inserting a mapping to frameNum if it is not present.
+     * Backends can override this when they can do both with a single probe.
+     * @param vpn - virtual page number to translate
+     * @param frameNum - frame to map vpn to if it is not already mapped
+     * @param hit - set to true if vpn was already mapped, else false
+     */
+    virtual Map* lookupOrInsert(unsigned int vpn, unsigned int frameNum, bool* hit)
+    {
+        Map* frame = lookup(vpn);
+        *hit = (frame != nullptr);
+        if (frame == nullptr) {
+            frame = insert(vpn, frameNum);
+        }
+        return frame;
+    }
+};
+
+#endif
@@ -0,0 +1,197 @@
+#include "workingSet.h"
+#include <stdio.h>
+#include <algorithm>
+
+
+/**
+ * @brief - constructor prints the interval table header
+ * @param intervalLength - records or time units per interval
+ * @param taus - window sizes W(t, tau) is reported for
+ */
+WorkingSetAnalyzer::WorkingSetAnalyzer(unsigned long long intervalLength, const std::vector<unsigned long long>& taus)
+{
+    this->intervalLength = intervalLength;
+    this->taus = taus;
+    this->accesses = 0;
+    this->coldAccesses = 0;
+    for (int i = 0; i < WS_HISTOGRAM_BUCKETS; i++) {
+        histogram[i] = 0;
+    }
+    this->slotPage.assign(WS_MIN_SLOTS, WS_NO_PAGE);
+    this->slotTime.assign(WS_MIN_SLOTS, 0);
+    this->tree.assign(WS_MIN_SLOTS + 1, 0);
+    this->nextSlot = 0;
+    this->intervalStart = 0;
+    this->intervalAccesses = 0;
+    this->started = false;
+
+    printf("%-14s %-14s %-10s %-10s", "Interval end", "Accesses", "Distinct", "Total");
+    for (unsigned int i = 0; i < taus.size(); i++) {
+        char label[32];
+        snprintf(label, sizeof(label), "W(%llu)", taus[i]);
+        printf(" %-10s", label);
+    }
+    printf("\n");
+}
+
+
+/**
+ * @brief - Fenwick update of one slot
+ */
+void WorkingSetAnalyzer::add(unsigned int slot, int delta)
+{
+    for (unsigned int i = slot + 1; i < tree.size(); i += i & (0 - i)) {
+        tree[i] += delta;
+    }
+}
+
+
+/**
+ * @brief - Fenwick prefix sum, number of marked slots below slots
+ */
+unsigned int WorkingSetAnalyzer::prefix(unsigned int slots)
+{
+    unsigned int sum = 0;
+    for (unsigned int i = slots; i > 0; i -= i & (0 - i)) {
+        sum += tree[i];
+    }
+    return sum;
+}
+
+
+/**
+ * @brief - distinct pages accessed at or after time. slotTime is sorted so the first slot at or
+ * after time is found with a binary search
+ * @param time - start of the window
+ */
+unsigned int WorkingSetAnalyzer::markedSince(unsigned long long time)
+{
+    unsigned int first = std::lower_bound(slotTime.begin(), slotTime.begin() + nextSlot, time) - slotTime.begin();
+    return prefix(nextSlot) - prefix(first);
+}
+
+
+/**
+ * @brief - renumbers the marked slots 0..live-1 in time order and rebuilds the tree with room for
+ * as many accesses again (at least WS_MIN_SLOTS)
+ */
+void WorkingSetAnalyzer::compact()
+{
+    unsigned int live = 0;
+    for (unsigned int i = 0; i < nextSlot; i++) {
+        if (slotPage[i] != WS_NO_PAGE) {
+            slotPage[live] = slotPage[i];
+            slotTime[live] = slotTime[i];
+            pageSlot[slotPage[live]] = live;
+            live++;
+        }
+    }
+
+    unsigned int size = std::max(live * 2, (unsigned int)WS_MIN_SLOTS);
+    slotPage.resize(size);
+    slotTime.resize(size);
+    std::fill(slotPage.begin() + live, slotPage.end(), WS_NO_PAGE);
+
+    // every slot below live is marked, so the tree can be built directly
+    tree.assign(size + 1, 0);
+    for (unsigned int i = 1; i <= size; i++) {
+        tree[i] += (i <= live);
+        unsigned int parent = i + (i & (0 - i));
+        if (parent <= size) {
+            tree[parent] += tree[i];
+        }
+    }
+    nextSlot = live;
+}
+
+
+/**
+ * @brief - records an access to vpn. Closes every interval that ended before time first, then
+ * bins the reuse distance and moves vpn's mark to a new slot
+ * @param vpn - page accessed
+ * @param time - record number or trace time of the access, non decreasing
+ */
+void WorkingSetAnalyzer::access(unsigned int vpn, unsigned long long time)
+{
+    if (!started) {
+        intervalStart = time;
+        started = true;
+    }
+    while (time >= intervalStart + intervalLength) {
+        reportInterval(intervalStart + intervalLength);
+        intervalStart += intervalLength;
+    }
+
+    if (nextSlot == slotPage.size()) {
+        compact();
+    }
+
+    std::unordered_map<unsigned int, unsigned int>::iterator it = pageSlot.find(vpn);
+    if (it == pageSlot.end()) {
+        coldAccesses++;
+        pageSlot[vpn] = nextSlot;
+    }
+    else {
+        unsigned int prev = it->second;
+        unsigned int distance = prefix(nextSlot) - prefix(prev + 1);
+        int bucket = 0;
+        while (distance >> bucket) bucket++;    // 0 for 0, otherwise floor(log2) + 1
+        histogram[bucket]++;
+        slotPage[prev] = WS_NO_PAGE;
+        add(prev, -1);
+        it->second = nextSlot;
+    }
+
+    slotPage[nextSlot] = vpn;
+    slotTime[nextSlot] = time;
+    add(nextSlot, 1);
+    nextSlot++;
+    accesses++;
+    intervalAccesses++;
+}
+
+
+/**
+ * @brief - prints one row of the interval table: accesses and distinct pages in the interval,
+ * the footprint so far and W(end, tau) for every tau
+ * @param end - first time after the interval
+ */
+void WorkingSetAnalyzer::reportInterval(unsigned long long end)
+{
+    printf("%-14llu %-14llu %-10u %-10lu", end, intervalAccesses, markedSince(intervalStart),
+        (unsigned long)pageSlot.size());
+    for (unsigned int i = 0; i < taus.size(); i++) {
+        printf(" %-10u", markedSince(end > taus[i] ? end - taus[i] : 0));
+    }
+    printf("\n");
+    intervalAccesses = 0;
+}
+
+
+/**
+ * @brief - reports the last, possibly partial, interval and the reuse distance histogram
+ */
+void WorkingSetAnalyzer::finish()
+{
+    if (started && intervalAccesses > 0) {
+        unsigned long long end = nextSlot > 0 ? slotTime[nextSlot - 1] + 1 : intervalStart;
+        reportInterval(end);
+    }
+
+    printf("Reuse distance (distinct pages between accesses to a page), %llu accesses\n", accesses);
+    printf("  %-24s %-12llu %.2f%%\n", "cold", coldAccesses, accesses ? (double)coldAccesses / accesses * 100.0 : 0.0);
+    for (int i = 0; i < WS_HISTOGRAM_BUCKETS; i++) {
+        if (histogram[i] == 0) {
+            continue;
+        }
+        char label[32];
+        if (i == 0) {
+            snprintf(label, sizeof(label), "0");
+        }
+        else {
+            snprintf(label, sizeof(label), "%llu-%llu", 1ULL << (i - 1), (1ULL << i) - 1);
+        }
+        printf("  %-24s %-12llu %.2f%%\n", label, histogram[i], (double)histogram[i] / accesses * 100.0);
+    }
+    fflush(stdout);
+}
@@ -0,0 +1,56 @@
+#ifndef WORKINGSET
+#define WORKINGSET
+
+#include <stdint.h>
+#include <vector>
+#include <unordered_map>
+
+#define WS_MIN_SLOTS 1024           // smallest Fenwick tree, grows with the footprint
+#define WS_HISTOGRAM_BUCKETS 33     // reuse distance 0, then [2^(i-1), 2^i) for i = 1..32
+#define WS_NO_PAGE 0xFFFFFFFF       // slotPage value of a slot that isn't a page's last access
+
+
+/**
+ * @brief - streaming working-set analysis for -o workingset. Every access is given a slot in time
+ * order and a Fenwick tree marks the slots that are still some page's most recent access. Then
+ *      distinct pages since time T = marked slots after the last slot before T
+ *      reuse distance of an access = marked slots after the page's previous slot
+ * Slots of older accesses are unmarked as pages are re-accessed, and once the tree is full the
+ * marked ones are renumbered from 0, so memory stays proportional to the footprint.
+ * Times are record numbers or p2AddrTr::time, whichever the intervals are defined by.
+ */
+class WorkingSetAnalyzer
+{
+public:
+    // intervalLength and taus are in the same unit as the times passed to access
+    WorkingSetAnalyzer(unsigned long long intervalLength, const std::vector<unsigned long long>& taus);
+
+    void access(unsigned int vpn, unsigned long long time);
+    void finish();      // reports the partial last interval and the reuse distance histogram
+
+    unsigned long long intervalLength;
+    std::vector<unsigned long long> taus;
+
+    unsigned long long accesses;
+    unsigned long long coldAccesses;        // first access to a page, infinite reuse distance
+    unsigned long long histogram[WS_HISTOGRAM_BUCKETS];
+
+private:
+    std::unordered_map<unsigned int, unsigned int> pageSlot;   // vpn -> slot of its last access
+    std::vector<unsigned int> slotPage;         // vpn whose last access is the slot, or WS_NO_PAGE
+    std::vector<unsigned long long> slotTime;   // time of each slot's access, non decreasing
+    std::vector<unsigned int> tree;             // Fenwick tree over slotPage != WS_NO_PAGE
+    unsigned int nextSlot;
+
+    unsigned long long intervalStart;       // first time of the current interval
+    unsigned long long intervalAccesses;
+    bool started;
+
+    void add(unsigned int slot, int delta);
+    unsigned int prefix(unsigned int slots);            // marked slots in [0, slots)
+    unsigned int markedSince(unsigned long long time);  // marked slots with slotTime >= time
+    void compact();
+    void reportInterval(unsigned long long end);
+};
+
+#endif